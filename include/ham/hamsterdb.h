@@ -66,6 +66,8 @@
  * <tr><td>@ref ham_cursor_overwrite</td><td>Overwrites the value of the current  key</td></tr>
  * <tr><td>@ref ham_cursor_move</td><td>Moves the Cursor to the first, next,
   previous or last key in the Database</td></tr>
+ * <tr><td>@ref ham_cursor_get_batch</td><td>Moves the Cursor over several
+  keys and returns all of them with a single call</td></tr>
  * <tr><td>@ref ham_cursor_close</td><td>Closes the Cursor</td></tr>
  * </table>
  *
@@ -521,6 +523,12 @@ ham_get_license(const char **licensee, const char **product);
  *      By default, hamsterdb checks if it can use mmap,
  *      since mmap is faster than read/write. For performance
  *      reasons, this flag should not be used.
+ *     <li>@ref HAM_DIRECT_IO</li> Bypasses the page cache of the operating
+ *      system (O_DIRECT); the hamsterdb cache is then the only cache,
+ *      and its size (@ref HAM_PARAM_CACHE_SIZE) should be increased
+ *      accordingly. Implies @ref HAM_DISABLE_MMAP. Not allowed in
+ *      combination with @ref HAM_IN_MEMORY. Not supported on
+ *      Microsoft Windows.
  *     <li>@ref HAM_CACHE_STRICT</li> Do not allow the cache to grow larger
  *      than @a cache_size. If a Database operation needs to resize the
  *      cache, it will return @ref HAM_CACHE_FULL.
@@ -559,6 +567,58 @@ ham_get_license(const char **licensee, const char **product);
  *      for In-Memory Environments. Ignored for remote Environments.
  *    <li>@ref HAM_PARAM_NETWORK_TIMEOUT_SEC</li> Timeout (in seconds) when
  *      waiting for data from a remote server. By default, no timeout is set.
+ *    <li>@ref HAM_PARAM_FREELIST_TYPE</li> The implementation of the
+ *      freelist; either @ref HAM_FREELIST_BITMAP (the default) or
+ *      @ref HAM_FREELIST_EXTENT. The type is stored in the file and
+ *      cannot be changed later. Ignored for In-Memory and remote
+ *      Environments.
+ *    <li>@ref HAM_PARAM_FILE_GROWTH_SIZE</li> The file is extended in
+ *      steps of this many bytes (rounded up to a multiple of the page
+ *      size); the space is pre-allocated with fallocate(2) if the file
+ *      system supports it. The unused rest of the last step is removed
+ *      when the Environment is closed. The default is 0: the file
+ *      grows page by page. Not allowed for In-Memory
+ *      Environments; ignored for remote Environments.
+ *    <li>@ref HAM_PARAM_IO_BACKEND</li> The I/O backend of the file:
+ *      @ref HAM_IO_BACKEND_SYNC (the default), @ref HAM_IO_BACKEND_ASYNC
+ *      or @ref HAM_IO_BACKEND_THREADS. The asynchronous backends write the
+ *      modified pages of a transaction in a single batch (if
+ *      @ref HAM_ENABLE_RECOVERY is set) and prefetch the sibling pages
+ *      when a Cursor moves through the Database. Prefetching is only
+ *      used for pages which are not memory mapped (see
+ *      @ref HAM_DISABLE_MMAP). Not allowed for In-Memory Environments;
+ *      ignored for remote Environments.
+ *    <li>@ref HAM_PARAM_GROUP_COMMIT_DELAY</li> Only used with
+ *      @ref HAM_ENABLE_FSYNC and @ref HAM_ENABLE_TRANSACTIONS. Commits
+ *      of concurrent Transactions are flushed to the journal with a
+ *      single fdatasync(2) ("group commit"). The first committer waits up
+ *      to this many microseconds for other Transactions to join the group
+ *      before it flushes the journal. The default is 0: the journal is
+ *      flushed immediately, and only those commits are grouped which
+ *      arrive while a flush is in progress. Ignored for remote
+ *      Environments.
+ *    <li>@ref HAM_PARAM_GROUP_COMMIT_SIZE</li> The journal is flushed as
+ *      soon as a group contains this many commits, even if
+ *      @ref HAM_PARAM_GROUP_COMMIT_DELAY has not yet expired. The
+ *      default is 0 (no limit). Ignored for remote Environments.
+ *    <li>@ref HAM_PARAM_JOURNAL_SYNC_INTERVAL</li> Only used with
+ *      @ref HAM_ENABLE_FSYNC and @ref HAM_ENABLE_TRANSACTIONS. If set,
+ *      @ref ham_txn_commit returns without waiting for the journal to be
+ *      flushed; instead, a background thread flushes the journal every
+ *      this many milliseconds. After a crash, the Transactions which
+ *      were committed in the last interval can be lost, but the
+ *      Environment remains consistent. Use @ref ham_env_sync to make all
+ *      committed Transactions durable. The default is 0: every commit
+ *      waits for the flush. Ignored for remote Environments.
+ *    <li>@ref HAM_PARAM_TXN_FLUSH_LIMIT</li> Only used with
+ *      @ref HAM_ENABLE_TRANSACTIONS. If set, committed Transactions are
+ *      merged into the Database by a background thread, and
+ *      @ref ham_txn_commit only appends the commit to the journal. The
+ *      value limits the memory (in bytes) of the committed Transactions
+ *      which are not yet merged; if it is exceeded then
+ *      @ref ham_txn_commit merges them itself. The default is 0: every
+ *      commit merges its Transaction immediately. Ignored for remote
+ *      Environments.
  *    </ul>
  *
  * @return @ref HAM_SUCCESS upon success
@@ -624,6 +684,8 @@ ham_env_create(ham_env_t **env, const char *filename,
  *      By default, hamsterdb checks if it can use mmap,
  *      since mmap is faster than read/write. For performance
  *      reasons, this flag should not be used.
+ *     <li>@ref HAM_DIRECT_IO </li> Bypasses the page cache of the
+ *      operating system; see @ref ham_env_create.
  *     <li>@ref HAM_CACHE_STRICT </li> Do not allow the cache to grow larger
  *      than @a cache_size. If a Database operation needs to resize the
  *      cache, it will return @ref HAM_CACHE_FULL.
@@ -657,6 +719,20 @@ ham_env_create(ham_env_t **env, const char *filename,
  *      remote Environmens.
  *    <li>@ref HAM_PARAM_NETWORK_TIMEOUT_SEC</li> Timeout (in seconds) when
  *      waiting for data from a remote server. By default, no timeout is set.
+ *    <li>@ref HAM_PARAM_FILE_GROWTH_SIZE</li> The file is extended in
+ *      steps of this many bytes; see @ref ham_env_create.
+ *    <li>@ref HAM_PARAM_IO_BACKEND</li> The I/O backend of the file;
+ *      see @ref ham_env_create.
+ *    <li>@ref HAM_PARAM_GROUP_COMMIT_DELAY</li> The maximum delay (in
+ *      microseconds) of a group commit; see @ref ham_env_create.
+ *    <li>@ref HAM_PARAM_GROUP_COMMIT_SIZE</li> The maximum number of
+ *      commits in a group; see @ref ham_env_create.
+ *    <li>@ref HAM_PARAM_JOURNAL_SYNC_INTERVAL</li> The interval (in
+ *      milliseconds) in which the journal is flushed in the background;
+ *      see @ref ham_env_create.
+ *    <li>@ref HAM_PARAM_TXN_FLUSH_LIMIT</li> The memory limit (in bytes)
+ *      of committed Transactions which are merged in the background;
+ *      see @ref ham_env_create.
  *    </ul>
  *
  * @return @ref HAM_SUCCESS upon success.
@@ -688,6 +764,20 @@ ham_env_open(ham_env_t **env, const char *filename,
  *    <li>HAM_PARAM_PAGE_SIZE</li> returns the page size
  *    <li>HAM_PARAM_MAX_DATABASES</li> returns the max. number of
  *        Databases of this Database's Environment
+ *    <li>HAM_PARAM_FREELIST_TYPE</li> returns the freelist type
+ *        (@ref HAM_FREELIST_BITMAP or @ref HAM_FREELIST_EXTENT)
+ *    <li>HAM_PARAM_FILE_GROWTH_SIZE</li> returns the size of the steps
+ *        in which the file is extended (0 if it grows page by page)
+ *    <li>HAM_PARAM_IO_BACKEND</li> returns the I/O backend
+ *    <li>HAM_PARAM_GROUP_COMMIT_DELAY</li> returns the maximum delay
+ *        (in microseconds) of a group commit
+ *    <li>HAM_PARAM_GROUP_COMMIT_SIZE</li> returns the maximum number of
+ *        commits in a group (0 if unlimited)
+ *    <li>HAM_PARAM_JOURNAL_SYNC_INTERVAL</li> returns the interval (in
+ *        milliseconds) in which the journal is flushed in the background
+ *    <li>HAM_PARAM_TXN_FLUSH_LIMIT</li> returns the memory limit (in
+ *        bytes) of committed Transactions which are merged in the
+ *        background (0 if they are merged immediately)
  *    <li>HAM_PARAM_FLAGS</li> returns the flags which were used to
  *        open or create this Database
  *    <li>HAM_PARAM_FILEMODE</li> returns the @a mode parameter which
@@ -934,6 +1024,91 @@ ham_env_erase_db(ham_env_t *env, ham_u16_t name, ham_u32_t flags);
 HAM_EXPORT ham_status_t HAM_CALLCONV
 ham_env_flush(ham_env_t *env, ham_u32_t flags);
 
+/**
+ * Makes all committed Transactions durable
+ *
+ * Flushes the journal to disk, and waits till the flush is completed. All
+ * Transactions which were committed before this function was called will
+ * survive a crash. Use this function as a barrier (i.e. at checkpoints of
+ * your application) if the Environment was created or opened with
+ * @ref HAM_PARAM_JOURNAL_SYNC_INTERVAL.
+ *
+ * Unlike @ref ham_env_flush, the cache is not written to disk, and
+ * other threads can continue to use the Environment while the journal
+ * is flushed. If the Environment does not have a journal (i.e. because
+ * Transactions are disabled) then the file is flushed.
+ *
+ * In-Memory Environments are not modified; the function returns
+ * @ref HAM_SUCCESS. This API is not supported for remote Environments.
+ *
+ * @param env A valid Environment handle
+ * @param flags Optional flags for syncing; unused, set to 0
+ *
+ * @return @ref HAM_SUCCESS upon success
+ * @return @ref HAM_INV_PARAMETER if @a env is NULL
+ * @return @ref HAM_IO_ERROR if the journal could not be flushed
+ * @return @ref HAM_NOT_IMPLEMENTED if @a env is a remote Environment
+ */
+HAM_EXPORT ham_status_t HAM_CALLCONV
+ham_env_sync(ham_env_t *env, ham_u32_t flags);
+
+/**
+ * Compacts the Environment file, one small step at a time
+ *
+ * hamsterdb never moves data on its own; when Databases shrink, the
+ * free space is re-used, but the file only shrinks if the pages at the
+ * end of the file are free. This function moves the Btree pages and blobs
+ * (records, extended keys and duplicate tables) from the last
+ * @a max_pages pages of the file to free space at the beginning of the
+ * file, updates all references to them and then truncates the free
+ * pages at the end of the file.
+ *
+ * The Environment is locked while the function runs. To compact the file
+ * without blocking other threads for a long time, call it repeatedly with
+ * a small @a max_pages value (i.e. from a background thread while the
+ * Environment is idle) till @a reclaimed returns 0. Note that each step
+ * has to walk the Btree of each Database to find the references.
+ *
+ * The compaction stops as soon as there is no more free space before the
+ * last @a max_pages pages. Blobs which start before the last
+ * @a max_pages pages are not moved; if such a blob is larger than
+ * @a max_pages pages then it blocks the compaction.
+ *
+ * Pages in the memory mapped area of the file are not truncated, because
+ * the mapping cannot shrink while the Environment is open (they are
+ * truncated when the Environment is closed); open the Environment with
+ * @ref HAM_DISABLE_MMAP to shrink the file immediately.
+ *
+ * In-Memory Environments are not modified; the function returns
+ * @ref HAM_SUCCESS. This API is not supported for remote Environments.
+ *
+ * @param env A valid Environment handle
+ * @param max_pages The number of pages at the end of the file which
+ *        are compacted
+ * @param reclaimed Returns the number of bytes by which the file was
+ *        truncated
+ * @param flags Optional flags for compacting:
+ *     <ul>
+ *      <li>@ref HAM_COMPACT_PUNCH_HOLES</li> Releases the disk space of
+ *        free pages which could not be truncated, without changing the
+ *        file size. Only supported on Linux file systems with support for
+ *        fallocate(FALLOC_FL_PUNCH_HOLE); otherwise ignored.
+ *     </ul>
+ *
+ * @return @ref HAM_SUCCESS upon success
+ * @return @ref HAM_INV_PARAMETER if @a env or @a reclaimed is NULL, or
+ *        if @a max_pages is 0
+ * @return @ref HAM_WRITE_PROTECTED if the Environment was opened with
+ *        @ref HAM_READ_ONLY
+ * @return @ref HAM_NOT_IMPLEMENTED if @a env is a remote Environment
+ */
+HAM_EXPORT ham_status_t HAM_CALLCONV
+ham_env_compact(ham_env_t *env, ham_u32_t max_pages, ham_u64_t *reclaimed,
+            ham_u32_t flags);
+
+/** Flag for @ref ham_env_compact */
+#define HAM_COMPACT_PUNCH_HOLES     0x0001
+
 /* internal use only - don't lock mutex */
 #define HAM_DONT_LOCK        0xf0000000
 
@@ -1130,7 +1305,9 @@ ham_txn_abort(ham_txn_t *txn, ham_u32_t flags);
  * This flag is non persistent. */
 #define HAM_READ_ONLY                               0x00000004
 
-/* unused                                           0x00000008 */
+/** Flag for @ref ham_env_open, @ref ham_env_create.
+ * This flag is non persistent. */
+#define HAM_DIRECT_IO                               0x00000008
 
 /* unused                                           0x00000010 */
 
@@ -1568,6 +1745,61 @@ HAM_EXPORT ham_status_t HAM_CALLCONV
 ham_db_get_key_count(ham_db_t *db, ham_txn_t *txn, ham_u32_t flags,
             ham_u64_t *keycount);
 
+/**
+ * A visitor callback function for @ref ham_db_scan
+ *
+ * The function is called once for every key of the Database. @a partition
+ * is the index of the partition which is currently scanned
+ * (0 <= partition < number of partitions). All calls for the same
+ * partition are made from the same thread, and in ascending key order.
+ * @a record_count is the number of records (duplicates) of this key.
+ *
+ * The key data is only valid during the call. The callback must not
+ * call any hamsterdb function.
+ *
+ * Return 0 to stop scanning the current partition, or any other value to
+ * continue.
+ */
+typedef ham_bool_t HAM_CALLCONV (*ham_scan_visitor_t)(void *context,
+            ham_u32_t partition, const ham_key_t *key,
+            ham_u32_t record_count);
+
+/**
+ * Scans all keys of a Database in parallel
+ *
+ * The key space is split into @a partitions disjoint key ranges (at
+ * boundaries of the internal Btree nodes), and each range is scanned by
+ * its own thread, which calls @a visitor for every key. This function
+ * returns when all partitions were scanned.
+ *
+ * The scan has read-only snapshot semantics: the Database is locked
+ * during the scan, and no other operation can modify it. If Transactions
+ * are enabled then all committed Transactions are flushed to the Btree
+ * before the scan starts; if there are still pending (uncommitted)
+ * operations for this Database, the scan fails with
+ * @ref HAM_TXN_STILL_OPEN.
+ *
+ * If the Database has less Btree nodes than requested partitions then
+ * fewer partitions are scanned. This API is not supported for
+ * remote Databases.
+ *
+ * @param db A valid Database handle
+ * @param partitions The number of partitions (and threads); must be > 0
+ * @param visitor The visitor callback function
+ * @param context A user-supplied pointer which is forwarded to @a visitor
+ * @param flags Optional flags for scanning; unused, set to 0
+ *
+ * @return @ref HAM_SUCCESS upon success
+ * @return @ref HAM_INV_PARAMETER if @a db or @a visitor is NULL, or if
+ *        @a partitions is 0
+ * @return @ref HAM_TXN_STILL_OPEN if this Database has pending operations
+ *        of uncommitted Transactions
+ * @return @ref HAM_NOT_IMPLEMENTED if @a db is a remote Database
+ */
+HAM_EXPORT ham_status_t HAM_CALLCONV
+ham_db_scan(ham_db_t *db, ham_u32_t partitions, ham_scan_visitor_t visitor,
+            void *context, ham_u32_t flags);
+
 /**
  * Retrieve the current value for a given Database setting
  *
@@ -1638,6 +1870,57 @@ ham_db_get_parameters(ham_db_t *db, ham_parameter_t *param);
 /** Parameter name for @ref ham_env_create_db; sets the key size */
 #define HAM_PARAM_RECORD_SIZE           0x00000108
 
+/** Parameter name for @ref ham_env_create; selects the freelist
+ * implementation */
+#define HAM_PARAM_FREELIST_TYPE         0x00000109
+
+/** Value for @ref HAM_PARAM_FREELIST_TYPE: manages the free space with
+ * bitmaps which are stored in the file (default) */
+#define HAM_FREELIST_BITMAP             0
+
+/** Value for @ref HAM_PARAM_FREELIST_TYPE: keeps the free extents in
+ * memory; they are written to the file when the Environment is closed */
+#define HAM_FREELIST_EXTENT             1
+
+/** Parameter name for @ref ham_env_create, @ref ham_env_open; the file
+ * is extended (and pre-allocated) in steps of this many bytes */
+#define HAM_PARAM_FILE_GROWTH_SIZE      0x0000010a
+
+/** Parameter name for @ref ham_env_create, @ref ham_env_open; selects
+ * the I/O backend of the file */
+#define HAM_PARAM_IO_BACKEND            0x0000010b
+
+/** Value for @ref HAM_PARAM_IO_BACKEND: synchronous read/write (default) */
+#define HAM_IO_BACKEND_SYNC             0
+
+/** Value for @ref HAM_PARAM_IO_BACKEND: asynchronous I/O with io_uring
+ * (Linux); falls back to a pool of I/O threads if io_uring is not
+ * available */
+#define HAM_IO_BACKEND_ASYNC            1
+
+/** Value for @ref HAM_PARAM_IO_BACKEND: asynchronous I/O with a pool of
+ * I/O threads */
+#define HAM_IO_BACKEND_THREADS          2
+
+/** Parameter name for @ref ham_env_create, @ref ham_env_open; the
+ * maximum time (in microseconds) the journal flush of a group commit
+ * is delayed to wait for further commits */
+#define HAM_PARAM_GROUP_COMMIT_DELAY    0x0000010c
+
+/** Parameter name for @ref ham_env_create, @ref ham_env_open; the
+ * maximum number of commits which are flushed together */
+#define HAM_PARAM_GROUP_COMMIT_SIZE     0x0000010d
+
+/** Parameter name for @ref ham_env_create, @ref ham_env_open; the
+ * journal is flushed by a background thread in this interval (in
+ * milliseconds), and @ref ham_txn_commit does not wait for the flush */
+#define HAM_PARAM_JOURNAL_SYNC_INTERVAL 0x0000010e
+
+/** Parameter name for @ref ham_env_create, @ref ham_env_open; committed
+ * Transactions are merged into the Database by a background thread, as long
+ * as they do not exceed this many bytes */
+#define HAM_PARAM_TXN_FLUSH_LIMIT       0x0000010f
+
 /** Value for unlimited record sizes */
 #define HAM_RECORD_SIZE_UNLIMITED       ((ham_u32_t)-1)
 
@@ -1961,6 +2244,73 @@ ham_cursor_move(ham_cursor_t *cursor, ham_key_t *key,
 /** Flag for @ref ham_cursor_move */
 #define HAM_ONLY_DUPLICATES             0x0020
 
+/**
+ * Moves the Cursor over several consecutive items and returns them
+ *
+ * This function behaves as if @ref ham_cursor_move was called up to
+ * @a *count times with the same direction, but the Database is only locked
+ * once, the cache is only purged once and (if Transactions are enabled)
+ * only a single temporary Transaction is used for the whole batch. It is
+ * therefore much faster than @ref ham_cursor_move when iterating over
+ * many keys.
+ *
+ * Items are merged from the Btree and from the Transaction index in the
+ * same way as @ref ham_cursor_move does. Afterwards the Cursor points to
+ * the last item that was returned, and further calls to
+ * @ref ham_cursor_move or @ref ham_cursor_get_batch continue from there.
+ *
+ * The data of the returned keys and records is stored in memory which is
+ * owned by the Cursor; it is invalidated by the next call to
+ * @ref ham_cursor_get_batch with this Cursor, or when the Cursor is
+ * closed. Keys with @ref HAM_KEY_USER_ALLOC and records with
+ * @ref HAM_RECORD_USER_ALLOC are copied to the buffers supplied by the
+ * caller.
+ *
+ * When specifying @ref HAM_DIRECT_ACCESS, the record's @a data pointers
+ * will point directly to the records stored by hamsterdb and no data is
+ * copied. As with @ref ham_cursor_move, this flag is only allowed in
+ * In-Memory Databases and not if Transactions are enabled.
+ *
+ * @param cursor A valid Cursor handle
+ * @param keys An optional array of at least @a *count @ref ham_key_t
+ *    structures; receives the keys of the items
+ * @param records An optional array of at least @a *count @ref ham_record_t
+ *    structures; receives the records of the items
+ * @param count The capacity of @a keys and @a records; returns the number
+ *    of items that were actually retrieved
+ * @param flags The direction of the move and optional flags:
+ *    <ul>
+ *      <li>@ref HAM_CURSOR_FIRST </li> starts with the first item in the
+ *        Database and then moves forward
+ *      <li>@ref HAM_CURSOR_LAST </li> starts with the last item in the
+ *        Database and then moves backwards
+ *      <li>@ref HAM_CURSOR_NEXT </li> returns the items following the
+ *        current item; if the Cursor is nil, it starts with the first item
+ *      <li>@ref HAM_CURSOR_PREVIOUS </li> returns the items preceding the
+ *        current item; if the Cursor is nil, it starts with the last item
+ *      <li>@ref HAM_SKIP_DUPLICATES </li> skips duplicate keys
+ *      <li>@ref HAM_DIRECT_ACCESS </li> Only for In-Memory Databases and
+ *        not if Transactions are enabled!
+ *    </ul>
+ *
+ * @return @ref HAM_SUCCESS upon success, if at least one item was returned
+ * @return @ref HAM_INV_PARAMETER if @a cursor or @a count is NULL, if
+ *        @a keys and @a records are both NULL or if an invalid combination
+ *        of flags was specified
+ * @return @ref HAM_INV_PARAMETER if @ref HAM_PARTIAL is specified; partial
+ *        reads are not supported in batches
+ * @return @ref HAM_KEY_NOT_FOUND if there are no more items in the
+ *        requested direction; @a *count is then set to 0
+ * @return @ref HAM_TXN_CONFLICT if @ref HAM_CURSOR_FIRST or @ref
+ *        HAM_CURSOR_LAST is specified but the first (or last) key
+ *        is currently modified in an active Transaction
+ *
+ * @sa ham_cursor_move
+ */
+HAM_EXPORT ham_status_t HAM_CALLCONV
+ham_cursor_get_batch(ham_cursor_t *cursor, ham_key_t *keys,
+            ham_record_t *records, ham_u32_t *count, ham_u32_t flags);
+
 /**
  * Overwrites the current record
  *
@@ -2080,6 +2430,11 @@ ham_cursor_overwrite(ham_cursor_t *cursor, ham_record_t *record,
  *        the first record which' key is larger than the specified
  *        key, whichever of these records is located first.
  *        When such records cannot be located, an error is returned.
+ *    <li>@ref HAM_FIND_PREFIX_MATCH </li> Cursor 'find' flag 'Prefix':
+ *        @a key is a key prefix. The cursor is bound to this prefix (see
+ *        @ref HAM_FIND_PREFIX_MATCH) and moved to the first key which
+ *        starts with the prefix. If there is no such key, an error is
+ *        returned.
  *    <li>@ref HAM_DIRECT_ACCESS </li> Only for In-Memory Databases and
  *        not if Transactions are enabled!
  *        Returns a direct pointer to the data blob stored by the
@@ -2205,6 +2560,23 @@ ham_cursor_find(ham_cursor_t *cursor, ham_key_t *key,
 #define HAM_FIND_NEAR_MATCH     (HAM_FIND_LT_MATCH | HAM_FIND_GT_MATCH  \
                                   | HAM_FIND_EXACT_MATCH)
 
+/**
+ * Cursor 'find' flag 'Prefix': @a key is a prefix; the Cursor is moved
+ * to the first key which starts with this prefix.
+ *
+ * In addition, the prefix is installed as the @a prefix of the Cursor's
+ * filter (see @ref ham_cursor_set_filter); all other criteria of an
+ * existing filter are kept. Subsequent calls to @ref ham_cursor_move
+ * therefore only return keys with this prefix, and return
+ * @ref HAM_KEY_NOT_FOUND when the scan leaves the prefix. Remove the
+ * filter with @ref ham_cursor_set_filter(cursor, NULL).
+ *
+ * Only allowed for Databases with keys of type @ref HAM_TYPE_BINARY, and
+ * not in combination with any other 'find' flag. Not allowed for
+ * @ref ham_db_find.
+ */
+#define HAM_FIND_PREFIX_MATCH           0x8000
+
 /**
  * Inserts a Database item and points the Cursor to the inserted item
  *
@@ -2381,6 +2753,133 @@ ham_cursor_get_duplicate_count(ham_cursor_t *cursor,
 HAM_EXPORT ham_status_t HAM_CALLCONV
 ham_cursor_get_record_size(ham_cursor_t *cursor, ham_u64_t *size);
 
+/**
+ * A predicate for Cursor filters (see @ref ham_cursor_filter_t)
+ *
+ * The predicate is called for every key which passes all other criteria
+ * of the filter. @a record_size is the size of the current record.
+ * The key data is only valid during the call.
+ *
+ * Return a non-zero value if the key and its record should be returned
+ * to the caller, or 0 if they should be skipped.
+ */
+typedef ham_bool_t HAM_CALLCONV (*ham_filter_predicate_t)(void *context,
+            const ham_key_t *key, ham_u64_t record_size);
+
+/**
+ * A filter for Cursor scans; see @ref ham_cursor_set_filter
+ *
+ * All criteria are optional, and a key is returned only if it matches
+ * all of them.
+ */
+typedef struct ham_cursor_filter_t {
+  /** The smallest key which is returned (inclusive), or NULL */
+  ham_key_t *lower_bound;
+
+  /** The largest key which is returned (inclusive), or NULL */
+  ham_key_t *upper_bound;
+
+  /** If not NULL: only keys starting with this prefix are returned.
+   * Keys are compared byte-wise with the prefix. */
+  ham_key_t *prefix;
+
+  /** The minimum record size */
+  ham_u64_t min_record_size;
+
+  /** The maximum record size, or 0 if the record size is unlimited */
+  ham_u64_t max_record_size;
+
+  /** An optional predicate; only supported for local Databases */
+  ham_filter_predicate_t predicate;
+
+  /** A user-supplied pointer which is forwarded to the predicate */
+  void *predicate_context;
+
+} ham_cursor_filter_t;
+
+/**
+ * Installs a filter for Cursor scans
+ *
+ * When a filter is installed, @ref ham_cursor_move and
+ * @ref ham_cursor_get_batch skip all keys (and records) which do not
+ * match the filter. The filter is evaluated inside the Database before
+ * the key and the record are copied to the caller; for remote Databases,
+ * the filter is evaluated by the server, and only matching keys and
+ * records are sent over the network.
+ *
+ * Since the keys are sorted, the scan is terminated with
+ * @ref HAM_KEY_NOT_FOUND as soon as the Cursor leaves the key range
+ * (or the prefix, if the Database uses the default key comparison).
+ * If the current key is the last one of a btree leaf, the internal btree
+ * nodes are checked first; if they show that the next leaf is out of
+ * range, the scan terminates without fetching it.
+ *
+ * @ref HAM_CURSOR_FIRST and @ref HAM_CURSOR_LAST (and @ref HAM_CURSOR_NEXT
+ * or @ref HAM_CURSOR_PREVIOUS on a new Cursor) directly jump to the
+ * beginning (or the end) of the key range or the prefix, instead of
+ * walking from the first (or last) key of the Database.
+ *
+ * The filter is copied, and the application does not have to keep
+ * it alive. Only one filter can be installed per Cursor; installing a new
+ * filter replaces the previous one. Set @a filter to NULL to remove the
+ * current filter. Other Cursor functions (i.e. @ref ham_cursor_find) are
+ * not affected by the filter, but @ref ham_cursor_find with
+ * @ref HAM_FIND_PREFIX_MATCH replaces its @a prefix.
+ *
+ * @param cursor A valid Cursor handle
+ * @param filter The filter, or NULL
+ *
+ * @return @ref HAM_SUCCESS upon success
+ * @return @ref HAM_INV_PARAMETER if @a cursor is NULL, if
+ *        @a max_record_size is smaller than @a min_record_size, or if
+ *        @a predicate is set for a remote Database
+ */
+HAM_EXPORT ham_status_t HAM_CALLCONV
+ham_cursor_set_filter(ham_cursor_t *cursor, const ham_cursor_filter_t *filter);
+
+/**
+ * Moves the Cursor to the next key with a different prefix (skip-scan)
+ *
+ * The prefix consists of the first @a prefix_size bytes of the current
+ * key. The Cursor is moved to the first key which does not start with
+ * this prefix, i.e. to the first key of the next distinct prefix. With
+ * @ref HAM_CURSOR_PREVIOUS, the Cursor is moved to the last key of the
+ * previous distinct prefix.
+ *
+ * This is much faster than calling @ref ham_cursor_move till the prefix
+ * changes: the next prefix is looked up in the btree index, and the
+ * keys in between are never read.
+ * A filter which was installed with @ref ham_cursor_set_filter is
+ * applied to the new position.
+ *
+ * Keys which are shorter than @a prefix_size only share their prefix
+ * with identical keys.
+ *
+ * @param cursor A valid Cursor handle
+ * @param prefix_size The size of the prefix, in bytes
+ * @param key An optional pointer to a @ref ham_key_t structure. If this
+ *    pointer is not NULL, the key of the new item is returned.
+ * @param record An optional pointer to a @ref ham_record_t structure. If
+ *    this pointer is not NULL, the record of the new item is returned.
+ * @param flags Optional flags:
+ *    <ul>
+ *      <li>@ref HAM_CURSOR_NEXT </li> (default) moves to the next prefix
+ *      <li>@ref HAM_CURSOR_PREVIOUS </li> moves to the previous prefix
+ *      <li>@ref HAM_DIRECT_ACCESS </li> see @ref ham_cursor_move
+ *    </ul>
+ *
+ * @return @ref HAM_SUCCESS upon success
+ * @return @ref HAM_INV_PARAMETER if @a cursor is NULL, @a prefix_size is 0,
+ *        if an invalid combination of flags was specified, or if the
+ *        Database does not use keys of type @ref HAM_TYPE_BINARY
+ * @return @ref HAM_CURSOR_IS_NIL if the Cursor does not point to an item
+ * @return @ref HAM_KEY_NOT_FOUND if there is no such key; the Cursor's
+ *        position is not changed
+ */
+HAM_EXPORT ham_status_t HAM_CALLCONV
+ham_cursor_skip_prefix(ham_cursor_t *cursor, ham_u32_t prefix_size,
+            ham_key_t *key, ham_record_t *record, ham_u32_t flags);
+
 /**
  * Closes a Database Cursor
  *
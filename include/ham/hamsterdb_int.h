@@ -144,6 +144,15 @@ ham_cursor_get_database(ham_cursor_t *cursor);
  */
 #define HAM_METRICS_VERSION         4
 
+/**
+ * The number of buckets of the commit latency histogram in
+ * @ref ham_env_metrics_t. Bucket 0 counts the commits which took less
+ * than 16 microseconds, bucket i counts the commits which took
+ * [2^(i+3), 2^(i+4)) microseconds. The last bucket also counts all
+ * slower commits.
+ */
+#define HAM_COMMIT_LATENCY_BUCKETS  20
+
 typedef struct ham_env_metrics_t {
   // the version indicator - must be HAM_METRICS_VERSION
   ham_u16_t version;
@@ -222,6 +231,57 @@ typedef struct ham_env_metrics_t {
   // (global) number of extended duplicate tables
   ham_u64_t extended_duptables;
 
+  // (global) number of comparisons with extended keys which were resolved
+  // with the inline key prefix
+  ham_u64_t extended_key_prefix_hits;
+
+  // (global) number of comparisons with extended keys which had to read
+  // the full key from the blob (or the cache)
+  ham_u64_t extended_key_prefix_misses;
+
+  // number of pages which were read from the memory mapped area
+  // (disk only)
+  ham_u64_t device_mapped_reads;
+
+  // number of pages which were read with read(2) because they were not
+  // mapped (disk only)
+  ham_u64_t device_unmapped_reads;
+
+  // size of the memory mapped area (disk only)
+  ham_u64_t device_mapped_size;
+
+  // number of pages which were read ahead in the background and then
+  // requested (disk only, asynchronous I/O backends)
+  ham_u64_t device_prefetch_hits;
+
+  // number of write requests sent to the file (disk only)
+  ham_u64_t device_writes;
+
+  // number of bytes written to the file (disk only)
+  ham_u64_t device_bytes_written;
+
+  // average size of a write request; adjacent pages are written
+  // with a single request (disk only)
+  ham_u64_t device_avg_write_size;
+
+  // number of journal flushes for committed Transactions; with group
+  // commit, a single flush makes several commits durable
+  ham_u64_t journal_commit_syncs;
+
+  // number of commits which were made durable by these flushes
+  ham_u64_t journal_synced_commits;
+
+  // number of write requests to the journal; the entries are buffered
+  // and written when a Transaction is committed
+  ham_u64_t journal_writes;
+
+  // number of bytes written to the journal
+  ham_u64_t journal_bytes_written;
+
+  // histogram of the latency of ham_txn_commit, in microseconds
+  // (see HAM_COMMIT_LATENCY_BUCKETS)
+  ham_u64_t txn_commit_latency[HAM_COMMIT_LATENCY_BUCKETS];
+
 } ham_env_metrics_t;
 
 /**
@@ -0,0 +1,408 @@
+/*
+ * Copyright (C) 2005-2013 Christoph Rupp (chris@crupp.de).
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * See files COPYING.* for License information.
+ */
+
+#include "config.h"
+
+#include <deque>
+#include <vector>
+#include <string.h>
+#include <errno.h>
+#include <boost/bind.hpp>
+
+#include <ham/hamsterdb.h>
+
+#if HAVE_LINUX_IO_URING_H
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#  include <linux/io_uring.h>
+#endif
+
+#include "error.h"
+#include "mutex.h"
+#include "os.h"
+#include "async_io.h"
+
+#if HAVE_LINUX_IO_URING_H && defined(__NR_io_uring_setup)
+#  define HAM_HAVE_IO_URING 1
+#endif
+
+namespace hamsterdb {
+
+// Processes a request synchronously; also used to complete the rest of
+// a request which was only partially transferred
+static void
+run_request(AsyncIoRequest *request, ham_u32_t offset = 0)
+{
+  ham_u8_t *buffer = (ham_u8_t *)request->buffer + offset;
+  try {
+    if (request->type == AsyncIoRequest::kRead)
+      os_pread(request->fd, request->offset + offset, buffer,
+                      request->size - offset);
+    else
+      os_pwrite(request->fd, request->offset + offset, buffer,
+                      request->size - offset);
+    request->status = 0;
+  }
+  catch (Exception &ex) {
+    request->status = ex.code;
+  }
+}
+
+//
+// a pool of I/O threads which process the requests with pread/pwrite
+//
+class ThreadPoolAsyncIo : public AsyncIo {
+    enum {
+      // the number of I/O threads
+      kThreads = 4
+    };
+
+  public:
+    ThreadPoolAsyncIo()
+      : m_outstanding(0), m_shutdown(false) {
+      for (int i = 0; i < kThreads; i++)
+        m_threads.push_back(new Thread(boost::bind(
+                        &ThreadPoolAsyncIo::run, this)));
+    }
+
+    virtual ~ThreadPoolAsyncIo() {
+      {
+        ScopedLock lock(m_mutex);
+        m_shutdown = true;
+        m_work_cond.notify_all();
+      }
+      for (std::vector<Thread *>::iterator it = m_threads.begin();
+              it != m_threads.end(); it++) {
+        (*it)->join();
+        delete *it;
+      }
+    }
+
+    virtual void submit(AsyncIoRequest **requests, ham_u32_t count) {
+      ScopedLock lock(m_mutex);
+      for (ham_u32_t i = 0; i < count; i++) {
+        requests[i]->done = false;
+        m_queue.push_back(requests[i]);
+      }
+      m_outstanding += count;
+      m_work_cond.notify_all();
+    }
+
+    virtual void wait(AsyncIoRequest *request) {
+      ScopedLock lock(m_mutex);
+      while (!request->done)
+        m_done_cond.wait(lock);
+    }
+
+    virtual void wait_all() {
+      ScopedLock lock(m_mutex);
+      while (m_outstanding > 0)
+        m_done_cond.wait(lock);
+    }
+
+    virtual const char *get_name() const {
+      return ("threads");
+    }
+
+  private:
+    // the main loop of the I/O threads
+    void run() {
+      ScopedLock lock(m_mutex);
+      while (true) {
+        while (m_queue.empty() && !m_shutdown)
+          m_work_cond.wait(lock);
+        if (m_queue.empty())
+          return;
+
+        AsyncIoRequest *request = m_queue.front();
+        m_queue.pop_front();
+
+        lock.unlock();
+        run_request(request);
+        lock.lock();
+
+        request->done = true;
+        m_outstanding--;
+        m_done_cond.notify_all();
+      }
+    }
+
+    // the I/O threads
+    std::vector<Thread *> m_threads;
+
+    // the queue of requests which were not yet started
+    std::deque<AsyncIoRequest *> m_queue;
+
+    // the number of requests which were not yet completed
+    ham_u32_t m_outstanding;
+
+    // true if the threads should terminate
+    bool m_shutdown;
+
+    // protects all members
+    Mutex m_mutex;
+
+    // signals new requests (or the shutdown)
+    Condition m_work_cond;
+
+    // signals completed requests
+    Condition m_done_cond;
+};
+
+#ifdef HAM_HAVE_IO_URING
+
+//
+// submits the requests to an io_uring; the rings are mapped into
+// the process and accessed without a library
+//
+class UringAsyncIo : public AsyncIo {
+    enum {
+      // the number of submission queue entries
+      kQueueDepth = 64
+    };
+
+  public:
+    UringAsyncIo()
+      : m_fd(-1), m_sq_ptr(MAP_FAILED), m_sq_size(0), m_cq_ptr(MAP_FAILED),
+        m_cq_size(0), m_sqes(0), m_sqes_size(0), m_to_submit(0),
+        m_in_flight(0) {
+    }
+
+    virtual ~UringAsyncIo() {
+      if (m_fd >= 0)
+        wait_all();
+      if (m_sqes)
+        ::munmap(m_sqes, m_sqes_size);
+      if (m_cq_ptr != MAP_FAILED && m_cq_ptr != m_sq_ptr)
+        ::munmap(m_cq_ptr, m_cq_size);
+      if (m_sq_ptr != MAP_FAILED)
+        ::munmap(m_sq_ptr, m_sq_size);
+      if (m_fd >= 0)
+        ::close(m_fd);
+    }
+
+    // Sets up the ring; returns false if io_uring is not available
+    // (i.e. the kernel is too old, or the syscall is blocked)
+    bool initialize() {
+      struct io_uring_params p;
+      memset(&p, 0, sizeof(p));
+      m_fd = (int)syscall(__NR_io_uring_setup, kQueueDepth, &p);
+      if (m_fd < 0) {
+        ham_log(("io_uring_setup failed with status %d (%s)", errno,
+                    strerror(errno)));
+        return (false);
+      }
+
+      m_sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+      m_cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+      if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (m_cq_size > m_sq_size)
+          m_sq_size = m_cq_size;
+        m_cq_size = m_sq_size;
+      }
+
+      m_sq_ptr = ::mmap(0, m_sq_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+      if (m_sq_ptr == MAP_FAILED)
+        return (false);
+      if (p.features & IORING_FEAT_SINGLE_MMAP)
+        m_cq_ptr = m_sq_ptr;
+      else {
+        m_cq_ptr = ::mmap(0, m_cq_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+        if (m_cq_ptr == MAP_FAILED)
+          return (false);
+      }
+
+      m_sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+      void *sqes = ::mmap(0, m_sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+      if (sqes == MAP_FAILED)
+        return (false);
+      m_sqes = (struct io_uring_sqe *)sqes;
+
+      ham_u8_t *sq = (ham_u8_t *)m_sq_ptr;
+      m_sq_head = (unsigned *)(sq + p.sq_off.head);
+      m_sq_tail = (unsigned *)(sq + p.sq_off.tail);
+      m_sq_mask = *(unsigned *)(sq + p.sq_off.ring_mask);
+      m_sq_entries = p.sq_entries;
+      m_sq_array = (unsigned *)(sq + p.sq_off.array);
+
+      ham_u8_t *cq = (ham_u8_t *)m_cq_ptr;
+      m_cq_head = (unsigned *)(cq + p.cq_off.head);
+      m_cq_tail = (unsigned *)(cq + p.cq_off.tail);
+      m_cq_mask = *(unsigned *)(cq + p.cq_off.ring_mask);
+      m_cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+      return (true);
+    }
+
+    virtual void submit(AsyncIoRequest **requests, ham_u32_t count) {
+      for (ham_u32_t i = 0; i < count; i++) {
+        // never have more requests in flight than the completion queue
+        // can hold
+        while (m_in_flight + m_to_submit >= m_sq_entries)
+          enter(1);
+
+        AsyncIoRequest *request = requests[i];
+        request->done = false;
+
+        unsigned tail = *m_sq_tail;
+        unsigned index = tail & m_sq_mask;
+        struct io_uring_sqe *sqe = &m_sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = request->type == AsyncIoRequest::kRead
+                        ? IORING_OP_READ
+                        : IORING_OP_WRITE;
+        sqe->fd = request->fd;
+        sqe->off = request->offset;
+        sqe->addr = (unsigned long)request->buffer;
+        sqe->len = request->size;
+        sqe->user_data = (unsigned long)request;
+        m_sq_array[index] = index;
+        __atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+        m_to_submit++;
+      }
+
+      // start the I/O
+      enter(0);
+    }
+
+    virtual void wait(AsyncIoRequest *request) {
+      while (!request->done)
+        enter(1);
+    }
+
+    virtual void wait_all() {
+      while (m_in_flight + m_to_submit > 0)
+        enter(1);
+    }
+
+    virtual const char *get_name() const {
+      return ("io_uring");
+    }
+
+  private:
+    // Submits the queued entries, waits for |min_complete| completions
+    // and processes all completions
+    void enter(unsigned min_complete) {
+      unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+      while (true) {
+        int r = (int)syscall(__NR_io_uring_enter, m_fd, m_to_submit,
+                        min_complete, flags, 0, 0);
+        if (r >= 0) {
+          m_in_flight += r;
+          m_to_submit -= r;
+          break;
+        }
+        if (errno == EINTR)
+          continue;
+        // EAGAIN/EBUSY: the kernel is busy; wait for completions first
+        if ((errno == EAGAIN || errno == EBUSY) && m_in_flight > 0) {
+          flags = IORING_ENTER_GETEVENTS;
+          min_complete = 1;
+          continue;
+        }
+        ham_log(("io_uring_enter failed with status %d (%s)", errno,
+                    strerror(errno)));
+        throw Exception(HAM_IO_ERROR);
+      }
+      reap();
+    }
+
+    // Processes all completed requests
+    void reap() {
+      unsigned head = *m_cq_head;
+      unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+      while (head != tail) {
+        struct io_uring_cqe *cqe = &m_cqes[head & m_cq_mask];
+        complete((AsyncIoRequest *)(unsigned long)cqe->user_data, cqe->res);
+        head++;
+        m_in_flight--;
+      }
+      __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    // Completes a request; short transfers are finished synchronously,
+    // and so are requests which are not supported by the kernel
+    void complete(AsyncIoRequest *request, int res) {
+      if (res >= 0 && (ham_u32_t)res == request->size)
+        request->status = 0;
+      else if (res >= 0)
+        run_request(request, (ham_u32_t)res);
+      else if (res == -EINVAL || res == -EOPNOTSUPP)
+        run_request(request);
+      else {
+        ham_log(("async I/O failed with status %d (%s)", -res,
+                    strerror(-res)));
+        request->status = HAM_IO_ERROR;
+      }
+      request->done = true;
+    }
+
+    // the io_uring file descriptor
+    int m_fd;
+
+    // the mapped submission queue ring
+    void *m_sq_ptr;
+
+    // the size of the submission queue ring
+    size_t m_sq_size;
+
+    // the mapped completion queue ring (can be identical to m_sq_ptr)
+    void *m_cq_ptr;
+
+    // the size of the completion queue ring
+    size_t m_cq_size;
+
+    // the submission queue entries
+    struct io_uring_sqe *m_sqes;
+
+    // the size of the submission queue entries
+    size_t m_sqes_size;
+
+    // pointers into the submission queue ring
+    unsigned *m_sq_head;
+    unsigned *m_sq_tail;
+    unsigned *m_sq_array;
+    unsigned m_sq_mask;
+    unsigned m_sq_entries;
+
+    // pointers into the completion queue ring
+    unsigned *m_cq_head;
+    unsigned *m_cq_tail;
+    unsigned m_cq_mask;
+    struct io_uring_cqe *m_cqes;
+
+    // number of queued entries which were not yet submitted
+    unsigned m_to_submit;
+
+    // number of submitted requests which were not yet completed
+    unsigned m_in_flight;
+};
+
+#endif // HAM_HAVE_IO_URING
+
+AsyncIo *
+AsyncIo::create(ham_u32_t backend)
+{
+#ifdef HAM_HAVE_IO_URING
+  if (backend == HAM_IO_BACKEND_ASYNC) {
+    UringAsyncIo *uring = new UringAsyncIo();
+    if (uring->initialize())
+      return (uring);
+    delete uring;
+  }
+#endif
+  return (new ThreadPoolAsyncIo());
+}
+
+} // namespace hamsterdb
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2005-2013 Christoph Rupp (chris@crupp.de).
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * See files COPYING.* for License information.
+ */
+
+/*
+ * asynchronous file I/O; used by the AsyncDiskDevice
+ *
+ * Requests are submitted in batches and run in the background, either
+ * with io_uring (Linux) or with a pool of I/O threads which call
+ * pread/pwrite. The interface is not thread-safe: the requests are
+ * submitted and waited for by a single thread.
+ */
+
+#ifndef HAM_ASYNC_IO_H__
+#define HAM_ASYNC_IO_H__
+
+#include <ham/types.h>
+
+namespace hamsterdb {
+
+// an asynchronous read or write request
+struct AsyncIoRequest {
+  enum {
+    // read |size| bytes from |offset| into |buffer|
+    kRead  = 1,
+
+    // write |size| bytes from |buffer| to |offset|
+    kWrite = 2
+  };
+
+  AsyncIoRequest(int type_ = kRead, ham_fd_t fd_ = HAM_INVALID_FD,
+          ham_u64_t offset_ = 0, void *buffer_ = 0, ham_u32_t size_ = 0)
+    : type(type_), fd(fd_), offset(offset_), buffer(buffer_), size(size_),
+      done(false), status(0) {
+  }
+
+  // the request type (kRead or kWrite)
+  int type;
+
+  // the file handle
+  ham_fd_t fd;
+
+  // the file offset
+  ham_u64_t offset;
+
+  // the data buffer
+  void *buffer;
+
+  // the number of bytes to read or write
+  ham_u32_t size;
+
+  // true if the request was completed
+  bool done;
+
+  // 0 if the request was successful, otherwise an error code
+  ham_status_t status;
+};
+
+class AsyncIo {
+  public:
+    virtual ~AsyncIo() {
+    }
+
+    // Creates an AsyncIo object for the requested backend
+    // (HAM_IO_BACKEND_ASYNC or HAM_IO_BACKEND_THREADS). io_uring is used
+    // if possible; otherwise requests are processed by a thread pool
+    static AsyncIo *create(ham_u32_t backend);
+
+    // Submits a batch of requests; returns immediately. The requests must
+    // remain valid till they are completed
+    virtual void submit(AsyncIoRequest **requests, ham_u32_t count) = 0;
+
+    // Waits till |request| is completed
+    virtual void wait(AsyncIoRequest *request) = 0;
+
+    // Waits till all submitted requests are completed
+    virtual void wait_all() = 0;
+
+    // Returns the name of the implementation ("io_uring" or "threads")
+    virtual const char *get_name() const = 0;
+};
+
+} // namespace hamsterdb
+
+#endif /* HAM_ASYNC_IO_H__ */
@@ -141,6 +141,14 @@ class BlobManager
     virtual void free(LocalDatabase *db, ham_u64_t blob_id,
                     Page *page = 0, ham_u32_t flags = 0) = 0;
 
+    // Moves a blob which is stored at or above |threshold| to free space
+    // below |threshold| (ham_env_compact). Returns the new blob-id, or
+    // |blob_id| if the blob was not moved.
+    virtual ham_u64_t relocate(LocalDatabase *db, ham_u64_t blob_id,
+                    ham_u64_t threshold) {
+      return (blob_id);
+    }
+
     // Fills in the current metrics
     void get_metrics(ham_env_metrics_t *metrics) const {
       metrics->blob_total_allocated = m_blob_total_allocated;
@@ -12,6 +12,8 @@
 
 #include "config.h"
 
+#include <vector>
+
 #include "device.h"
 #include "error.h"
 #include "page_manager.h"
@@ -545,3 +547,70 @@ DiskBlobManager::free(LocalDatabase *db, ham_u64_t blobid, Page *page,
                 (ham_u32_t)blob_header.get_alloc_size());
 }
 
+
+ham_u64_t
+DiskBlobManager::relocate(LocalDatabase *db, ham_u64_t blobid,
+                ham_u64_t threshold)
+{
+  ham_assert(blobid % Freelist::kBlobAlignment == 0);
+
+  if (blobid < threshold)
+    return (blobid);
+
+  // fetch the blob header
+  PBlobHeader blob_header;
+  read_chunk(0, 0, blobid, db, (ham_u8_t *)&blob_header, sizeof(blob_header));
+
+  // sanity check
+  ham_verify(blob_header.get_self() == blobid);
+  if (blob_header.get_self() != blobid)
+    throw Exception(HAM_BLOB_NOT_FOUND);
+
+  // the blob is only moved if the freelist has space below |threshold|.
+  // The freelist does not necessarily return the lowest address; areas
+  // above the threshold are kept till a suitable one is found (otherwise
+  // they would be returned again), then they're released
+  PageManager *pm = m_env->get_page_manager();
+  ham_u32_t alloc_size = (ham_u32_t)blob_header.get_alloc_size();
+  std::vector<ham_u64_t> spare;
+  ham_u64_t addr;
+  while ((addr = pm->alloc_blob(db, alloc_size))) {
+    if (addr + alloc_size <= threshold)
+      break;
+    spare.push_back(addr);
+  }
+  for (std::vector<ham_u64_t>::iterator it = spare.begin();
+          it != spare.end(); ++it)
+    pm->add_to_freelist(db, *it, alloc_size);
+  if (!addr)
+    return (blobid);
+
+  // write the new header, then copy the payload page by page
+  blob_header.set_self(addr);
+
+  ham_u8_t *chunk_data[1];
+  ham_u32_t chunk_size[1];
+  chunk_data[0] = (ham_u8_t *)&blob_header;
+  chunk_size[0] = sizeof(blob_header);
+  write_chunks(db, 0, addr, true, false, chunk_data, chunk_size, 1);
+
+  ByteArray buffer;
+  ham_u32_t page_size = m_env->get_page_size();
+  ham_u64_t remaining = blob_header.get_size();
+  ham_u64_t offset = sizeof(blob_header);
+  while (remaining) {
+    ham_u32_t size = remaining > page_size ? page_size : (ham_u32_t)remaining;
+    ham_u8_t *ptr = (ham_u8_t *)buffer.resize(size);
+    read_chunk(0, 0, blobid + offset, db, ptr, size);
+    chunk_data[0] = ptr;
+    chunk_size[0] = size;
+    write_chunks(db, 0, addr + offset, true, false,
+                    chunk_data, chunk_size, 1);
+    offset += size;
+    remaining -= size;
+  }
+
+  // move the old blob to the freelist
+  pm->add_to_freelist(db, blobid, alloc_size);
+  return (addr);
+}
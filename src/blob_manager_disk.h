@@ -53,6 +53,11 @@ class DiskBlobManager : public BlobManager
     void free(LocalDatabase *db, ham_u64_t blobid,
                     Page *page = 0, ham_u32_t flags = 0);
 
+    // moves a blob which is stored at or above |threshold| to a free
+    // area below |threshold|; returns the new blob-id
+    ham_u64_t relocate(LocalDatabase *db, ham_u64_t blobid,
+                    ham_u64_t threshold);
+
   private:
     friend class DuplicateManager;
 
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2005-2013 Christoph Rupp (chris@crupp.de).
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * See files COPYING.* for License information.
+ */
+
+/**
+ * @brief btree compaction (ham_env_compact)
+ *
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <vector>
+
+#include "page_manager.h"
+#include "btree_index.h"
+#include "btree_node_proxy.h"
+#include "btree_cursor.h"
+#include "btree_stats.h"
+
+namespace hamsterdb {
+
+//
+// Moves the pages and blobs at the end of the file to free space at the
+// beginning of the file, so that the end of the file can be truncated.
+//
+// The tree is walked level by level, from left to right (as in
+// BtreeEnumAction). Each child pointer which points to a page at or above
+// the threshold is updated with the page's new address; the root page
+// is updated in the btree descriptor. The blobs are moved by the nodes
+// which reference them (BtreeNodeProxy::relocate_blobs).
+//
+class BtreeCompactAction
+{
+  public:
+    BtreeCompactAction(BtreeIndex *btree, ham_u64_t threshold)
+      : m_btree(btree), m_threshold(threshold), m_moved(0),
+        m_freelist_exhausted(false) {
+      ham_assert(m_btree->get_root_address() != 0);
+    }
+
+    ham_u32_t run() {
+      // move the root page
+      ham_u64_t address = m_btree->get_root_address();
+      if (address >= m_threshold) {
+        ham_u64_t new_address = move_page(address);
+        if (new_address) {
+          m_btree->set_root_address(new_address);
+          address = new_address;
+        }
+      }
+
+      while (address) {
+        Page *page = fetch_page(address);
+
+        // the first child of the leftmost node is the leftmost node of
+        // the next level
+        ham_u64_t next_level = 0;
+
+        // now walk through all nodes of this level
+        while (page) {
+          BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+
+          ham_u32_t moved = node->relocate_blobs(m_threshold);
+          if (moved) {
+            page->set_dirty(true);
+            m_moved += moved;
+          }
+
+          if (!node->is_leaf()) {
+            ham_u64_t child = move_child(node->get_ptr_down());
+            if (child != node->get_ptr_down()) {
+              node->set_ptr_down(child);
+              page->set_dirty(true);
+            }
+            if (!next_level)
+              next_level = child;
+
+            for (ham_u32_t slot = 0; slot < node->get_count(); slot++) {
+              child = move_child(node->get_record_id(slot));
+              if (child != node->get_record_id(slot)) {
+                node->set_record_id(slot, child);
+                page->set_dirty(true);
+              }
+            }
+          }
+
+          // load the right sibling
+          ham_u64_t right = node->get_right();
+          page = right ? fetch_page(right) : 0;
+        }
+
+        address = next_level;
+      }
+
+      // return the free pages above the threshold to the freelist
+      PageManager *pm = m_btree->get_db()->get_local_env()->get_page_manager();
+      for (std::vector<Page *>::iterator it = m_spare_pages.begin();
+              it != m_spare_pages.end(); ++it)
+        pm->add_to_freelist(*it);
+      m_spare_pages.clear();
+
+      return (m_moved);
+    }
+
+  private:
+    // Fetches a page of this btree
+    Page *fetch_page(ham_u64_t address) {
+      LocalDatabase *db = m_btree->get_db();
+      return (db->get_local_env()->get_page_manager()->fetch_page(db,
+                              address));
+    }
+
+    // Moves the child page at |address| if it is stored at or above the
+    // threshold; returns the (new) address of the child
+    ham_u64_t move_child(ham_u64_t address) {
+      if (address < m_threshold)
+        return (address);
+      ham_u64_t new_address = move_page(address);
+      return (new_address ? new_address : address);
+    }
+
+    // Copies the page at |address| to a free page below the threshold,
+    // updates the sibling pointers and moves the old page to the freelist.
+    // The caller updates the parent's pointer. Returns the new address,
+    // or 0 if there's no free page
+    ham_u64_t move_page(ham_u64_t address) {
+      if (m_freelist_exhausted)
+        return (0);
+
+      LocalDatabase *db = m_btree->get_db();
+      LocalEnvironment *env = db->get_local_env();
+      PageManager *pm = env->get_page_manager();
+
+      // the freelist does not necessarily return the lowest free page;
+      // pages above the threshold are kept till the end, otherwise they
+      // would be returned again
+      Page *new_page;
+      while ((new_page = pm->alloc_page(db, Page::kTypeBindex,
+                      PageManager::kOnlyFromFreelist))) {
+        if (new_page->get_address() < m_threshold)
+          break;
+        m_spare_pages.push_back(new_page);
+      }
+      if (!new_page) {
+        m_freelist_exhausted = true;
+        return (0);
+      }
+
+      Page *page = fetch_page(address);
+
+      // cursors which are coupled to the old page become uncoupled; the
+      // statistics must not refer to the old page
+      BtreeCursor::uncouple_all_cursors(page);
+      m_btree->get_statistics()->reset_page(page);
+
+      // copy the page (including the page header and its page type)
+      if (new_page->get_node_proxy()) {
+        delete new_page->get_node_proxy();
+        new_page->set_node_proxy(0);
+      }
+      memcpy(new_page->get_data(), page->get_data(), env->get_page_size());
+      new_page->set_dirty(true);
+
+      // update the siblings
+      ham_u64_t new_address = new_page->get_address();
+      BtreeNodeProxy *node = m_btree->get_node_from_page(new_page);
+      if (node->get_left()) {
+        Page *sibling = fetch_page(node->get_left());
+        m_btree->get_node_from_page(sibling)->set_right(new_address);
+        sibling->set_dirty(true);
+      }
+      if (node->get_right()) {
+        Page *sibling = fetch_page(node->get_right());
+        m_btree->get_node_from_page(sibling)->set_left(new_address);
+        sibling->set_dirty(true);
+      }
+
+      pm->add_to_freelist(page);
+      m_moved++;
+      return (new_address);
+    }
+
+    // the Btree
+    BtreeIndex *m_btree;
+
+    // pages and blobs at or above this address are moved
+    ham_u64_t m_threshold;
+
+    // number of moved pages and blobs
+    ham_u32_t m_moved;
+
+    // true if the freelist has no more free pages below the threshold
+    bool m_freelist_exhausted;
+
+    // free pages at or above the threshold which were allocated from
+    // the freelist
+    std::vector<Page *> m_spare_pages;
+};
+
+ham_u32_t
+BtreeIndex::compact(ham_u64_t threshold)
+{
+  BtreeCompactAction bca(this, threshold);
+  return (bca.run());
+}
+
+} // namespace hamsterdb
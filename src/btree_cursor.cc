@@ -353,6 +353,11 @@ BtreeCursor::move_next(ham_u32_t flags)
 
   Page *page = env->get_page_manager()->fetch_page(db, node->get_right());
 
+  // start reading the next sibling in the background; a scan will most
+  // likely request it soon
+  node = m_btree->get_node_from_page(page);
+  env->get_page_manager()->prefetch_page(node->get_right());
+
   // couple this cursor to the smallest key in this page
   couple_to_page(page, 0, 0);
 
@@ -398,6 +403,9 @@ BtreeCursor::move_previous(ham_u32_t flags)
     Page *page = env->get_page_manager()->fetch_page(db, node->get_left());
     node = m_btree->get_node_from_page(page);
 
+    // start reading the previous sibling in the background
+    env->get_page_manager()->prefetch_page(node->get_left());
+
     // couple this cursor to the highest key in this page
     couple_to_page(page, node->get_count() - 1);
   }
@@ -16,6 +16,9 @@
 
 #include "config.h"
 
+#include <boost/bind.hpp>
+
+#include "mutex.h"
 #include "page_manager.h"
 #include "btree_index.h"
 #include "btree_node_proxy.h"
@@ -98,5 +101,228 @@ BtreeIndex::enumerate(BtreeVisitor &visitor, bool visit_internal_nodes)
   bea.run();
 }
 
+//
+// Enumerates the leaf nodes in parallel. The main thread picks the topmost
+// level of the tree which has at least as many nodes as there are
+// partitions, and distributes those nodes (and therefore the key ranges of
+// their subtrees) evenly to the partitions. Each partition then walks the
+// leaf level from the leftmost leaf of its first subtree up to the first
+// leaf of the next partition.
+//
+class BtreeParallelEnumAction
+{
+  public:
+    BtreeParallelEnumAction(BtreeIndex *btree,
+                    std::vector<BtreeVisitor *> &visitors, Mutex &mutex)
+      : m_btree(btree), m_visitors(visitors), m_mutex(mutex) {
+      ham_assert(m_btree->get_root_address() != 0);
+      ham_assert(m_visitors.size() > 0);
+    }
+
+    void run() {
+      ham_u32_t partitions = (ham_u32_t)m_visitors.size();
+
+      // collect the nodes of the topmost level which is large enough
+      std::vector<ham_u64_t> level;
+      ham_u64_t address = m_btree->get_root_address();
+      while (address) {
+        level.clear();
+        BtreeNodeProxy *node = fetch_node(address);
+        ham_u64_t ptr_down = node->get_ptr_down();
+        while (true) {
+          level.push_back(address);
+          address = node->get_right();
+          if (!address)
+            break;
+          node = fetch_node(address);
+        }
+
+        if (level.size() >= partitions)
+          break;
+        address = ptr_down;
+      }
+
+      // there might be fewer leafs than partitions
+      if (level.size() < partitions)
+        partitions = (ham_u32_t)level.size();
+
+      // for each partition: find the leftmost leaf of its first subtree;
+      // the last partition walks till the end of the leaf level
+      std::vector<ham_u64_t> leafs(partitions + 1, 0);
+      for (ham_u32_t i = 0; i < partitions; i++)
+        leafs[i] = get_leftmost_leaf(level[(size_t)i * level.size()
+                                / partitions]);
+
+      // the main thread processes the first partition, the others are
+      // processed by worker threads
+      std::vector<ham_status_t> status(partitions, 0);
+      std::vector<Thread *> threads;
+      for (ham_u32_t i = 1; i < partitions; i++)
+        threads.push_back(new Thread(boost::bind(
+                        &BtreeParallelEnumAction::run_partition, this,
+                        i, leafs[i], leafs[i + 1], &status[i])));
+
+      run_partition(0, leafs[0], leafs[1], &status[0]);
+
+      for (std::vector<Thread *>::iterator it = threads.begin();
+              it != threads.end(); it++) {
+        (*it)->join();
+        delete *it;
+      }
+
+      for (ham_u32_t i = 0; i < partitions; i++) {
+        if (status[i])
+          throw Exception(status[i]);
+      }
+    }
+
+  private:
+    // Fetches a page and returns its node; the PageManager and the page's
+    // node proxy are shared by all threads
+    BtreeNodeProxy *fetch_node(ham_u64_t address) {
+      LocalDatabase *db = m_btree->get_db();
+
+      ScopedLock lock(m_mutex);
+      Page *page = db->get_local_env()->get_page_manager()->fetch_page(db,
+                      address);
+      return (m_btree->get_node_from_page(page));
+    }
+
+    // Follows the ptr_down-pointers from |address| down to the leaf level
+    ham_u64_t get_leftmost_leaf(ham_u64_t address) {
+      while (true) {
+        ham_u64_t ptr_down = fetch_node(address)->get_ptr_down();
+        if (!ptr_down)
+          return (address);
+        address = ptr_down;
+      }
+    }
+
+    // Enumerates the leafs from |address| up to (but excluding) |end|
+    void run_partition(ham_u32_t partition, ham_u64_t address,
+                    ham_u64_t end, ham_status_t *status) {
+      try {
+        while (address && address != end) {
+          BtreeNodeProxy *node = fetch_node(address);
+          address = node->get_right();
+          node->enumerate(*m_visitors[partition]);
+        }
+      }
+      catch (Exception &ex) {
+        *status = ex.code;
+      }
+    }
+
+    BtreeIndex *m_btree;
+    std::vector<BtreeVisitor *> &m_visitors;
+    Mutex &m_mutex;
+};
+
+void
+BtreeIndex::enumerate_parallel(std::vector<BtreeVisitor *> &visitors,
+                Mutex &mutex)
+{
+  BtreeParallelEnumAction bpea(this, visitors, mutex);
+  bpea.run();
+}
+
+//
+// Forwards the keys of a single partition to the user's
+// |ham_scan_visitor_t| callback (ham_db_scan)
+//
+class ScanVisitor : public BtreeVisitor
+{
+  public:
+    ScanVisitor(LocalDatabase *db, Mutex &mutex, ham_u32_t partition,
+                    ham_scan_visitor_t visitor, void *context)
+      : m_db(db), m_mutex(mutex), m_partition(partition),
+        m_visitor(visitor), m_context(context), m_node(0), m_slot(0),
+        m_stopped(false) {
+    }
+
+    virtual bool operator()(BtreeNodeProxy *node, const void *key_data,
+                    ham_u8_t key_flags, ham_u32_t key_size,
+                    ham_u64_t record_id) {
+      if (m_stopped)
+        return (false);
+
+      // enumerate() visits the slots of a node in ascending order
+      if (node != m_node) {
+        m_node = node;
+        m_slot = 0;
+      }
+
+      ham_key_t key = {0};
+      ham_u64_t recno;
+      ham_u32_t record_count;
+
+      // extended keys and duplicate tables are stored in blobs, and
+      // fetching them requires access to the PageManager
+      if (key_flags & (BtreeKey::kExtendedKey
+                            | BtreeKey::kExtendedDuplicates)) {
+        ScopedLock lock(m_mutex);
+        if (key_flags & BtreeKey::kExtendedKey)
+          node->get_key(m_slot, &m_arena, &key);
+        record_count = node->get_record_count(m_slot);
+      }
+      else
+        record_count = node->get_record_count(m_slot);
+
+      if (!(key_flags & BtreeKey::kExtendedKey)) {
+        // record number keys are stored in database endian
+        if (m_db->get_rt_flags() & HAM_RECORD_NUMBER) {
+          recno = ham_db2h64(*(ham_u64_t *)key_data);
+          key.data = &recno;
+        }
+        else
+          key.data = (void *)key_data;
+        key.size = (ham_u16_t)key_size;
+      }
+
+      m_slot++;
+
+      if (!m_visitor(m_context, m_partition, &key, record_count))
+        m_stopped = true;
+      return (!m_stopped);
+    }
+
+  private:
+    LocalDatabase *m_db;
+    Mutex &m_mutex;
+    ham_u32_t m_partition;
+    ham_scan_visitor_t m_visitor;
+    void *m_context;
+    BtreeNodeProxy *m_node;
+    ham_u32_t m_slot;
+    bool m_stopped;
+    ByteArray m_arena;
+};
+
+void
+BtreeIndex::scan(ham_u32_t partitions, ham_scan_visitor_t visitor,
+                void *context)
+{
+  Mutex mutex;
+  std::vector<ScanVisitor *> scanners;
+  std::vector<BtreeVisitor *> visitors;
+
+  for (ham_u32_t i = 0; i < partitions; i++) {
+    scanners.push_back(new ScanVisitor(m_db, mutex, i, visitor, context));
+    visitors.push_back(scanners.back());
+  }
+
+  try {
+    enumerate_parallel(visitors, mutex);
+  }
+  catch (Exception &) {
+    for (ham_u32_t i = 0; i < partitions; i++)
+      delete scanners[i];
+    throw;
+  }
+
+  for (ham_u32_t i = 0; i < partitions; i++)
+    delete scanners[i];
+}
+
 } // namespace hamsterdb
 
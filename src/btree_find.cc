@@ -338,5 +338,46 @@ BtreeIndex::find(Transaction *txn, Cursor *cursor, ham_key_t *key,
   return (bfa.run());
 }
 
+bool
+BtreeIndex::find_separator(ham_key_t *key, bool right, ByteArray *arena,
+                ham_key_t *separator)
+{
+  LocalEnvironment *env = m_db->get_local_env();
+
+  if (!get_root_address())
+    return (false);
+
+  Page *page = env->get_page_manager()->fetch_page(m_db, get_root_address());
+  BtreeNodeProxy *node = get_node_from_page(page);
+
+  /* walk down to the lowest internal node; the separator of the deepest
+   * level is the closest one */
+  Page *sep_page = 0;
+  int sep_slot = -1;
+  while (!node->is_leaf()) {
+    ham_s32_t slot;
+    Page *child = find_internal(page, key, &slot);
+    if (right) {
+      if (slot + 1 < (int)node->get_count()) {
+        sep_page = page;
+        sep_slot = slot + 1;
+      }
+    }
+    else if (slot >= 0) {
+      sep_page = page;
+      sep_slot = slot;
+    }
+
+    page = child;
+    node = get_node_from_page(page);
+  }
+
+  if (!sep_page)
+    return (false);
+
+  get_node_from_page(sep_page)->get_key(sep_slot, arena, separator);
+  return (true);
+}
+
 } // namespace hamsterdb
 
@@ -59,6 +59,11 @@
  * If keys exceed a certain Threshold (get_extended_threshold()), they're moved
  * to a blob and the flag |kExtendedKey| is set for this key. These extended
  * keys are cached in a std::map to improve performance.
+ * The key data of an extended key is the 8 byte blob id, followed by
+ * the first bytes of the key (the "prefix", see
+ * BtreeIndex::get_extended_key_prefix_size()). Most comparisons are
+ * resolved with this prefix; the blob is only read if the prefix is
+ * identical.
  *
  * This layout supports duplicate keys. If the number of duplicate keys
  * exceeds a certain threshold (get_duplicate_threshold()), they are all moved
@@ -565,6 +570,13 @@ extern ham_u64_t g_extended_keys;
 // for counting extended duplicate tables
 extern ham_u64_t g_extended_duptables;
 
+// for counting comparisons with extended keys which were resolved with
+// the inline key prefix
+extern ham_u64_t g_extended_key_prefix_hits;
+
+// for counting comparisons with extended keys which required the full key
+extern ham_u64_t g_extended_key_prefix_misses;
+
 //
 // A RecordList for the default inline records, storing 8 byte record IDs
 // or inline records with size <= 8 bytes. If duplicates are supported then
@@ -1170,6 +1182,16 @@ class DefaultNodeImpl
           m_page->get_db()->get_local_env()->get_blob_manager()->read(
                           m_page->get_db(), blobid, &record, 0, &arena);
 
+          // compare it to the inline prefix
+          ham_u32_t prefix_size = get_extended_key_prefix_size(
+                          it->get_key_size());
+          if (record.size != it->get_key_size()
+              || memcmp(record.data, it->get_key_data() + sizeof(ham_u64_t),
+                      prefix_size)) {
+            ham_log(("Inline prefix differs from extended key"));
+            throw Exception(HAM_INTEGRITY_VIOLATED);
+          }
+
           // compare it to the cached key (if there is one)
           if (m_extkey_cache) {
             ExtKeyCache::iterator it = m_extkey_cache->find(blobid);
@@ -1194,6 +1216,27 @@ class DefaultNodeImpl
     template<typename Cmp>
     int compare(const ham_key_t *lhs, Iterator it, Cmp &cmp) {
       if (it->get_key_flags() & BtreeKey::kExtendedKey) {
+        // try to resolve the comparison with the inline prefix; this only
+        // works if the keys are compared byte-wise
+        ham_u32_t prefix_size = get_extended_key_prefix_size(
+                        it->get_key_size());
+        if (Cmp::kIsBytewise && prefix_size > 0) {
+          const ham_u8_t *prefix = it->get_key_data() + sizeof(ham_u64_t);
+          int m = ::memcmp(lhs->data, prefix, std::min((ham_u32_t)lhs->size,
+                                  prefix_size));
+          if (m != 0) {
+            g_extended_key_prefix_hits++;
+            return (m < 0 ? -1 : +1);
+          }
+          // |lhs| is a prefix of the (longer) extended key
+          if (lhs->size < prefix_size) {
+            g_extended_key_prefix_hits++;
+            return (-1);
+          }
+        }
+
+        // otherwise the full key is required
+        g_extended_key_prefix_misses++;
         ham_key_t tmp = {0};
         get_extended_key(it->get_extended_blob_id(), &tmp);
         return (cmp(lhs->data, lhs->size, tmp.data, tmp.size));
@@ -1736,8 +1779,9 @@ class DefaultNodeImpl
         erase_extended_key(it->get_extended_blob_id());
         // and transform into a key which is non-extended and occupies
         // the same space as before, when it was extended
+        ham_u32_t size = get_extended_key_data_size(it->get_key_size());
         it->set_key_flags(it->get_key_flags() & (~BtreeKey::kExtendedKey));
-        it->set_key_size(sizeof(ham_u64_t));
+        it->set_key_size(size);
       }
     }
 
@@ -1852,6 +1896,78 @@ class DefaultNodeImpl
 #endif
     }
 
+    // Moves the extended keys, records and duplicate tables which are
+    // stored at or above |threshold| to free space below |threshold|;
+    // returns the number of moved blobs
+    ham_u32_t relocate_blobs(ham_u64_t threshold) {
+      LocalDatabase *db = m_page->get_db();
+      BlobManager *bm = db->get_local_env()->get_blob_manager();
+      ham_u32_t moved = 0;
+
+      for (ham_u32_t slot = 0; slot < m_node->get_count(); slot++) {
+        Iterator it = at(slot);
+
+        if (it->get_key_flags() & BtreeKey::kExtendedKey) {
+          ham_u64_t blobid = it->get_extended_blob_id();
+          ham_u64_t newid = bm->relocate(db, blobid, threshold);
+          if (newid != blobid) {
+            it->set_extended_blob_id(newid);
+            moved++;
+          }
+        }
+
+        // internal nodes store page addresses instead of records
+        if (!m_node->is_leaf())
+          continue;
+
+        if (it->get_key_flags() & BtreeKey::kExtendedDuplicates) {
+          ham_u64_t tableid = it->get_record_id();
+          ByteArray table = get_duplicate_table(tableid);
+          ham_u32_t count = DuplicateTable::get_count(&table);
+          bool modified = false;
+          for (ham_u32_t i = 0; i < count; i++) {
+            if (m_records.table_is_record_inline(&table, i))
+              continue;
+            ham_u64_t ptr = m_records.table_get_record_id(&table, i);
+            ham_u64_t newptr = bm->relocate(db, ptr, threshold);
+            if (newptr != ptr) {
+              m_records.table_set_record_id(&table, i, newptr);
+              modified = true;
+              moved++;
+            }
+          }
+          if (modified)
+            tableid = flush_duplicate_table(tableid, &table);
+          ham_u64_t newid = bm->relocate(db, tableid, threshold);
+          if (newid != tableid)
+            moved++;
+          if (newid != it->get_record_id())
+            it->set_record_id(newid);
+          continue;
+        }
+
+        ham_u32_t record_count = it->get_inline_record_count();
+        for (ham_u32_t i = 0; i < record_count; i++) {
+          if (it->is_record_inline(i))
+            continue;
+          ham_u64_t ptr = it->get_record_id(i);
+          if (!ptr)
+            continue;
+          ham_u64_t newptr = bm->relocate(db, ptr, threshold);
+          if (newptr != ptr) {
+            it->set_record_id(newptr, i);
+            moved++;
+          }
+        }
+      }
+
+      // the cached extended keys and duplicate tables are indexed by their
+      // old blob ids
+      if (moved)
+        clear_caches();
+      return (moved);
+    }
+
     // Erases a key from the index. Does NOT erase the records!
     void erase(ham_u32_t slot) {
 #ifdef HAM_DEBUG
@@ -1902,8 +2018,10 @@ class DefaultNodeImpl
 
       // search the freelist for free key space
       int idx = freelist_find(count,
-                      (extended_key ? sizeof(ham_u64_t) : key->size)
-                            + get_total_inline_record_size());
+                      (extended_key
+                            ? get_extended_key_data_size(key->size)
+                            : key->size)
+                        + get_total_inline_record_size());
       // found: remove this freelist entry
       if (idx != -1) {
         offset = m_layout.get_key_data_offset(idx);
@@ -1912,7 +2030,9 @@ class DefaultNodeImpl
         // adjust the next key offset, if required
         if (get_next_offset() == offset + size)
           set_next_offset(offset
-                      + (extended_key ? sizeof(ham_u64_t) : key->size)
+                      + (extended_key
+                            ? get_extended_key_data_size(key->size)
+                            : key->size)
                       + get_total_inline_record_size());
       }
       // not found: append at the end
@@ -1935,14 +2055,18 @@ class DefaultNodeImpl
         }
 
         set_next_offset(offset
-                        + (extended_key ? sizeof(ham_u64_t) : key->size)
+                        + (extended_key
+                              ? get_extended_key_data_size(key->size)
+                              : key->size)
                         + get_total_inline_record_size());
       }
 
       // once more assert that the new key fits
       ham_assert(offset
               + m_layout.get_key_index_span() * get_capacity()
-              + (extended_key ? sizeof(ham_u64_t) : key->size)
+              + (extended_key
+                    ? get_extended_key_data_size(key->size)
+                    : key->size)
               + get_total_inline_record_size()
                   <= get_usable_page_size());
 
@@ -1963,7 +2087,7 @@ class DefaultNodeImpl
       if (extended_key) {
         ham_u64_t blobid = add_extended_key(key);
 
-        it->set_extended_blob_id(blobid);
+        set_extended_key(it, blobid, key->data, key->size);
         // remove all flags, set Extended flag
         it->set_key_flags(BtreeKey::kExtendedKey | BtreeKey::kInitialized);
         it->set_key_size(key->size);
@@ -1988,7 +2112,8 @@ class DefaultNodeImpl
       ham_key_t key = {0};
       ConstIterator it = src_node->at(src_slot);
       if (it->get_key_flags() & BtreeKey::kExtendedKey) {
-        get_extended_key(it->get_extended_blob_id(), &key);
+        // the blob belongs to |src_node|; use its cache, not ours
+        src_node->get_extended_key(it->get_extended_blob_id(), &key);
       }
       else {
         key.data = (void *)it->get_key_data();
@@ -2028,19 +2153,16 @@ class DefaultNodeImpl
       // copy the record ID, will be required later
       ham_u64_t rid = dest->get_record_id();
 
-      // copy the extended key, if there is one
+      // copy the extended key, if there is one; |src->data| points to the
+      // blob id, followed by the inline prefix
       if (src->_flags & BtreeKey::kExtendedKey) {
-        ham_u32_t next_offset = m_layout.get_key_data_offset(dest->get_slot())
-                                + get_total_key_data_size(dest->get_slot());
         ham_u64_t newblobid, oldblobid = *(ham_u64_t *)src->data;
         oldblobid = ham_db2h_offset(oldblobid);
         newblobid = copy_extended_key(oldblobid);
-        dest->set_extended_blob_id(newblobid);
+        allocate_extended_key(dest, src->size);
+        set_extended_key(dest, newblobid,
+                        (ham_u8_t *)src->data + sizeof(ham_u64_t), src->size);
         dest->set_key_flags(BtreeKey::kExtendedKey);
-
-        if (get_next_offset() == next_offset)
-            set_next_offset(m_layout.get_key_data_offset(dest->get_slot())
-                                + get_total_key_data_size(dest->get_slot()));
       }
       else {
         // check if the current key space is large enough; if not then move the
@@ -2050,12 +2172,12 @@ class DefaultNodeImpl
         //      capacity limit
         //  2. it's possible that the new key does not fit into the page.
         //      in this case we simply allocate an extended key, which
-        //      only requires 8 bytes
+        //      only requires 8 bytes (plus the inline prefix)
         if (dest->get_key_data_size() < src->size) {
-          // add this slot to the freelist
-          freelist_add(slot);
-          // and append the new key, if there's enough space available
+          // append the new key, if there's enough space available
           if (!requires_split(src)) {
+            // add this slot to the freelist
+            freelist_add(slot);
             ham_u32_t key_size = src->size;
             // internal nodes only have a record-id, no duplicates etc
             ham_u32_t rec_size = get_total_inline_record_size();
@@ -2066,7 +2188,8 @@ class DefaultNodeImpl
           // otherwise allocate and store an extended key
           else {
             ham_u64_t blobid = add_extended_key(src);
-            dest->set_extended_blob_id(blobid);
+            allocate_extended_key(dest, src->size);
+            set_extended_key(dest, blobid, src->data, src->size);
             dest->set_key_flags(BtreeKey::kExtendedKey);
           }
         }
@@ -2094,6 +2217,29 @@ class DefaultNodeImpl
 #endif
     }
 
+    // Makes sure that the space of the key at |dest| can store an
+    // extended key of |key_size| bytes (the blob id and the inline prefix).
+    // If not then the current space is moved to the freelist, and new space
+    // is allocated. Only called for internal nodes (from replace_key()).
+    void allocate_extended_key(Iterator dest, ham_u32_t key_size) {
+      ham_u32_t slot = dest->get_slot();
+      ham_u32_t required = get_extended_key_data_size(key_size)
+                            + get_total_inline_record_size();
+      ham_u32_t offset = m_layout.get_key_data_offset(slot);
+      ham_u32_t size = get_total_key_data_size(slot);
+
+      if (size >= required) {
+        // adjust next offset?
+        if (get_next_offset() == offset + size)
+          set_next_offset(offset + required);
+        return;
+      }
+
+      freelist_add(slot);
+      m_layout.set_key_data_offset(slot,
+                      allocate(m_node->get_count(), required, true));
+    }
+
     // Returns true if |key| cannot be inserted because a split is required
     // Rearranges the node if required
     bool requires_split(const ham_key_t *key) {
@@ -2312,6 +2458,8 @@ class DefaultNodeImpl
       ham_u32_t key_size = db->get_btree_index()->get_key_size();
 
       m_layout.initialize(m_node->get_data() + kPayloadOffset, key_size);
+      m_extkey_prefix_size =
+              db->get_btree_index()->get_extended_key_prefix_size();
 
       if (m_node->get_count() == 0 && !(db->get_rt_flags() & HAM_READ_ONLY)) {
         ham_u32_t rec_size = db->get_btree_index()->get_record_size();
@@ -2549,17 +2697,41 @@ class DefaultNodeImpl
     // Returns the size of the memory occupied by the key
     ham_u32_t get_key_data_size(ham_u32_t slot) const {
       if (m_layout.get_key_flags(slot) & BtreeKey::kExtendedKey)
-        return (sizeof(ham_u64_t));
+        return (get_extended_key_data_size(m_layout.get_key_size(slot)));
       return (m_layout.get_key_size(slot));
     }
 
+    // Returns the size of the inline prefix of an extended key
+    ham_u32_t get_extended_key_prefix_size(ham_u32_t key_size) const {
+      return (std::min(key_size, m_extkey_prefix_size));
+    }
+
+    // Returns the size of the memory occupied by an extended key: the
+    // blob id and the inline prefix
+    ham_u32_t get_extended_key_data_size(ham_u32_t key_size) const {
+      return (sizeof(ham_u64_t) + get_extended_key_prefix_size(key_size));
+    }
+
+    // Returns the size of the memory that a new key will occupy
+    ham_u32_t get_inline_key_data_size(ham_u32_t key_size) const {
+      if (key_size > get_extended_threshold())
+        return (get_extended_key_data_size(key_size));
+      return (key_size);
+    }
+
+    // Stores the blob id and the inline prefix of an extended key;
+    // |data| is the key data (or at least its prefix)
+    void set_extended_key(Iterator it, ham_u64_t blobid, const void *data,
+                    ham_u32_t key_size) {
+      it->set_extended_blob_id(blobid);
+      ham_u32_t prefix_size = get_extended_key_prefix_size(key_size);
+      if (prefix_size)
+        memcpy(it->get_key_data() + sizeof(ham_u64_t), data, prefix_size);
+    }
+
     // Returns the total size of the key  - key data + record(s)
     ham_u32_t get_total_key_data_size(ham_u32_t slot) const {
-      ham_u32_t size;
-      if (m_layout.get_key_flags(slot) & BtreeKey::kExtendedKey)
-        size = sizeof(ham_u64_t);
-      else
-        size = m_layout.get_key_size(slot);
+      ham_u32_t size = get_key_data_size(slot);
       if (m_layout.get_key_flags(slot) & BtreeKey::kExtendedDuplicates)
         return (size + kExtendedDuplicatesSize);
       else
@@ -2861,9 +3033,7 @@ class DefaultNodeImpl
         // the absolute offset of the new key (including length and record)
         ham_u32_t capacity = get_capacity();
         ham_u32_t offset = get_next_offset();
-        offset += (key->size > get_extended_threshold()
-                        ? sizeof(ham_u64_t)
-                        : key->size)
+        offset += get_inline_key_data_size(key->size)
                 + get_total_inline_record_size();
         offset += m_layout.get_key_index_span() * (capacity + 1);
 
@@ -2936,9 +3106,7 @@ class DefaultNodeImpl
 
       ham_u32_t offset = get_next_offset();
       if (use_extended)
-        offset += key->size > get_extended_threshold()
-                      ? sizeof(ham_u64_t)
-                      : key->size;
+        offset += get_inline_key_data_size(key->size);
       else
         offset += key->size;
       // need at least 8 byte for the record, in case we need to store a
@@ -3076,6 +3244,9 @@ class DefaultNodeImpl
 
     // Cache for external duplicate tables
     DupTableCache *m_duptable_cache;
+
+    // The size of the inline prefix of extended keys
+    ham_u32_t m_extkey_prefix_size;
 };
 
 } // namespace hamsterdb
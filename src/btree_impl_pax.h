@@ -873,6 +873,33 @@ class PaxNodeImpl
       it->set_record_id(0);
     }
 
+    // Moves the records which are stored at or above |threshold| to free
+    // space below |threshold|; returns the number of moved blobs
+    ham_u32_t relocate_blobs(ham_u64_t threshold) {
+      // internal nodes store page addresses instead of records
+      if (!m_node->is_leaf())
+        return (0);
+
+      LocalDatabase *db = m_page->get_db();
+      BlobManager *bm = db->get_local_env()->get_blob_manager();
+      ham_u32_t moved = 0;
+
+      for (ham_u32_t slot = 0; slot < m_node->get_count(); slot++) {
+        Iterator it = at(slot);
+        if (it->is_record_inline())
+          continue;
+        ham_u64_t ptr = it->get_record_id();
+        if (!ptr)
+          continue;
+        ham_u64_t newptr = bm->relocate(db, ptr, threshold);
+        if (newptr != ptr) {
+          it->set_record_id(newptr);
+          moved++;
+        }
+      }
+      return (moved);
+    }
+
     // Erases a key
     void erase(ham_u32_t slot) {
       ham_u32_t count = m_node->get_count();
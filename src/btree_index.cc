@@ -34,11 +34,13 @@ ham_u32_t g_extended_threshold = 0;
 ham_u32_t g_duplicate_threshold = 0;
 ham_u64_t g_extended_keys = 0;
 ham_u64_t g_extended_duptables = 0;
+ham_u64_t g_extended_key_prefix_hits = 0;
+ham_u64_t g_extended_key_prefix_misses = 0;
 
 BtreeIndex::BtreeIndex(LocalDatabase *db, ham_u32_t descriptor, ham_u32_t flags,
                 ham_u32_t key_type, ham_u32_t key_size)
-  : m_db(db), m_key_size(0), m_key_type(key_type),
-    m_descriptor_index(descriptor), m_flags(flags), m_root_address(0)
+  : m_db(db), m_key_size(0), m_key_type(key_type), m_rec_size(0),
+    m_extkey_prefix_size(0), m_descriptor_index(descriptor), m_flags(flags), m_root_address(0)
 {
   m_leaf_traits = BtreeIndexFactory::create(db, flags, key_type,
                   key_size, true);
@@ -65,6 +67,12 @@ BtreeIndex::create(ham_u16_t key_type, ham_u32_t key_size, ham_u32_t rec_size)
   m_rec_size = rec_size;
   m_root_address = root->get_address();
 
+  // the inline prefix of extended keys is only used for binary keys, which
+  // are compared byte-wise
+  if (key_type == HAM_TYPE_BINARY
+      && !(m_db->get_rt_flags() & HAM_RECORD_NUMBER))
+    m_extkey_prefix_size = kExtendedKeyPrefixSize;
+
   flush_descriptor();
 }
 
@@ -92,6 +100,7 @@ BtreeIndex::open()
   m_key_type = key_type;
   m_flags = flags;
   m_rec_size = rec_size;
+  m_extkey_prefix_size = desc->get_extended_key_prefix_size();
 }
 
 void
@@ -110,6 +119,7 @@ BtreeIndex::flush_descriptor()
   desc->set_key_type(get_key_type());
   desc->set_root_address(get_root_address());
   desc->set_flags(get_flags());
+  desc->set_extended_key_prefix_size(get_extended_key_prefix_size());
 
   env->mark_header_page_dirty();
 }
@@ -13,12 +13,14 @@
 #define HAM_BTREE_INDEX_H__
 
 #include <algorithm>
+#include <vector>
 
 #include "endianswap.h"
 
 #include "db.h"
 #include "abi.h"
 #include "util.h"
+#include "mutex.h"
 #include "btree_cursor.h"
 #include "btree_stats.h"
 #include "btree_node.h"
@@ -35,6 +37,13 @@ extern ham_u64_t g_extended_keys;
 // for counting extended duplicate tables
 extern ham_u64_t g_extended_duptables;
 
+// for counting comparisons with extended keys which were resolved with
+// the inline key prefix
+extern ham_u64_t g_extended_key_prefix_hits;
+
+// for counting comparisons with extended keys which required the full key
+extern ham_u64_t g_extended_key_prefix_misses;
+
 //
 // The persistent btree index descriptor. This structure manages the
 // persistent btree metadata.
@@ -106,6 +115,16 @@ HAM_PACK_0 class HAM_PACK_1 PBtreeHeader
       m_flags = ham_h2db32(n);
     }
 
+    // Returns the size of the inline prefix of extended keys
+    ham_u16_t get_extended_key_prefix_size() const {
+      return (ham_db2h16(m_extkey_prefix_size));
+    }
+
+    // Sets the size of the inline prefix of extended keys
+    void set_extended_key_prefix_size(ham_u16_t n) {
+      m_extkey_prefix_size = ham_h2db16(n);
+    }
+
   private:
     // address of the root-page
     ham_u64_t m_root_address;
@@ -122,8 +141,9 @@ HAM_PACK_0 class HAM_PACK_1 PBtreeHeader
     // key type
     ham_u16_t m_key_type;
 
-    // reserved for padding
-    ham_u16_t m_padding1;
+    // size of the inline prefix of extended keys; files created by
+    // older versions store 0 (= no prefix)
+    ham_u16_t m_extkey_prefix_size;
 
     // the record size
     ham_u32_t m_rec_size;
@@ -180,7 +200,10 @@ class BtreeIndex
       kLeafPage = 1,
 
       // for get_node_from_page(): Page is an internal node
-      kInternalPage = 2
+      kInternalPage = 2,
+
+      // the size of the inline prefix of extended keys (binary keys only)
+      kExtendedKeyPrefixSize = 16
     };
 
     // Constructor; creates and initializes a new btree
@@ -214,6 +237,12 @@ class BtreeIndex
       return (m_rec_size);
     }
 
+    // Returns the size of the inline prefix of extended keys (or 0 if
+    // extended keys are stored without prefix)
+    ham_u16_t get_extended_key_prefix_size() const {
+      return (m_extkey_prefix_size);
+    }
+
     // Returns the internal key type
     ham_u16_t get_key_type() const {
       return (m_key_type);
@@ -248,6 +277,16 @@ class BtreeIndex
     ham_status_t find(Transaction *txn, Cursor *cursor,
             ham_key_t *key, ham_record_t *record, ham_u32_t flags);
 
+    // Returns the separator key which bounds the leaf storing |key| - the
+    // smallest key of the internal nodes which is greater than |key| (if
+    // |right| is true; all keys in the leafs to the right are >= this key),
+    // or the greatest key which is <= |key| (if |right| is false; all keys
+    // in the leafs to the left are < this key).
+    // Only internal nodes are fetched. Returns false if |key| is stored in
+    // the rightmost (or leftmost) leaf.
+    bool find_separator(ham_key_t *key, bool right, ByteArray *arena,
+            ham_key_t *separator);
+
     // Inserts (or updates) a key/record in the index (ham_db_insert)
     ham_status_t insert(Transaction *txn, Cursor *cursor, ham_key_t *key,
             ham_record_t *record, ham_u32_t flags);
@@ -262,12 +301,32 @@ class BtreeIndex
     void enumerate(BtreeVisitor &visitor,
                     bool visit_internal_nodes = false);
 
+    // Iterates over all leaf nodes of the index; the key space is split
+    // at internal node boundaries into |visitors.size()| partitions of
+    // disjoint key ranges, and each partition is enumerated by its own
+    // thread with its own visitor. |mutex| serializes all accesses to the
+    // PageManager; visitors which fetch pages (i.e. to resolve extended
+    // keys) have to acquire it as well.
+    // The caller must make sure that the tree is not modified.
+    void enumerate_parallel(std::vector<BtreeVisitor *> &visitors,
+                    Mutex &mutex);
+
+    // Scans all keys with |partitions| threads and calls the user's
+    // |visitor| callback for each key (ham_db_scan)
+    void scan(ham_u32_t partitions, ham_scan_visitor_t visitor,
+                    void *context);
+
     // Checks the integrity of the btree (ham_db_check_integrity)
     void check_integrity();
 
     // Counts the keys in the btree (ham_db_get_key_count)
     ham_u64_t get_key_count(ham_u32_t flags);
 
+    // Moves all pages and blobs of this btree which are stored at or above
+    // |threshold| to free space below |threshold| (ham_env_compact).
+    // Returns the number of moved pages and blobs
+    ham_u32_t compact(ham_u64_t threshold);
+
     // Erases all records, overflow areas, extended keys etc from the index;
     // used to avoid memory leaks when closing in-memory Databases and to
     // clean up when deleting on-disk Databases.
@@ -304,6 +363,8 @@ class BtreeIndex
       metrics->btree_smo_shift = ms_btree_smo_shift;
       metrics->extended_keys = g_extended_keys;
       metrics->extended_duptables = g_extended_duptables;
+      metrics->extended_key_prefix_hits = g_extended_key_prefix_hits;
+      metrics->extended_key_prefix_misses = g_extended_key_prefix_misses;
     }
 
     // Returns the class name (for testing)
@@ -313,6 +374,7 @@ class BtreeIndex
 
   private:
     friend class BtreeCheckAction;
+    friend class BtreeCompactAction;
     friend class BtreeEnumAction;
     friend class BtreeEraseAction;
     friend class BtreeFindAction;
@@ -385,6 +447,9 @@ class BtreeIndex
     // the record size (or 0 if none was specified)
     ham_u32_t m_rec_size;
 
+    // the size of the inline prefix of extended keys
+    ham_u16_t m_extkey_prefix_size;
+
     // the index of the PBtreeHeader in the Environment's header page
     ham_u32_t m_descriptor_index;
 
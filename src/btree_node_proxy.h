@@ -195,6 +195,11 @@ class BtreeNodeProxy
     // or an In-Memory Database is freed
     virtual void remove_all_entries() = 0;
 
+    // Moves the blobs (extended keys, records, duplicate tables) which are
+    // stored at or above |threshold| to free space below |threshold|.
+    // Returns the number of moved blobs; used by ham_env_compact
+    virtual ham_u32_t relocate_blobs(ham_u64_t threshold) = 0;
+
     // Replaces the |dest|-key with the key in |slot|
     // Note that |dest| MUST be an internal node! This is used to update
     // anchor nodes during erase SMOs.
@@ -264,6 +269,9 @@ class BtreeNodeProxy
 //
 struct CallbackCompare
 {
+  // keys are not compared byte-wise
+  enum { kIsBytewise = 0 };
+
   CallbackCompare(LocalDatabase *db)
     : m_db(db) {
   }
@@ -282,6 +290,9 @@ struct CallbackCompare
 //
 struct RecordNumberCompare
 {
+  // keys are not compared byte-wise
+  enum { kIsBytewise = 0 };
+
   RecordNumberCompare(LocalDatabase *) {
   }
 
@@ -303,6 +314,9 @@ struct RecordNumberCompare
 template<typename T>
 struct NumericCompare
 {
+  // keys are not compared byte-wise
+  enum { kIsBytewise = 0 };
+
   NumericCompare(LocalDatabase *) {
   }
 
@@ -322,6 +336,9 @@ struct NumericCompare
 //
 struct FixedSizeCompare
 {
+  // keys are compared byte-wise (see DefaultNodeImpl::compare)
+  enum { kIsBytewise = 1 };
+
   FixedSizeCompare(LocalDatabase *) {
   }
 
@@ -339,6 +356,9 @@ struct FixedSizeCompare
 //
 struct VariableSizeCompare
 {
+  // keys are compared byte-wise (see DefaultNodeImpl::compare)
+  enum { kIsBytewise = 1 };
+
   VariableSizeCompare(LocalDatabase *) {
   }
 
@@ -452,10 +472,9 @@ class BtreeNodeProxyImpl : public BtreeNodeProxy
     // and respects HAM_KEY_USER_ALLOC in dest->flags. Record number keys
     // are endian-translated.
     virtual void get_key(ham_u32_t slot, ByteArray *arena, ham_key_t *dest) {
-      if (dest->flags & HAM_KEY_USER_ALLOC) {
-        arena->assign(dest->data, dest->size);
-        arena->disown();
-      }
+      // HAM_KEY_USER_ALLOC is handled by the implementation; the |arena|
+      // must not be re-pointed to the user's buffer, otherwise subsequent
+      // (internal) key copies would overwrite the user's memory
       m_impl.get_key(slot, arena, dest);
     }
 
@@ -548,6 +567,11 @@ class BtreeNodeProxyImpl : public BtreeNodeProxy
       }
     }
 
+    // Moves the blobs which are stored at or above |threshold|
+    virtual ham_u32_t relocate_blobs(ham_u64_t threshold) {
+      return (m_impl.relocate_blobs(threshold));
+    }
+
     // Replaces the |dest|-key with the key in |slot|
     // Note that |dest| MUST be an internal node!
     virtual void replace_key(ham_u32_t slot, BtreeNodeProxy *dest_node,
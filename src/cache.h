@@ -239,6 +239,26 @@ class Cache
       }
     }
 
+    /** appends all dirty pages to |pages| */
+    void get_dirty_pages(std::vector<Page *> *pages) const {
+      for (Page *p = m_totallist; p; p = p->get_next(Page::kListCache)) {
+        if (p->is_dirty())
+          pages->push_back(p);
+      }
+    }
+
+    /** returns true if the page is cached; does not update the
+     * statistics or the LRU order */
+    bool contains(ham_u64_t address) const {
+      Page *page = m_buckets[calc_hash(address)];
+      while (page) {
+        if (page->get_address() == address)
+          return (true);
+        page = page->get_next(Page::kListBucket);
+      }
+      return (false);
+    }
+
     /** returns true if the caller should purge the cache */
     bool is_too_big() const {
       return (m_alloc_elements * m_env->get_page_size() > m_capacity);
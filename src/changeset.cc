@@ -9,6 +9,8 @@
  * See files COPYING.* for License information.
  */
 
+#include <vector>
+
 #include "page.h"
 #include "changeset.h"
 #include "env.h"
@@ -188,13 +190,18 @@ Changeset::flush(ham_u64_t lsn)
     g_CHANGESET_POST_LOG_HOOK();
 
   /* now write all the pages to the file; if any of these writes fail,
-   * we can still recover from the log */
+   * we can still recover from the log. The pages are written in one
+   * batch, which allows the Device to submit them in parallel */
+  std::vector<Page *> pages;
   while (p) {
-    m_env->get_page_manager()->flush_page(p);
+    pages.push_back(p);
     p = p->get_next(Page::kListChangeset);
 
     INDUCE(ErrorInducer::kChangesetFlush);
   }
+  if (!pages.empty())
+    m_env->get_page_manager()->flush_pages(&pages[0],
+                    (ham_u32_t)pages.size());
 
   /* flush the file handle (if required) */
   if (m_env->get_flags() & HAM_ENABLE_FSYNC)
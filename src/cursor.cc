@@ -28,7 +28,8 @@ using namespace hamsterdb;
 Cursor::Cursor(LocalDatabase *db, Transaction *txn, ham_u32_t flags)
   : m_db(db), m_txn(txn), m_txn_cursor(this), m_btree_cursor(this),
     m_remote_handle(0), m_next(0), m_previous(0), m_dupecache_index(0),
-    m_lastop(0), m_last_cmp(0), m_flags(flags), m_is_first_use(true)
+    m_lastop(0), m_last_cmp(0), m_flags(flags), m_is_first_use(true),
+    m_filter(0)
 {
 }
 
@@ -44,6 +45,9 @@ Cursor::Cursor(Cursor &other)
   m_last_cmp = other.m_last_cmp;
   m_flags = other.m_flags;
   m_is_first_use = other.m_is_first_use;
+  m_filter = other.m_filter
+          ? new CursorFilter(other.m_filter->get_filter())
+          : 0;
 
   m_btree_cursor.clone(other.get_btree_cursor());
   m_txn_cursor.clone(other.get_txn_cursor());
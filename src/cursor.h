@@ -75,6 +75,7 @@
 #include <vector>
 
 #include "error.h"
+#include "cursor_filter.h"
 #include "txn_cursor.h"
 #include "btree_cursor.h"
 #include "blob_manager.h"
@@ -247,6 +248,7 @@ class Cursor
     // Destructor; sets cursor to nil
     ~Cursor() {
       set_to_nil();
+      delete m_filter;
     }
 
     // Returns the Database
@@ -445,6 +447,28 @@ class Cursor
       m_is_first_use = false;
     }
 
+    // Returns the memory buffer for the keys of ham_cursor_get_batch
+    ByteArray &get_batch_key_arena() {
+      return (m_batch_key_arena);
+    }
+
+    // Returns the memory buffer for the records of ham_cursor_get_batch
+    ByteArray &get_batch_record_arena() {
+      return (m_batch_record_arena);
+    }
+
+    // Returns the filter for cursor scans, or null (ham_cursor_set_filter)
+    CursorFilter *get_filter() {
+      return (m_filter);
+    }
+
+    // Installs a filter for cursor scans; the Cursor takes ownership of
+    // the |filter|. A previously installed filter is deleted.
+    void set_filter(CursorFilter *filter) {
+      delete m_filter;
+      m_filter = filter;
+    }
+
   private:
     // Checks if a btree cursor points to a key that was overwritten or erased
     // in the txn-cursor
@@ -537,6 +561,15 @@ class Cursor
 
     // true if this cursor was never used
     bool m_is_first_use;
+
+    // Stores the key data returned by ham_cursor_get_batch
+    ByteArray m_batch_key_arena;
+
+    // Stores the record data returned by ham_cursor_get_batch
+    ByteArray m_batch_record_arena;
+
+    // The filter for cursor scans; can be null
+    CursorFilter *m_filter;
 };
 
 } // namespace hamsterdb
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2005-2013 Christoph Rupp (chris@crupp.de).
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * See files COPYING.* for License information.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <algorithm>
+
+#include "btree_index.h"
+#include "cursor_filter.h"
+#include "db_local.h"
+
+#undef min  // avoid MSVC conflicts with std::min
+#undef max  // avoid MSVC conflicts with std::max
+
+namespace hamsterdb {
+
+CursorFilter::CursorFilter(const ham_cursor_filter_t *filter)
+{
+  m_filter = *filter;
+  m_filter.lower_bound = copy_key(filter->lower_bound, &m_lower_bound,
+                  &m_lower_bound_arena);
+  m_filter.upper_bound = copy_key(filter->upper_bound, &m_upper_bound,
+                  &m_upper_bound_arena);
+  m_filter.prefix = copy_key(filter->prefix, &m_prefix, &m_prefix_arena);
+}
+
+ham_key_t *
+CursorFilter::copy_key(const ham_key_t *source, ham_key_t *storage,
+                ByteArray *arena)
+{
+  if (!source)
+    return (0);
+
+  memset(storage, 0, sizeof(*storage));
+  storage->size = source->size;
+  if (source->size) {
+    arena->copy(source->data, source->size);
+    storage->data = arena->get_ptr();
+  }
+  return (storage);
+}
+
+int
+CursorFilter::evaluate_key(LocalDatabase *db, ham_key_t *key,
+                bool forward) const
+{
+  BtreeIndex *btree = db->get_btree_index();
+
+  if (m_filter.lower_bound
+      && btree->compare_keys(key, m_filter.lower_bound) < 0)
+    return (forward ? kSkip : kStop);
+
+  if (m_filter.upper_bound
+      && btree->compare_keys(key, m_filter.upper_bound) > 0)
+    return (forward ? kStop : kSkip);
+
+  if (m_filter.prefix) {
+    const ham_key_t *prefix = m_filter.prefix;
+    ham_u32_t size = std::min(key->size, prefix->size);
+    int cmp = size ? memcmp(key->data, prefix->data, size) : 0;
+
+    if (cmp == 0 && key->size >= prefix->size)
+      return (kMatch);
+
+    // binary keys are sorted byte-wise; therefore all keys with the same
+    // prefix are stored next to each other, and the scan can stop as
+    // soon as it leaves them. Other key types are just skipped.
+    if (db->get_key_type() != HAM_TYPE_BINARY)
+      return (kSkip);
+    if (cmp < 0 || (cmp == 0 && key->size < prefix->size))
+      return (forward ? kSkip : kStop);
+    return (forward ? kStop : kSkip);
+  }
+
+  return (kMatch);
+}
+
+bool
+CursorFilter::evaluate_record(const ham_key_t *key,
+                ham_u64_t record_size) const
+{
+  if (record_size < m_filter.min_record_size)
+    return (false);
+  if (m_filter.max_record_size && record_size > m_filter.max_record_size)
+    return (false);
+  if (m_filter.predicate)
+    return (m_filter.predicate(m_filter.predicate_context, key,
+                            record_size) != 0);
+  return (true);
+}
+
+bool
+CursorFilter::get_seek_key(LocalDatabase *db, bool forward, ham_key_t *key,
+                ham_u32_t *flags)
+{
+  const ham_key_t *prefix = m_filter.prefix;
+
+  // prefixes can only be searched if the keys are sorted byte-wise
+  if (db->get_key_type() != HAM_TYPE_BINARY)
+    prefix = 0;
+
+  if (forward) {
+    *flags = HAM_FIND_GEQ_MATCH;
+    if (prefix && make_seek_key(db, prefix->data, prefix->size, false,
+                            &m_seek_arena, key)) {
+      // start at the lower bound if it's greater than the prefix
+      if (m_filter.lower_bound
+          && db->get_btree_index()->compare_keys(m_filter.lower_bound,
+                  key) > 0)
+        *key = *m_filter.lower_bound;
+      return (true);
+    }
+    if (m_filter.lower_bound) {
+      *key = *m_filter.lower_bound;
+      return (true);
+    }
+    return (false);
+  }
+
+  // the end of the range: the first key which is greater than the
+  // upper bound, or the first key which no longer has the prefix
+  if (prefix && make_seek_key(db, prefix->data, prefix->size, true,
+                          &m_seek_arena, key)) {
+    *flags = HAM_FIND_GEQ_MATCH;
+    if (m_filter.upper_bound
+        && db->get_btree_index()->compare_keys(m_filter.upper_bound,
+                key) < 0) {
+      *key = *m_filter.upper_bound;
+      *flags = HAM_FIND_GT_MATCH;
+    }
+    return (true);
+  }
+  if (m_filter.upper_bound) {
+    *key = *m_filter.upper_bound;
+    *flags = HAM_FIND_GT_MATCH;
+    return (true);
+  }
+  return (false);
+}
+
+bool
+CursorFilter::make_seek_key(LocalDatabase *db, const void *data,
+                ham_u32_t size, bool successor, ByteArray *arena,
+                ham_key_t *key)
+{
+  ham_u32_t key_size = db->get_key_size();
+  if (key_size != HAM_KEY_SIZE_UNLIMITED && size > key_size)
+    size = key_size;
+
+  arena->resize(key_size == HAM_KEY_SIZE_UNLIMITED
+                  ? std::max(size, 1u)
+                  : std::max(key_size, 1u));
+  ham_u8_t *p = (ham_u8_t *)arena->get_ptr();
+  if (size)
+    memcpy(p, data, size);
+
+  if (successor) {
+    // strip all trailing 0xff bytes, then increment the last byte
+    while (size > 0 && p[size - 1] == 0xff)
+      size--;
+    if (size == 0)
+      return (false);
+    p[size - 1]++;
+  }
+
+  memset(key, 0, sizeof(*key));
+  key->data = p;
+  key->size = size;
+  if (key_size != HAM_KEY_SIZE_UNLIMITED) {
+    memset(p + size, 0, key_size - size);
+    key->size = key_size;
+  }
+  return (true);
+}
+
+} // namespace hamsterdb
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2005-2013 Christoph Rupp (chris@crupp.de).
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * See files COPYING.* for License information.
+ */
+
+/**
+ * @brief A filter for cursor scans (ham_cursor_set_filter)
+ *
+ */
+
+#ifndef HAM_CURSOR_FILTER_H__
+#define HAM_CURSOR_FILTER_H__
+
+#include "ham/hamsterdb.h"
+
+#include "util.h"
+
+namespace hamsterdb {
+
+class LocalDatabase;
+
+//
+// The CursorFilter stores a deep copy of a ham_cursor_filter_t structure
+// and evaluates it. It is attached to a Cursor, and evaluated by
+// LocalDatabase::cursor_move() before the key and the record are copied
+// to the caller.
+//
+class CursorFilter
+{
+  public:
+    enum {
+      // the current key matches the filter
+      kMatch = 0,
+
+      // the current key does not match, but one of the next keys might
+      kSkip,
+
+      // neither the current key nor any of the next keys (in the
+      // direction of the scan) can match
+      kStop
+    };
+
+    // Constructor; creates deep copies of the keys in |filter|
+    CursorFilter(const ham_cursor_filter_t *filter);
+
+    // Returns the filter; all keys point to the internal copies
+    const ham_cursor_filter_t *get_filter() const {
+      return (&m_filter);
+    }
+
+    // Returns true if the record size is required to evaluate the
+    // filter (see |evaluate_record|)
+    bool requires_record_size() const {
+      return (m_filter.min_record_size > 0
+              || m_filter.max_record_size > 0
+              || m_filter.predicate != 0);
+    }
+
+    // Evaluates the key range and the prefix. |forward| is true if the
+    // cursor moves towards larger keys. Returns |kMatch|, |kSkip| or
+    // |kStop|.
+    int evaluate_key(LocalDatabase *db, ham_key_t *key, bool forward) const;
+
+    // Evaluates the record size bounds and the predicate
+    bool evaluate_record(const ham_key_t *key, ham_u64_t record_size) const;
+
+    // Calculates a key for positioning the cursor with a single lookup
+    // instead of walking from the first (or last) key of the database.
+    // If |forward| is true then |key| is the first candidate and is
+    // searched with |*flags| (HAM_FIND_GEQ_MATCH). Otherwise the cursor
+    // has to be positioned with |*flags| on the first key *behind* the
+    // range, and then moved backwards.
+    // Returns false if the filter does not restrict this end of the range.
+    bool get_seek_key(LocalDatabase *db, bool forward, ham_key_t *key,
+                    ham_u32_t *flags);
+
+    // Creates a key from the first |size| bytes of |data| and stores it
+    // in |key| and |arena|. If |successor| is true then the key is
+    // incremented to the smallest byte string that is greater than all
+    // strings starting with these bytes. Fixed length keys are padded
+    // with zeroes.
+    // Returns false if there is no such successor (all bytes are 0xff).
+    static bool make_seek_key(LocalDatabase *db, const void *data,
+                    ham_u32_t size, bool successor, ByteArray *arena,
+                    ham_key_t *key);
+
+  private:
+    // Copies |source| to |storage| and |arena|, and returns |storage|
+    // (or null if |source| is null)
+    static ham_key_t *copy_key(const ham_key_t *source, ham_key_t *storage,
+                    ByteArray *arena);
+
+    // The filter; its keys point to the members below
+    ham_cursor_filter_t m_filter;
+
+    // The copies of the lower bound, upper bound and the prefix
+    ham_key_t m_lower_bound;
+    ham_key_t m_upper_bound;
+    ham_key_t m_prefix;
+
+    // The arenas for the key data
+    ByteArray m_lower_bound_arena;
+    ByteArray m_upper_bound_arena;
+    ByteArray m_prefix_arena;
+
+    // The arena for get_seek_key()
+    ByteArray m_seek_arena;
+};
+
+} // namespace hamsterdb
+
+#endif /* HAM_CURSOR_FILTER_H__ */
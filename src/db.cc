@@ -12,6 +12,9 @@
 
 #include "config.h"
 
+#include <string.h>
+#include <algorithm>
+
 #include "db.h"
 #include "cursor.h"
 
@@ -90,6 +93,120 @@ Database::cursor_close(Cursor *cursor)
   delete cursor;
 }
 
+ham_status_t
+Database::cursor_get_batch(Cursor *cursor, ham_key_t *keys,
+        ham_record_t *records, ham_u32_t *count, ham_u32_t flags)
+{
+  ham_status_t st = 0;
+  ham_u32_t max = *count;
+  ham_u32_t i;
+
+  cursor->get_batch_key_arena().set_size(0);
+  cursor->get_batch_record_arena().set_size(0);
+
+  for (i = 0; i < max; i++) {
+    ham_key_t *key = keys ? &keys[i] : 0;
+    ham_record_t *record = records ? &records[i] : 0;
+
+    st = cursor_move(cursor, key, record,
+                    i == 0 ? flags : get_batch_continue_flags(flags));
+    if (st)
+      break;
+    append_to_batch(cursor, key, record, flags);
+  }
+
+  finalize_batch(cursor, keys, records, i, flags);
+  *count = i;
+
+  // reaching the end of the database is not an error if at least one
+  // item was retrieved
+  if (st == HAM_KEY_NOT_FOUND && i > 0)
+    return (0);
+  return (st);
+}
+
+ham_status_t
+Database::cursor_skip_prefix(Cursor *cursor, ham_u32_t prefix_size,
+        ham_key_t *key, ham_record_t *record, ham_u32_t flags)
+{
+  ham_u32_t direction = (flags & HAM_CURSOR_PREVIOUS)
+                ? HAM_CURSOR_PREVIOUS
+                : HAM_CURSOR_NEXT;
+
+  // fetch the current key and make a copy of its prefix
+  ham_key_t current = {0};
+  ham_status_t st = cursor_move(cursor, &current, 0, 0);
+  if (st)
+    return (st);
+
+  ByteArray arena;
+  ham_key_t prefix = {0};
+  prefix.size = std::min(prefix_size, (ham_u32_t)current.size);
+  if (prefix.size) {
+    arena.copy(current.data, prefix.size);
+    prefix.data = arena.get_ptr();
+  }
+
+  // then move till the prefix changes
+  while (true) {
+    ham_key_t tmp = {0};
+    st = cursor_move(cursor, &tmp, 0, direction);
+    if (st)
+      return (st);
+    if (!has_same_prefix(&tmp, &prefix, prefix_size))
+      break;
+  }
+
+  return (cursor_move(cursor, key, record, flags & HAM_DIRECT_ACCESS));
+}
+
+bool
+Database::has_same_prefix(const ham_key_t *key, const ham_key_t *prefix,
+        ham_u32_t prefix_size)
+{
+  if (key->size < prefix->size)
+    return (false);
+  if (prefix->size < prefix_size && key->size != prefix->size)
+    return (false);
+  return (prefix->size == 0
+          || ::memcmp(key->data, prefix->data, prefix->size) == 0);
+}
+
+void
+Database::append_to_batch(Cursor *cursor, ham_key_t *key,
+        ham_record_t *record, ham_u32_t flags)
+{
+  if (key && key->size && !(key->flags & HAM_KEY_USER_ALLOC))
+    cursor->get_batch_key_arena().append(key->data, key->size);
+
+  // with HAM_DIRECT_ACCESS, record->data already points to the record
+  // that is stored in the database and is not copied
+  if (record && record->size
+      && !(record->flags & HAM_RECORD_USER_ALLOC)
+      && !(flags & HAM_DIRECT_ACCESS))
+    cursor->get_batch_record_arena().append(record->data, record->size);
+}
+
+void
+Database::finalize_batch(Cursor *cursor, ham_key_t *keys,
+        ham_record_t *records, ham_u32_t count, ham_u32_t flags)
+{
+  ham_u8_t *kp = (ham_u8_t *)cursor->get_batch_key_arena().get_ptr();
+  ham_u8_t *rp = (ham_u8_t *)cursor->get_batch_record_arena().get_ptr();
+
+  for (ham_u32_t i = 0; i < count; i++) {
+    if (keys && !(keys[i].flags & HAM_KEY_USER_ALLOC)) {
+      keys[i].data = keys[i].size ? kp : 0;
+      kp += keys[i].size;
+    }
+    if (records && !(records[i].flags & HAM_RECORD_USER_ALLOC)
+        && !(flags & HAM_DIRECT_ACCESS)) {
+      records[i].data = records[i].size ? rp : 0;
+      rp += records[i].size;
+    }
+  }
+}
+
 ham_status_t
 Database::close(ham_u32_t flags)
 {
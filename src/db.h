@@ -90,6 +90,11 @@ class Database
     virtual ham_status_t get_key_count(Transaction *txn, ham_u32_t flags,
                     ham_u64_t *keycount) = 0;
 
+    // Scans all keys in parallel partitions (ham_db_scan)
+    virtual ham_status_t scan(ham_u32_t partitions,
+                    ham_scan_visitor_t visitor, void *context,
+                    ham_u32_t flags) = 0;
+
     // Inserts a key/value pair (ham_db_insert)
     virtual ham_status_t insert(Transaction *txn, ham_key_t *key,
                     ham_record_t *record, ham_u32_t flags) = 0;
@@ -127,6 +132,10 @@ class Database
     virtual ham_status_t cursor_get_record_size(Cursor *cursor,
                     ham_u64_t *size) = 0;
 
+    // Installs a filter for cursor scans (ham_cursor_set_filter)
+    virtual ham_status_t cursor_set_filter(Cursor *cursor,
+                    const ham_cursor_filter_t *filter) = 0;
+
     // Overwrites the record of a cursor (ham_cursor_overwrite)
     virtual ham_status_t cursor_overwrite(Cursor *cursor,
                     ham_record_t *record, ham_u32_t flags) = 0;
@@ -135,6 +144,19 @@ class Database
     virtual ham_status_t cursor_move(Cursor *cursor,
                     ham_key_t *key, ham_record_t *record, ham_u32_t flags) = 0;
 
+    // Moves a cursor over several keys and returns up to |*count|
+    // key/record pairs (ham_cursor_get_batch). The default implementation
+    // calls cursor_move() for every single item.
+    virtual ham_status_t cursor_get_batch(Cursor *cursor, ham_key_t *keys,
+                    ham_record_t *records, ham_u32_t *count, ham_u32_t flags);
+
+    // Moves a cursor to the next (or previous) key which does not share
+    // the key prefix of the current key (ham_cursor_skip_prefix). The
+    // default implementation calls cursor_move() till the prefix changes.
+    virtual ham_status_t cursor_skip_prefix(Cursor *cursor,
+                    ham_u32_t prefix_size, ham_key_t *key,
+                    ham_record_t *record, ham_u32_t flags);
+
     // Closes a cursor (ham_cursor_close)
     void cursor_close(Cursor *cursor);
 
@@ -176,7 +198,38 @@ class Database
       return (m_record_arena);
     }
 
+    // Returns the move flags for the second and all following items of a
+    // batch (ham_cursor_get_batch): a batch which started with
+    // HAM_CURSOR_FIRST continues with HAM_CURSOR_NEXT, and a batch which
+    // started with HAM_CURSOR_LAST continues with HAM_CURSOR_PREVIOUS
+    static ham_u32_t get_batch_continue_flags(ham_u32_t flags) {
+      if (flags & HAM_CURSOR_FIRST)
+        return ((flags & ~HAM_CURSOR_FIRST) | HAM_CURSOR_NEXT);
+      if (flags & HAM_CURSOR_LAST)
+        return ((flags & ~HAM_CURSOR_LAST) | HAM_CURSOR_PREVIOUS);
+      return (flags);
+    }
+
   protected:
+    // Returns true if |key| belongs to the same prefix group as |prefix|
+    // (ham_cursor_skip_prefix). |prefix| is a key truncated to
+    // |prefix_size| bytes; if it is shorter than |prefix_size| then only
+    // identical keys belong to its group.
+    static bool has_same_prefix(const ham_key_t *key,
+                    const ham_key_t *prefix, ham_u32_t prefix_size);
+
+    // Copies the data of a key/record pair which was just retrieved for
+    // a batch (ham_cursor_get_batch) into the Cursor's batch arenas; the
+    // arenas grow with every item, therefore the pointers are fixed up in
+    // finalize_batch() when the batch is complete
+    void append_to_batch(Cursor *cursor, ham_key_t *key,
+                    ham_record_t *record, ham_u32_t flags);
+
+    // Points key->data and record->data of all batch items to the
+    // Cursor's batch arenas
+    void finalize_batch(Cursor *cursor, ham_key_t *keys,
+                    ham_record_t *records, ham_u32_t count, ham_u32_t flags);
+
     // Creates a cursor; this is the actual implementation
     virtual Cursor *cursor_create_impl(Transaction *txn, ham_u32_t flags) = 0;
 
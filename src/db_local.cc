@@ -16,6 +16,7 @@
 #include "btree_index.h"
 #include "btree_index_factory.h"
 #include "btree_cursor.h"
+#include "btree_node_proxy.h"
 #include "btree_stats.h"
 #include "cache.h"
 #include "cursor.h"
@@ -701,6 +702,39 @@ LocalDatabase::get_key_count(Transaction *txn, ham_u32_t flags,
   return (st);
 }
 
+ham_status_t
+LocalDatabase::scan(ham_u32_t partitions, ham_scan_visitor_t visitor,
+                void *context, ham_u32_t flags)
+{
+  if (flags) {
+    ham_trace(("parameter 'flag' contains unsupported flag bits: %08x",
+          flags));
+    return (HAM_INV_PARAMETER);
+  }
+
+  /* purge cache if necessary */
+  get_local_env()->get_page_manager()->purge_cache();
+
+  /*
+   * the scan only looks at the btree; make sure that all committed
+   * transactions are flushed, and that there are no pending operations
+   * of active transactions
+   */
+  if (get_rt_flags() & HAM_ENABLE_TRANSACTIONS) {
+    get_local_env()->flush_committed_txns();
+    if (m_txn_index->get_first()) {
+      ham_trace(("cannot scan database with pending transactional "
+            "operations"));
+      return (HAM_TXN_STILL_OPEN);
+    }
+  }
+
+  m_btree_index->scan(partitions, visitor, context);
+
+  get_local_env()->get_changeset().clear();
+  return (0);
+}
+
 ham_status_t
 LocalDatabase::insert(Transaction *txn, ham_key_t *key,
         ham_record_t *record, ham_u32_t flags)
@@ -1194,6 +1228,10 @@ LocalDatabase::cursor_find(Cursor *cursor, ham_key_t *key,
   Transaction *local_txn = 0;
   TransactionCursor *txnc = cursor->get_txn_cursor();
 
+  /* prefix lookups install a filter and then move to the first key */
+  if (flags & HAM_FIND_PREFIX_MATCH)
+    return (cursor_find_prefix(cursor, key, record, flags));
+
   if (get_key_size() != HAM_KEY_SIZE_UNLIMITED
       && key->size != get_key_size()) {
     ham_trace(("invalid key size (%u instead of %u)",
@@ -1358,6 +1396,31 @@ bail:
   return (0);
 }
 
+ham_status_t
+LocalDatabase::cursor_find_prefix(Cursor *cursor, ham_key_t *key,
+          ham_record_t *record, ham_u32_t flags)
+{
+  /* prefixes are only meaningful if the keys are sorted byte-wise */
+  if (get_key_type() != HAM_TYPE_BINARY) {
+    ham_trace(("HAM_FIND_PREFIX_MATCH requires HAM_TYPE_BINARY keys"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  /* bind the cursor to the prefix; all other criteria of an existing
+   * filter are kept */
+  ham_cursor_filter_t filter;
+  if (cursor->get_filter())
+    filter = *cursor->get_filter()->get_filter();
+  else
+    memset(&filter, 0, sizeof(filter));
+  filter.prefix = key;
+  cursor->set_filter(new CursorFilter(&filter));
+
+  /* then move to the first key of the range */
+  return (cursor_move(cursor, key, record,
+              HAM_CURSOR_FIRST | (flags & (HAM_DIRECT_ACCESS | HAM_PARTIAL))));
+}
+
 ham_status_t
 LocalDatabase::cursor_get_record_count(Cursor *cursor,
           ham_u32_t *count, ham_u32_t flags)
@@ -1410,6 +1473,31 @@ LocalDatabase::cursor_get_record_count(Cursor *cursor,
   return (0);
 }
 
+ham_status_t
+LocalDatabase::cursor_set_filter(Cursor *cursor,
+        const ham_cursor_filter_t *filter)
+{
+  if (!filter) {
+    cursor->set_filter(0);
+    return (0);
+  }
+
+  /* the bounds are compared with the database's comparison function,
+   * therefore they must have the same size as the keys */
+  if (get_key_size() != HAM_KEY_SIZE_UNLIMITED) {
+    if ((filter->lower_bound && filter->lower_bound->size != get_key_size())
+        || (filter->upper_bound
+            && filter->upper_bound->size != get_key_size())) {
+      ham_trace(("invalid key size of filter bound (expected %u)",
+            get_key_size()));
+      return (HAM_INV_KEY_SIZE);
+    }
+  }
+
+  cursor->set_filter(new CursorFilter(filter));
+  return (0);
+}
+
 ham_status_t
 LocalDatabase::cursor_get_record_size(Cursor *cursor, ham_u64_t *size)
 {
@@ -1508,6 +1596,372 @@ LocalDatabase::cursor_move(Cursor *cursor, ham_key_t *key,
   /* purge cache if necessary */
   get_local_env()->get_page_manager()->purge_cache();
 
+  /* if user did not specify a transaction, but transactions are enabled:
+   * create a temporary one */
+  if (!cursor->get_txn() && (get_rt_flags() & HAM_ENABLE_TRANSACTIONS)) {
+    get_local_env()->txn_begin(&local_txn, 0, HAM_TXN_TEMPORARY);
+    cursor->set_txn(local_txn);
+  }
+
+  /* everything else is handled by cursor_move_impl() */
+  st = cursor_move_impl(cursor, key, record, flags);
+
+  /* if we created a temp. txn then clean it up again */
+  if (local_txn) {
+    cursor->set_txn(0);
+    if (st)
+      local_txn->abort();
+    else
+      local_txn->commit();
+  }
+
+  return (st);
+}
+
+ham_status_t
+LocalDatabase::cursor_get_batch(Cursor *cursor, ham_key_t *keys,
+        ham_record_t *records, ham_u32_t *count, ham_u32_t flags)
+{
+  ham_status_t st = 0;
+  Transaction *local_txn = 0;
+  ham_u32_t max = *count;
+  ham_u32_t i;
+
+  cursor->get_batch_key_arena().set_size(0);
+  cursor->get_batch_record_arena().set_size(0);
+
+  /* purge cache if necessary; this is done only once for the whole
+   * batch */
+  get_local_env()->get_page_manager()->purge_cache();
+
+  /* if user did not specify a transaction, but transactions are enabled:
+   * create a temporary one, which is shared by all items of the batch */
+  if (!cursor->get_txn() && (get_rt_flags() & HAM_ENABLE_TRANSACTIONS)) {
+    get_local_env()->txn_begin(&local_txn, 0, HAM_TXN_TEMPORARY);
+    cursor->set_txn(local_txn);
+  }
+
+  for (i = 0; i < max; i++) {
+    ham_key_t *key = keys ? &keys[i] : 0;
+    ham_record_t *record = records ? &records[i] : 0;
+
+    st = cursor_move_impl(cursor, key, record,
+                    i == 0 ? flags : get_batch_continue_flags(flags));
+    if (st)
+      break;
+    append_to_batch(cursor, key, record, flags);
+  }
+
+  /* if we created a temp. txn then clean it up again */
+  if (local_txn) {
+    cursor->set_txn(0);
+    if (i == 0 && st)
+      local_txn->abort();
+    else
+      local_txn->commit();
+  }
+
+  finalize_batch(cursor, keys, records, i, flags);
+  *count = i;
+
+  /* reaching the end of the database is not an error if at least one
+   * item was retrieved */
+  if (st == HAM_KEY_NOT_FOUND && i > 0)
+    return (0);
+  return (st);
+}
+
+ham_status_t
+LocalDatabase::cursor_skip_prefix(Cursor *cursor, ham_u32_t prefix_size,
+        ham_key_t *key, ham_record_t *record, ham_u32_t flags)
+{
+  ham_status_t st = 0;
+  Transaction *local_txn = 0;
+
+  /* prefixes are only meaningful if the keys are sorted byte-wise */
+  if (get_key_type() != HAM_TYPE_BINARY) {
+    ham_trace(("ham_cursor_skip_prefix requires HAM_TYPE_BINARY keys"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  /* purge cache if necessary */
+  get_local_env()->get_page_manager()->purge_cache();
+
+  /* if user did not specify a transaction, but transactions are enabled:
+   * create a temporary one */
+  if (!cursor->get_txn() && (get_rt_flags() & HAM_ENABLE_TRANSACTIONS)) {
+    get_local_env()->txn_begin(&local_txn, 0, HAM_TXN_TEMPORARY);
+    cursor->set_txn(local_txn);
+  }
+
+  st = cursor_skip_prefix_impl(cursor, prefix_size, key, record, flags);
+
+  /* if we created a temp. txn then clean it up again */
+  if (local_txn) {
+    cursor->set_txn(0);
+    if (st)
+      local_txn->abort();
+    else
+      local_txn->commit();
+  }
+
+  return (st);
+}
+
+ham_status_t
+LocalDatabase::cursor_skip_prefix_impl(Cursor *cursor, ham_u32_t prefix_size,
+        ham_key_t *key, ham_record_t *record, ham_u32_t flags)
+{
+  ham_status_t st;
+  bool forward = (flags & HAM_CURSOR_PREVIOUS) == 0;
+  ham_u32_t direction = forward ? HAM_CURSOR_NEXT : HAM_CURSOR_PREVIOUS;
+
+  /* fetch the current key and make a copy */
+  ham_key_t current = {0};
+  st = cursor_copy_current(cursor, &current, 0, 0);
+  if (st)
+    return (st);
+
+  ByteArray arena;
+  ham_key_t old = {0};
+  old.size = current.size;
+  if (old.size) {
+    arena.copy(current.data, old.size);
+    old.data = arena.get_ptr();
+  }
+
+  ham_key_t prefix = old;
+  prefix.size = std::min(prefix_size, (ham_u32_t)old.size);
+
+  if (prefix.size == prefix_size && !has_pending_txn_operations()) {
+    /* the btree is not shadowed by Transactions: look up the first key
+     * of the next prefix (or the first key of the current prefix, and
+     * then step back) instead of walking over all keys of the current
+     * prefix */
+    ByteArray seek_arena;
+    ham_key_t seek = {0};
+    if (!CursorFilter::make_seek_key(this, prefix.data, prefix.size,
+                forward, &seek_arena, &seek))
+      return (HAM_KEY_NOT_FOUND);
+
+    st = cursor_find(cursor, &seek, 0, HAM_FIND_GEQ_MATCH);
+    if (st == 0) {
+      if (forward)
+        current = seek;
+      else
+        st = cursor_move_step(cursor, &current, 0, direction);
+    }
+  }
+  else {
+    /* otherwise move till the prefix changes */
+    while (true) {
+      st = cursor_move_step(cursor, &current, 0, direction);
+      if (st || !has_same_prefix(&current, &prefix, prefix_size))
+        break;
+    }
+  }
+
+  /* no such key: restore the previous position */
+  if (st == HAM_KEY_NOT_FOUND)
+    (void)cursor_find(cursor, &old, 0, 0);
+  if (st)
+    return (st);
+
+  /* apply the filter, if there is one */
+  if (cursor->get_filter()) {
+    int result = cursor_evaluate_filter(cursor, &current, forward);
+    if (result == CursorFilter::kStop)
+      return (HAM_KEY_NOT_FOUND);
+    if (result == CursorFilter::kSkip)
+      return (cursor_move_filtered(cursor, key, record, direction
+                              | (flags & HAM_DIRECT_ACCESS)));
+  }
+
+  return (cursor_copy_current(cursor, key, record, flags));
+}
+
+bool
+LocalDatabase::has_pending_txn_operations()
+{
+  return (m_txn_index && m_txn_index->get_first() != 0);
+}
+
+ham_status_t
+LocalDatabase::cursor_move_impl(Cursor *cursor, ham_key_t *key,
+        ham_record_t *record, ham_u32_t flags)
+{
+  /* if a filter is installed then skip all keys which do not match;
+   * the filter is not applied if the cursor does not move */
+  if (cursor->get_filter()
+      && (flags & (HAM_CURSOR_FIRST | HAM_CURSOR_LAST
+                    | HAM_CURSOR_NEXT | HAM_CURSOR_PREVIOUS)))
+    return (cursor_move_filtered(cursor, key, record, flags));
+
+  return (cursor_move_step(cursor, key, record, flags));
+}
+
+ham_status_t
+LocalDatabase::cursor_move_filtered(Cursor *cursor, ham_key_t *key,
+        ham_record_t *record, ham_u32_t flags)
+{
+  ham_status_t st;
+  CursorFilter *filter = cursor->get_filter();
+  bool forward = (flags & (HAM_CURSOR_FIRST | HAM_CURSOR_NEXT)) != 0;
+
+  /* a NEXT (PREVIOUS) on a fresh cursor is a FIRST (LAST) */
+  if (cursor->is_nil(0) && cursor->is_first_use()) {
+    if (flags & HAM_CURSOR_NEXT)
+      flags = (flags & ~HAM_CURSOR_NEXT) | HAM_CURSOR_FIRST;
+    else if (flags & HAM_CURSOR_PREVIOUS)
+      flags = (flags & ~HAM_CURSOR_PREVIOUS) | HAM_CURSOR_LAST;
+  }
+
+  while (true) {
+    /* move the cursor, but only retrieve the key; the record is not
+     * copied unless the key matches the filter */
+    ham_key_t current = {0};
+    if (flags & (HAM_CURSOR_FIRST | HAM_CURSOR_LAST))
+      st = cursor_seek_filtered(cursor, &current, forward, flags);
+    else if (cursor_is_at_filter_boundary(cursor, forward, flags))
+      st = HAM_KEY_NOT_FOUND;
+    else
+      st = cursor_move_step(cursor, &current, 0, flags);
+    if (st)
+      return (st);
+
+    /* FIRST/LAST were processed; from now on move NEXT/PREVIOUS */
+    flags = get_batch_continue_flags(flags);
+
+    int result = cursor_evaluate_filter(cursor, &current, forward);
+    if (result == CursorFilter::kStop)
+      return (HAM_KEY_NOT_FOUND);
+    if (result == CursorFilter::kSkip)
+      continue;
+
+    /* a match - now copy the key and the record to the caller; this does
+     * not move the cursor */
+    return (cursor_copy_current(cursor, key, record, flags));
+  }
+}
+
+int
+LocalDatabase::cursor_evaluate_filter(Cursor *cursor, ham_key_t *key,
+        bool forward)
+{
+  CursorFilter *filter = cursor->get_filter();
+
+  int result = filter->evaluate_key(this, key, forward);
+  if (result != CursorFilter::kMatch)
+    return (result);
+
+  if (filter->requires_record_size()) {
+    ham_u64_t size = cursor->get_record_size(cursor->get_txn());
+    get_local_env()->get_changeset().clear();
+    if (!filter->evaluate_record(key, size))
+      return (CursorFilter::kSkip);
+  }
+  return (CursorFilter::kMatch);
+}
+
+ham_status_t
+LocalDatabase::cursor_seek_filtered(Cursor *cursor, ham_key_t *key,
+        bool forward, ham_u32_t flags)
+{
+  ham_status_t st;
+  ham_key_t seek = {0};
+  ham_u32_t find_flags = 0;
+
+  /* approximate lookups are only reliable if the btree is not shadowed
+   * by Transactions; otherwise walk from the first (last) key */
+  if (has_pending_txn_operations()
+      || !cursor->get_filter()->get_seek_key(this, forward, &seek,
+              &find_flags))
+    return (cursor_move_step(cursor, key, 0, flags));
+
+  st = cursor_find(cursor, &seek, 0, find_flags);
+  if (forward) {
+    if (st == 0)
+      *key = seek;
+    return (st);
+  }
+
+  /* the cursor now points behind the range (or there is no such key);
+   * step back to the last key which might match */
+  if (st == 0)
+    return (cursor_move_step(cursor, key, 0, HAM_CURSOR_PREVIOUS));
+  if (st == HAM_KEY_NOT_FOUND)
+    return (cursor_move_step(cursor, key, 0, HAM_CURSOR_LAST));
+  return (st);
+}
+
+bool
+LocalDatabase::cursor_is_at_filter_boundary(Cursor *cursor, bool forward,
+        ham_u32_t flags)
+{
+  /* the internal nodes only describe the btree; they cannot be used
+   * if there are pending operations in the Transaction index */
+  if (has_pending_txn_operations() || (flags & HAM_ONLY_DUPLICATES))
+    return (false);
+
+  BtreeCursor *btc = cursor->get_btree_cursor();
+  if (btc->get_state() != BtreeCursor::kStateCoupled)
+    return (false);
+
+  Page *page;
+  ham_u32_t slot;
+  btc->get_coupled_key(&page, &slot);
+  BtreeNodeProxy *node = m_btree_index->get_node_from_page(page);
+
+  /* only check the internal nodes when leaving the current leaf */
+  if (forward) {
+    if (slot + 1 < node->get_count() || !node->get_right())
+      return (false);
+  }
+  else {
+    if (slot > 0 || !node->get_left())
+      return (false);
+  }
+
+  /* the next move would stay on a duplicate of the current key */
+  if (!(flags & HAM_SKIP_DUPLICATES) && node->get_record_count(slot) > 1)
+    return (false);
+
+  ByteArray key_arena, separator_arena;
+  ham_key_t key = {0};
+  ham_key_t separator = {0};
+  node->get_key(slot, &key_arena, &key);
+  if (!m_btree_index->find_separator(&key, forward, &separator_arena,
+              &separator))
+    return (false);
+
+  /* all keys in the following leafs are >= the separator (or < the
+   * separator when moving backwards); if the separator is out of range
+   * then the next leaf does not have to be fetched */
+  return (cursor->get_filter()->evaluate_key(this, &separator, forward)
+              == CursorFilter::kStop);
+}
+
+ham_status_t
+LocalDatabase::cursor_copy_current(Cursor *cursor, ham_key_t *key,
+        ham_record_t *record, ham_u32_t flags)
+{
+  ham_status_t st;
+
+  if (get_rt_flags() & HAM_ENABLE_TRANSACTIONS)
+    st = cursor->move(key, record, 0);
+  else
+    st = cursor->get_btree_cursor()->move(key, record,
+                    flags & HAM_DIRECT_ACCESS);
+  get_local_env()->get_changeset().clear();
+  return (st);
+}
+
+ham_status_t
+LocalDatabase::cursor_move_step(Cursor *cursor, ham_key_t *key,
+        ham_record_t *record, ham_u32_t flags)
+{
+  ham_status_t st = 0;
+
   /*
    * if the cursor was never used before and the user requests a NEXT then
    * move the cursor to FIRST; if the user requests a PREVIOUS we set it
@@ -1543,48 +1997,31 @@ LocalDatabase::cursor_move(Cursor *cursor, ham_key_t *key,
     return (st);
   }
 
-  /* if user did not specify a transaction, but transactions are enabled:
-   * create a temporary one */
-  if (!cursor->get_txn() && (get_rt_flags() & HAM_ENABLE_TRANSACTIONS)) {
-    get_local_env()->txn_begin(&local_txn, 0, HAM_TXN_TEMPORARY);
-    cursor->set_txn(local_txn);
-  }
-
   /* everything else is handled by the cursor function */
   st = cursor->move(key, record, flags);
 
-  /* if we created a temp. txn then clean it up again */
-  if (local_txn)
-    cursor->set_txn(0);
-
   get_local_env()->get_changeset().clear();
 
-  /* store the direction */
+  /* store the direction; a call without direction does not move the
+   * cursor, and the previous operation (i.e. a lookup which requires a
+   * sync of the btree and txn cursors) must not be forgotten */
   if (flags & HAM_CURSOR_NEXT)
     cursor->set_lastop(HAM_CURSOR_NEXT);
   else if (flags & HAM_CURSOR_PREVIOUS)
     cursor->set_lastop(HAM_CURSOR_PREVIOUS);
-  else
+  else if (flags & (HAM_CURSOR_FIRST | HAM_CURSOR_LAST))
     cursor->set_lastop(0);
 
   if (st) {
-    if (local_txn)
-      local_txn->abort();
     if (st == HAM_KEY_ERASED_IN_TXN)
       st = HAM_KEY_NOT_FOUND;
     /* trigger a sync when the function is called again */
     cursor->set_lastop(0);
-    /* make sure that the changeset is empty */
-    ham_assert(get_local_env()->get_changeset().is_empty());
-    return (st);
   }
 
-  if (local_txn)
-    local_txn->commit();
-
   /* make sure that the changeset is empty */
   ham_assert(get_local_env()->get_changeset().is_empty());
-  return (0);
+  return (st);
 }
 
 void
@@ -1599,6 +2036,10 @@ LocalDatabase::close_impl(ham_u32_t flags)
   /* check if this database is modified by an active transaction */
   TransactionIndex *tree = get_txn_index();
   if (tree) {
+    /* committed transactions can still be waiting for the background
+     * thread; flush them before the index is deleted */
+    get_local_env()->flush_committed_txns();
+
     TransactionNode *node = tree->get_first();
     while (node) {
       TransactionOperation *op = node->get_newest_op();
@@ -75,6 +75,11 @@ class LocalDatabase : public Database {
     virtual ham_status_t get_key_count(Transaction *txn, ham_u32_t flags,
                     ham_u64_t *keycount);
 
+    // Scans all keys in parallel partitions (ham_db_scan)
+    virtual ham_status_t scan(ham_u32_t partitions,
+                    ham_scan_visitor_t visitor, void *context,
+                    ham_u32_t flags);
+
     // Inserts a key/value pair (ham_db_insert)
     virtual ham_status_t insert(Transaction *txn, ham_key_t *key,
                     ham_record_t *record, ham_u32_t flags);
@@ -106,6 +111,10 @@ class LocalDatabase : public Database {
     virtual ham_status_t cursor_get_record_size(Cursor *cursor,
                     ham_u64_t *size);
 
+    // Installs a filter for cursor scans (ham_cursor_set_filter)
+    virtual ham_status_t cursor_set_filter(Cursor *cursor,
+                    const ham_cursor_filter_t *filter);
+
     // Overwrites the record of a cursor (ham_cursor_overwrite)
     virtual ham_status_t cursor_overwrite(Cursor *cursor,
                     ham_record_t *record, ham_u32_t flags);
@@ -114,6 +123,17 @@ class LocalDatabase : public Database {
     virtual ham_status_t cursor_move(Cursor *cursor,
                     ham_key_t *key, ham_record_t *record, ham_u32_t flags);
 
+    // Moves a cursor over several keys and returns up to |*count|
+    // key/record pairs (ham_cursor_get_batch)
+    virtual ham_status_t cursor_get_batch(Cursor *cursor, ham_key_t *keys,
+                    ham_record_t *records, ham_u32_t *count, ham_u32_t flags);
+
+    // Moves a cursor to the next (or previous) key which does not share
+    // the key prefix of the current key (ham_cursor_skip_prefix)
+    virtual ham_status_t cursor_skip_prefix(Cursor *cursor,
+                    ham_u32_t prefix_size, ham_key_t *key,
+                    ham_record_t *record, ham_u32_t flags);
+
     // Inserts a key/record pair in a txn node; if cursor is not NULL it will
     // be attached to the new txn_op structure
     // TODO this should be private
@@ -206,6 +226,56 @@ class LocalDatabase : public Database {
     // Sets all cursors to nil if they point to |key| in the btree index
     void nil_all_cursors_in_btree(Cursor *current, ham_key_t *key);
 
+    // Moves a cursor; the actual implementation of cursor_move() and
+    // cursor_get_batch(). Expects that the cache was already purged and
+    // that a (temporary) Transaction was assigned to the cursor
+    ham_status_t cursor_move_impl(Cursor *cursor, ham_key_t *key,
+                    ham_record_t *record, ham_u32_t flags);
+
+    // Moves a cursor by a single step; called by cursor_move_impl()
+    ham_status_t cursor_move_step(Cursor *cursor, ham_key_t *key,
+                    ham_record_t *record, ham_u32_t flags);
+
+    // Moves a cursor till it reaches a key which matches the cursor's
+    // filter (see ham_cursor_set_filter); called by cursor_move_impl()
+    ham_status_t cursor_move_filtered(Cursor *cursor, ham_key_t *key,
+                    ham_record_t *record, ham_u32_t flags);
+
+    // Evaluates the cursor's filter for the current key |key|; returns
+    // CursorFilter::kMatch, kSkip or kStop
+    int cursor_evaluate_filter(Cursor *cursor, ham_key_t *key, bool forward);
+
+    // Implements HAM_CURSOR_FIRST and HAM_CURSOR_LAST for filtered
+    // cursors; jumps directly to the beginning (or the end) of the filter's
+    // key range if possible. Only retrieves the key.
+    ham_status_t cursor_seek_filtered(Cursor *cursor, ham_key_t *key,
+                    bool forward, ham_u32_t flags);
+
+    // Returns true if the cursor points to the last (or first) key of a
+    // leaf and the internal nodes prove that none of the following leafs
+    // can contain a key which matches the cursor's filter
+    bool cursor_is_at_filter_boundary(Cursor *cursor, bool forward,
+                    ham_u32_t flags);
+
+    // Copies the key and the record of the cursor's current position
+    // without moving the cursor
+    ham_status_t cursor_copy_current(Cursor *cursor, ham_key_t *key,
+                    ham_record_t *record, ham_u32_t flags);
+
+    // Implements HAM_FIND_PREFIX_MATCH for ham_cursor_find
+    ham_status_t cursor_find_prefix(Cursor *cursor, ham_key_t *key,
+                    ham_record_t *record, ham_u32_t flags);
+
+    // The actual implementation of cursor_skip_prefix()
+    ham_status_t cursor_skip_prefix_impl(Cursor *cursor,
+                    ham_u32_t prefix_size, ham_key_t *key,
+                    ham_record_t *record, ham_u32_t flags);
+
+    // Returns true if the Transaction index has operations which were
+    // not yet flushed to the btree; then the btree alone cannot be used
+    // for approximate lookups
+    bool has_pending_txn_operations();
+
     // Lookup of a key/record pair in the Transaction index and in the btree,
     // if transactions are disabled/not successful; copies the
     // record into |record|. Also performs approx. matching.
@@ -134,6 +134,18 @@ RemoteDatabase::get_key_count(Transaction *txn, ham_u32_t flags,
   return (st);
 }
 
+ham_status_t
+RemoteDatabase::scan(ham_u32_t partitions, ham_scan_visitor_t visitor,
+            void *context, ham_u32_t flags)
+{
+  (void)partitions;
+  (void)visitor;
+  (void)context;
+  (void)flags;
+  /* a remote visitor callback would require a round trip per key */
+  return (HAM_NOT_IMPLEMENTED);
+}
+
 ham_status_t
 RemoteDatabase::insert(Transaction *txn, ham_key_t *key,
             ham_record_t *record, ham_u32_t flags)
@@ -470,6 +482,42 @@ RemoteDatabase::cursor_get_record_size(Cursor *cursor,
   return (HAM_NOT_IMPLEMENTED);
 }
 
+ham_status_t
+RemoteDatabase::cursor_set_filter(Cursor *cursor,
+            const ham_cursor_filter_t *filter)
+{
+  RemoteEnvironment *env = get_remote_env();
+
+  /* the predicate is a local function and cannot be sent to the server */
+  if (filter && filter->predicate) {
+    ham_trace(("filter predicates are not supported for remote databases"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  Protocol request(Protocol::CURSOR_SET_FILTER_REQUEST);
+  request.mutable_cursor_set_filter_request()->set_cursor_handle(cursor->get_remote_handle());
+  request.mutable_cursor_set_filter_request()->set_has_filter(filter != 0);
+  if (filter) {
+    if (filter->lower_bound)
+      Protocol::assign_key(request.mutable_cursor_set_filter_request()->mutable_lower_bound(),
+                    filter->lower_bound);
+    if (filter->upper_bound)
+      Protocol::assign_key(request.mutable_cursor_set_filter_request()->mutable_upper_bound(),
+                    filter->upper_bound);
+    if (filter->prefix)
+      Protocol::assign_key(request.mutable_cursor_set_filter_request()->mutable_prefix(),
+                    filter->prefix);
+    request.mutable_cursor_set_filter_request()->set_min_record_size(filter->min_record_size);
+    request.mutable_cursor_set_filter_request()->set_max_record_size(filter->max_record_size);
+  }
+
+  std::auto_ptr<Protocol> reply(env->perform_request(&request));
+
+  ham_assert(reply->has_cursor_set_filter_reply());
+
+  return (reply->cursor_set_filter_reply().status());
+}
+
 ham_status_t
 RemoteDatabase::cursor_overwrite(Cursor *cursor,
             ham_record_t *record, ham_u32_t flags)
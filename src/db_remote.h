@@ -46,6 +46,11 @@ class RemoteDatabase : public Database
     virtual ham_status_t get_key_count(Transaction *txn, ham_u32_t flags,
                     ham_u64_t *keycount);
 
+    // Scans all keys in parallel partitions (ham_db_scan)
+    virtual ham_status_t scan(ham_u32_t partitions,
+                    ham_scan_visitor_t visitor, void *context,
+                    ham_u32_t flags);
+
     // Inserts a key/value pair (ham_db_insert)
     virtual ham_status_t insert(Transaction *txn, ham_key_t *key,
                     ham_record_t *record, ham_u32_t flags);
@@ -77,6 +82,10 @@ class RemoteDatabase : public Database
     virtual ham_status_t cursor_get_record_size(Cursor *cursor,
                     ham_u64_t *size);
 
+    // Installs a filter for cursor scans (ham_cursor_set_filter)
+    virtual ham_status_t cursor_set_filter(Cursor *cursor,
+                    const ham_cursor_filter_t *filter);
+
     // Overwrites the record of a cursor (ham_cursor_overwrite)
     virtual ham_status_t cursor_overwrite(Cursor *cursor,
                     ham_record_t *record, ham_u32_t flags);
@@ -20,6 +20,7 @@
 #define HAM_DEVICE_H__
 
 #include <ham/hamsterdb.h>
+#include <ham/hamsterdb_int.h>
 
 #include "config.h"
 
@@ -36,7 +37,8 @@ class Device {
     // overwritten i.e. by ham_env_open, ham_env_create when the page_size
     // of the file is known
     Device(LocalEnvironment *env, ham_u32_t flags)
-      : m_env(env), m_flags(flags), m_page_size(HAM_DEFAULT_PAGESIZE) {
+      : m_env(env), m_flags(flags), m_page_size(HAM_DEFAULT_PAGESIZE),
+        m_growth_size(0) {
     }
 
     // virtual destructor
@@ -59,6 +61,13 @@ class Device {
     // truncate/resize the device
     virtual void truncate(ham_u64_t newsize) = 0;
 
+    // releases the storage of an unused area without changing the size
+    // of the device
+    virtual void punch_hole(ham_u64_t offset, ham_u64_t size) = 0;
+
+    // returns true if the area is part of the memory mapped region
+    virtual bool is_mapped(ham_u64_t offset, ham_u64_t size) const = 0;
+
     // returns true if the device is open
     virtual bool is_open() = 0;
 
@@ -89,6 +98,18 @@ class Device {
     // writes a page to the device
     virtual void write_page(Page *page) = 0;
 
+    // writes a batch of pages to the device; the default implementation
+    // writes them one after the other
+    virtual void write_pages(Page **pages, ham_u32_t count) {
+      for (ham_u32_t i = 0; i < count; i++)
+        write_page(pages[i]);
+    }
+
+    // starts reading the page at |address| in the background because it
+    // will be required soon; this is only a hint
+    virtual void prefetch_page(ham_u64_t address) {
+    }
+
     // allocate storage from this device; this function
     // will *NOT* use mmap.
     virtual ham_u64_t alloc(ham_u32_t size) = 0;
@@ -103,6 +124,10 @@ class Device {
     // function will assert that the page is not dirty.
     virtual void free_page(Page *page) = 0;
 
+    // fills in the device metrics
+    virtual void get_metrics(ham_env_metrics_t *metrics) const {
+    }
+
     // get the Environment
     //
     // TODO get rid of this function. It's only used in the PageManager.
@@ -115,6 +140,12 @@ class Device {
       m_page_size = page_size;
     }
 
+    // set the size of the steps in which the file is extended; 0 extends
+    // the file page by page
+    void set_growth_size(ham_u64_t growth_size) {
+      m_growth_size = growth_size;
+    }
+
     // disable memory mapped I/O - used for testing
     void test_disable_mmap() {
       m_flags |= HAM_DISABLE_MMAP;
@@ -130,6 +161,9 @@ class Device {
     // the page size 
     ham_u32_t m_page_size;
 
+    // the file is extended in steps of this size
+    ham_u64_t m_growth_size;
+
     friend class DeviceTest;
     friend class InMemoryDeviceTest;
 };
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2005-2013 Christoph Rupp (chris@crupp.de).
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * See files COPYING.* for License information.
+ */
+
+#ifndef HAM_DEVICE_ASYNC_H__
+#define HAM_DEVICE_ASYNC_H__
+
+#include <map>
+#include <vector>
+
+#include "device_disk.h"
+#include "async_io.h"
+
+namespace hamsterdb {
+
+/*
+ * a File-based device with asynchronous I/O
+ *
+ * Batches of pages are written in parallel, and pages can be read ahead
+ * in the background. The prefetched page is kept in a buffer till it is
+ * requested with read_page(). All other operations are inherited from
+ * the DiskDevice.
+ */
+class AsyncDiskDevice : public DiskDevice {
+    enum {
+      // the max. number of prefetched pages which were not yet requested
+      kMaxPrefetchedPages = 64
+    };
+
+    typedef std::map<ham_u64_t, AsyncIoRequest *> PrefetchMap;
+
+  public:
+    AsyncDiskDevice(LocalEnvironment *env, ham_u32_t flags,
+                    ham_u32_t backend)
+      : DiskDevice(env, flags), m_backend(backend), m_aio(0),
+        m_prefetch_hits(0) {
+    }
+
+    virtual ~AsyncDiskDevice() {
+      discard_prefetched_pages(0, 0);
+      delete m_aio;
+    }
+
+    // Create a new device
+    virtual void create(const char *filename, ham_u32_t flags,
+                    ham_u32_t mode) {
+      DiskDevice::create(filename, flags, mode);
+      m_aio = AsyncIo::create(m_backend);
+    }
+
+    // opens an existing device
+    virtual void open(const char *filename, ham_u32_t flags) {
+      DiskDevice::open(filename, flags);
+      m_aio = AsyncIo::create(m_backend);
+    }
+
+    // closes the device
+    virtual void close() {
+      discard_prefetched_pages(0, 0);
+      delete m_aio;
+      m_aio = 0;
+      DiskDevice::close();
+    }
+
+    // truncate/resize the device
+    virtual void truncate(ham_u64_t newsize) {
+      discard_prefetched_pages(newsize, 0);
+      DiskDevice::truncate(newsize);
+    }
+
+    // releases the storage of an unused file area
+    virtual void punch_hole(ham_u64_t offset, ham_u64_t size) {
+      discard_prefetched_pages(offset, size);
+      DiskDevice::punch_hole(offset, size);
+    }
+
+    // writes to the device
+    virtual void write(ham_u64_t offset, void *buffer, ham_u64_t size) {
+      discard_prefetched_pages(offset, size);
+      DiskDevice::write(offset, buffer, size);
+    }
+
+    // writes to the device
+    virtual void writev(ham_u64_t offset, void *buffer1, ham_u64_t size1,
+                    void *buffer2, ham_u64_t size2) {
+      discard_prefetched_pages(offset, size1 + size2);
+      DiskDevice::writev(offset, buffer1, size1, buffer2, size2);
+    }
+
+    // reads a page from the device; uses the prefetched data if it's
+    // available
+    virtual void read_page(Page *page) {
+      PrefetchMap::iterator it = m_prefetched.find(page->get_address());
+      if (it == m_prefetched.end()) {
+        DiskDevice::read_page(page);
+        return;
+      }
+
+      AsyncIoRequest *request = it->second;
+      m_prefetched.erase(it);
+      m_aio->wait(request);
+      if (request->status) {
+        // try again synchronously
+        Memory::release(request->buffer);
+        delete request;
+        DiskDevice::read_page(page);
+        return;
+      }
+
+      if (page->get_data() && page->get_flags() & Page::kNpersMalloc)
+        Memory::release(page->get_data());
+      page->set_data((PPageData *)request->buffer);
+      page->set_flags(page->get_flags() | Page::kNpersMalloc);
+      delete request;
+      m_unmapped_reads++;
+      m_prefetch_hits++;
+    }
+
+    // writes a batch of pages; the writes are submitted at once and
+    // run in parallel
+    virtual void write_pages(Page **pages, ham_u32_t count) {
+      if (count < 2 || m_env->is_encryption_enabled()) {
+        DiskDevice::write_pages(pages, count);
+        return;
+      }
+      for (ham_u32_t i = 0; i < count; i++) {
+        if (!is_aligned(pages[i]->get_address(), pages[i]->get_data(),
+                    m_page_size)) {
+          DiskDevice::write_pages(pages, count);
+          return;
+        }
+      }
+
+      std::vector<AsyncIoRequest> requests(count);
+      std::vector<AsyncIoRequest *> ptrs(count);
+      for (ham_u32_t i = 0; i < count; i++) {
+        discard_prefetched_pages(pages[i]->get_address(), m_page_size);
+        requests[i] = AsyncIoRequest(AsyncIoRequest::kWrite, m_fd,
+                        pages[i]->get_address(), pages[i]->get_data(),
+                        m_page_size);
+        ptrs[i] = &requests[i];
+      }
+
+      m_aio->submit(&ptrs[0], count);
+      m_aio->wait_all();
+
+      for (ham_u32_t i = 0; i < count; i++) {
+        if (requests[i].status)
+          throw Exception(requests[i].status);
+        count_write(m_page_size);
+        update_mapping(pages[i]->get_address(),
+                        (ham_u8_t *)pages[i]->get_data(), m_page_size);
+      }
+    }
+
+    // starts reading a page in the background; mapped pages are not
+    // prefetched
+    virtual void prefetch_page(ham_u64_t address) {
+      if (!m_aio || m_env->is_encryption_enabled())
+        return;
+      if (address + m_page_size > m_allocated_size)
+        return;
+      if (m_prefetched.size() >= kMaxPrefetchedPages
+          || m_prefetched.find(address) != m_prefetched.end())
+        return;
+      if (!is_aligned(address, 0, m_page_size) || map_page(address))
+        return;
+
+      AsyncIoRequest *request = new AsyncIoRequest(AsyncIoRequest::kRead,
+                      m_fd, address, allocate_page_buffer(), m_page_size);
+      m_prefetched[address] = request;
+      m_aio->submit(&request, 1);
+    }
+
+    // fills in the metrics
+    virtual void get_metrics(ham_env_metrics_t *metrics) const {
+      DiskDevice::get_metrics(metrics);
+      metrics->device_prefetch_hits = m_prefetch_hits;
+    }
+
+    // returns the name of the AsyncIo implementation - used for testing
+    const char *test_get_backend_name() const {
+      return (m_aio ? m_aio->get_name() : 0);
+    }
+
+  private:
+    // Discards all prefetched pages which overlap with the file area
+    // [offset, offset + size[; a |size| of 0 means "till the end of the
+    // file". Required whenever the file is modified
+    void discard_prefetched_pages(ham_u64_t offset, ham_u64_t size) {
+      if (m_prefetched.empty())
+        return;
+      PrefetchMap::iterator it = m_prefetched.lower_bound(
+                      offset >= m_page_size ? offset - m_page_size + 1 : 0);
+      while (it != m_prefetched.end()
+              && (size == 0 || it->first < offset + size)) {
+        m_aio->wait(it->second);
+        Memory::release(it->second->buffer);
+        delete it->second;
+        m_prefetched.erase(it++);
+      }
+    }
+
+    // the I/O backend (HAM_IO_BACKEND_ASYNC or HAM_IO_BACKEND_THREADS)
+    ham_u32_t m_backend;
+
+    // the asynchronous I/O implementation
+    AsyncIo *m_aio;
+
+    // the pages which are read ahead, indexed by address
+    PrefetchMap m_prefetched;
+
+    // number of pages which were requested after they were prefetched
+    ham_u64_t m_prefetch_hits;
+};
+
+} // namespace hamsterdb
+
+#endif /* HAM_DEVICE_ASYNC_H__ */
@@ -13,6 +13,9 @@
 #ifndef HAM_DEVICE_DISK_H__
 #define HAM_DEVICE_DISK_H__
 
+#include <vector>
+#include <algorithm>
+
 #include "os.h"
 #include "mem.h"
 #include "db.h"
@@ -26,49 +29,96 @@ namespace hamsterdb {
 
 /*
  * a File-based device
+ *
+ * The file is memory mapped in one or more regions. The mapping is created
+ * when the first page is read, and grows with the file: on Linux the last
+ * region is extended with mremap(2) if possible, otherwise an additional
+ * region is mapped. The regions never move because Page objects point
+ * into them.
+ *
+ * With HAM_DIRECT_IO the file bypasses the page cache of the operating
+ * system. Then all I/O has to be aligned; page buffers are allocated with
+ * the required alignment, and unaligned requests (i.e. for blobs or the
+ * header) go through an aligned bounce buffer.
  */
 class DiskDevice : public Device {
+    // a memory mapped region of the file
+    struct MappedRegion {
+      // the file offset of the region
+      ham_u64_t offset;
+
+      // the size of the region
+      ham_u64_t size;
+
+      // pointer to the mapped data
+      ham_u8_t *ptr;
+
+      // the win32 mmap handle
+      ham_fd_t win32mmap;
+    };
+
+    enum {
+      // the mapping grows at least by this many bytes...
+      kMinMappingGrowth = 4 * 1024 * 1024,
+
+      // ... and at most by this many bytes (unless more is required)
+      kMaxMappingGrowth = 1024 * 1024 * 1024,
+
+      // file offsets, sizes and buffers of direct I/O are aligned to
+      // this boundary; sufficient for all common block devices
+      kDirectIoAlignment = 4096,
+
+      // adjacent pages are coalesced into writes of at most this size
+      kMaxCoalescedWrite = 1024 * 1024
+    };
+
   public:
     DiskDevice(LocalEnvironment *env, ham_u32_t flags)
-      : Device(env, flags), m_fd(HAM_INVALID_FD), m_win32mmap(HAM_INVALID_FD),
-        m_mmapptr(0), m_mapped_size(0) {
+      : Device(env, flags), m_fd(HAM_INVALID_FD), m_mapped_size(0),
+        m_mapping_failed(false), m_mapped_reads(0), m_unmapped_reads(0),
+        m_file_size(0), m_allocated_size(0), m_bounce_buffer(0),
+        m_bounce_size(0), m_writes(0), m_bytes_written(0) {
+    }
+
+    virtual ~DiskDevice() {
+      Memory::release(m_bounce_buffer);
     }
 
     // Create a new device
     virtual void create(const char *filename, ham_u32_t flags, ham_u32_t mode) {
       m_flags = flags;
       m_fd = os_create(filename, flags, mode);
+      m_file_size = m_allocated_size = 0;
     }
 
     // opens an existing device
     //
-    // tries to map the file; if it fails then continue with read/write 
+    // the file is mapped when the first page is read, because the page
+    // size is not yet known
     virtual void open(const char *filename, ham_u32_t flags) {
       m_flags = flags;
       m_fd = os_open(filename, flags);
-
-      if (m_flags & HAM_DISABLE_MMAP)
-        return;
-
-      // the file size which backs the mapped ptr
-      ham_u64_t open_filesize = get_filesize();
-
-      // make sure we do not exceed the "real" size of the file, otherwise
-      // we run into issues when accessing that memory (at least on windows)
-      ham_u32_t granularity = os_get_granularity();
-      if (open_filesize == 0 || open_filesize % granularity)
-        return;
-
-      m_mapped_size = open_filesize;
-
-      os_mmap(m_fd, &m_win32mmap, 0, m_mapped_size,
-                    (flags & HAM_READ_ONLY) != 0, &m_mmapptr);
+      m_file_size = m_allocated_size = os_get_filesize(m_fd);
     }
 
     // closes the device
     virtual void close() {
-      if (m_mmapptr)
-        os_munmap(&m_win32mmap, m_mmapptr, m_mapped_size);
+      for (std::vector<MappedRegion>::iterator it = m_regions.begin();
+              it != m_regions.end(); it++)
+        os_munmap(&it->win32mmap, it->ptr, it->size);
+      m_regions.clear();
+      m_mapped_size = 0;
+      m_mapping_failed = false;
+
+      // remove the pre-allocated space which was not used
+      if (m_allocated_size > m_file_size && !(m_flags & HAM_READ_ONLY)) {
+        try {
+          os_truncate(m_fd, m_file_size);
+        }
+        catch (Exception &) {
+          // the file is larger than required, but not corrupt
+        }
+      }
 
       os_close(m_fd);
       m_fd = HAM_INVALID_FD;
@@ -82,6 +132,17 @@ class DiskDevice : public Device {
     // truncate/resize the device
     virtual void truncate(ham_u64_t newsize) {
       os_truncate(m_fd, newsize);
+      m_file_size = m_allocated_size = newsize;
+    }
+
+    // releases the storage of an unused file area
+    virtual void punch_hole(ham_u64_t offset, ham_u64_t size) {
+      os_punch_hole(m_fd, offset, size);
+    }
+
+    // returns true if the area is part of the memory mapped region
+    virtual bool is_mapped(ham_u64_t offset, ham_u64_t size) const {
+      return (offset + size <= m_mapped_size);
     }
 
     // returns true if the device is open
@@ -89,9 +150,10 @@ class DiskDevice : public Device {
       return (HAM_INVALID_FD != m_fd);
     }
 
-    // get the current file/storage size
+    // get the current file/storage size; the pre-allocated space at the
+    // end of the file is not included
     virtual ham_u64_t get_filesize() {
-      return (os_get_filesize(m_fd));
+      return (m_file_size);
     }
 
     // seek to a position in a file
@@ -106,7 +168,7 @@ class DiskDevice : public Device {
 
     // reads from the device; this function does NOT use mmap
     virtual void read(ham_u64_t offset, void *buffer, ham_u64_t size) {
-      os_pread(m_fd, offset, buffer, size);
+      pread(offset, buffer, size);
 #ifdef HAM_ENABLE_ENCRYPTION
       if (m_env->is_encryption_enabled()) {
         AesCipher aes(m_env->get_encryption_key(), offset);
@@ -132,14 +194,21 @@ class DiskDevice : public Device {
         buffer = m_encryption_buffer.get_ptr();
       }
 #endif
-      os_pwrite(m_fd, offset, buffer, size);
+      pwrite(offset, buffer, size);
+      update_mapping(offset, (ham_u8_t *)buffer, size);
     }
 
     // writes to the device; this function does not use mmap
     virtual void writev(ham_u64_t offset, void *buffer1, ham_u64_t size1,
                     void *buffer2, ham_u64_t size2) {
+      if (m_flags & HAM_DIRECT_IO) {
+        pwrite(offset, buffer1, size1);
+        pwrite(offset + size1, buffer2, size2);
+        return;
+      }
       seek(offset, HAM_OS_SEEK_SET);
       os_writev(m_fd, buffer1, size1, buffer2, size2);
+      count_write(size1 + size2);
     }
 
     // reads a page from the device; this function CAN return a
@@ -147,24 +216,28 @@ class DiskDevice : public Device {
     virtual void read_page(Page *page) {
       // if this page is in the mapped area: return a pointer into that area.
       // otherwise fall back to read/write.
-      if (page->get_address() < m_mapped_size && m_mmapptr != 0) {
+      ham_u8_t *ptr = map_page(page->get_address());
+      if (ptr) {
         // ok, this page is mapped. If the Page object has a memory buffer:
         // free it
         ham_assert(m_env->is_encryption_enabled() == false);
-        Memory::release(page->get_data());
+        if (page->get_flags() & Page::kNpersMalloc)
+          Memory::release(page->get_data());
         page->set_flags(page->get_flags() & ~Page::kNpersMalloc);
-        page->set_data((PPageData *)&m_mmapptr[page->get_address()]);
+        page->set_data((PPageData *)ptr);
+        m_mapped_reads++;
         return;
       }
 
+      m_unmapped_reads++;
+
       // this page is not in the mapped area; allocate a buffer
       if (page->get_data() == 0) {
-        ham_u8_t *p = Memory::allocate<ham_u8_t>(m_page_size);
-        page->set_data((PPageData *)p);
+        page->set_data((PPageData *)allocate_page_buffer());
         page->set_flags(page->get_flags() | Page::kNpersMalloc);
       }
 
-      os_pread(m_fd, page->get_address(), page->get_data(), m_page_size);
+      pread(page->get_address(), page->get_data(), m_page_size);
 #ifdef HAM_ENABLE_ENCRYPTION
       if (m_env->is_encryption_enabled()) {
         AesCipher aes(m_env->get_encryption_key(), page->get_address());
@@ -182,21 +255,43 @@ class DiskDevice : public Device {
       write(page->get_address(), page->get_data(), m_page_size);
     }
 
+    // writes a batch of pages which is sorted by address (see
+    // PageManager::flush_pages); runs of adjacent pages are coalesced
+    // into a single pwritev(2) call
+    virtual void write_pages(Page **pages, ham_u32_t count) {
+      if (m_env->is_encryption_enabled()) {
+        Device::write_pages(pages, count);
+        return;
+      }
+
+      ham_u32_t max_run = std::max((ham_u32_t)1,
+                      (ham_u32_t)kMaxCoalescedWrite / m_page_size);
+      ham_u32_t i = 0;
+      while (i < count) {
+        ham_u32_t j = i + 1;
+        while (j < count && j - i < max_run
+                && pages[j]->get_address()
+                      == pages[j - 1]->get_address() + m_page_size)
+          j++;
+        write_adjacent_pages(&pages[i], j - i);
+        i = j;
+      }
+    }
+
     // allocate storage from this device; this function
     // will *NOT* return mmapped memory
     virtual ham_u64_t alloc(ham_u32_t size) {
-      ham_u64_t address = os_get_filesize(m_fd);
-      os_truncate(m_fd, address + size);
+      ham_u64_t address = m_file_size;
+      extend(address + size);
       return (address);
     }
 
     // Allocates storage for a page from this device; this function
     // will *NOT* return mmapped memory
     virtual void alloc_page(Page *page) {
-      ham_u32_t size = m_page_size;
-      ham_u64_t pos = os_get_filesize(m_fd);
+      ham_u64_t pos = m_file_size;
 
-      os_truncate(m_fd, pos + size);
+      extend(pos + m_page_size);
       page->set_address(pos);
       read_page(page);
     }
@@ -207,22 +302,340 @@ class DiskDevice : public Device {
         Memory::release(page->get_data());
         page->set_flags(page->get_flags() & ~Page::kNpersMalloc);
       }
+      // a mapped page was copied when it was modified; release the copy
+      // (the file is up to date if the page is not dirty). Only possible
+      // if no other page shares the same OS page.
+      else if (page->get_data() && !page->is_dirty()
+          && (ham_u8_t *)page->get_data() == get_mapped_ptr(page->get_address())
+          && m_page_size % os_get_granularity() == 0)
+        os_mmap_discard(page->get_data(), m_page_size);
       page->set_data(0);
     }
 
-  private:
+    // fills in the metrics
+    virtual void get_metrics(ham_env_metrics_t *metrics) const {
+      metrics->device_mapped_reads = m_mapped_reads;
+      metrics->device_unmapped_reads = m_unmapped_reads;
+      metrics->device_mapped_size = m_mapped_size;
+      metrics->device_writes = m_writes;
+      metrics->device_bytes_written = m_bytes_written;
+      metrics->device_avg_write_size = m_writes
+                      ? m_bytes_written / m_writes
+                      : 0;
+    }
+
+  protected:
+    // Writes |count| pages which are adjacent in the file with a single
+    // request
+    void write_adjacent_pages(Page **pages, ham_u32_t count) {
+      if (count == 1) {
+        write_page(pages[0]);
+        return;
+      }
+      for (ham_u32_t i = 0; i < count; i++) {
+        if (!is_aligned(pages[i]->get_address(), pages[i]->get_data(),
+                    m_page_size)) {
+          Device::write_pages(pages, count);
+          return;
+        }
+      }
+
+      std::vector<void *> buffers(count);
+      std::vector<ham_u64_t> sizes(count, m_page_size);
+      for (ham_u32_t i = 0; i < count; i++)
+        buffers[i] = pages[i]->get_data();
+
+      os_pwritev(m_fd, pages[0]->get_address(), &buffers[0], &sizes[0],
+                      count);
+      count_write((ham_u64_t)count * m_page_size);
+
+      for (ham_u32_t i = 0; i < count; i++)
+        update_mapping(pages[i]->get_address(),
+                        (ham_u8_t *)pages[i]->get_data(), m_page_size);
+    }
+
+    // Updates the write statistics
+    void count_write(ham_u64_t size) {
+      m_writes++;
+      m_bytes_written += size;
+    }
+
+    // Allocates a buffer for a page; aligned if HAM_DIRECT_IO is used
+    ham_u8_t *allocate_page_buffer() const {
+      if (m_flags & HAM_DIRECT_IO)
+        return (Memory::allocate_aligned<ham_u8_t>(m_page_size,
+                                kDirectIoAlignment));
+      return (Memory::allocate<ham_u8_t>(m_page_size));
+    }
+
+    // Returns true if a request can be sent to the file as it is, without
+    // the bounce buffer; only HAM_DIRECT_IO has restrictions
+    bool is_aligned(ham_u64_t offset, const void *buffer,
+                    ham_u64_t size) const {
+      if (!(m_flags & HAM_DIRECT_IO))
+        return (true);
+      return (offset % kDirectIoAlignment == 0
+              && size % kDirectIoAlignment == 0
+              && (size_t)buffer % kDirectIoAlignment == 0);
+    }
+
+    // Reads from the file; unaligned direct I/O requests are read through
+    // the bounce buffer
+    void pread(ham_u64_t offset, void *buffer, ham_u64_t size) {
+      if (is_aligned(offset, buffer, size)) {
+        os_pread(m_fd, offset, buffer, size);
+        return;
+      }
+
+      ham_u64_t start = offset - offset % kDirectIoAlignment;
+      ham_u64_t end = align_up(offset + size);
+      resize_bounce_buffer(end - start);
+      if (os_pread_partial(m_fd, start, m_bounce_buffer, end - start)
+              < offset + size - start) {
+        ham_log(("short read at address %llu", (unsigned long long)offset));
+        throw Exception(HAM_IO_ERROR);
+      }
+      memcpy(buffer, m_bounce_buffer + (offset - start), size);
+    }
+
+    // Writes to the file; unaligned direct I/O requests are merged with
+    // the surrounding data in the bounce buffer. Only the partially
+    // overwritten blocks at the edges are read from the file.
+    void pwrite(ham_u64_t offset, const void *buffer, ham_u64_t size) {
+      if (is_aligned(offset, buffer, size)) {
+        os_pwrite(m_fd, offset, buffer, size);
+        count_write(size);
+        return;
+      }
+
+      ham_u64_t start = offset - offset % kDirectIoAlignment;
+      ham_u64_t end = align_up(offset + size);
+      resize_bounce_buffer(end - start);
+      if (offset != start)
+        read_block(start, m_bounce_buffer);
+      if (offset + size != end && end - kDirectIoAlignment >= offset)
+        read_block(end - kDirectIoAlignment,
+                        m_bounce_buffer + (end - start - kDirectIoAlignment));
+      memcpy(m_bounce_buffer + (offset - start), buffer, size);
+      os_pwrite(m_fd, start, m_bounce_buffer, end - start);
+      count_write(end - start);
+
+      // the file grows by full blocks; the tail is trimmed in close()
+      if (end > m_allocated_size)
+        m_allocated_size = end;
+    }
+
+    // Reads an aligned block; the part beyond the end of the file is
+    // filled with zeroes
+    void read_block(ham_u64_t address, ham_u8_t *buffer) {
+      ham_u64_t r = os_pread_partial(m_fd, address, buffer,
+                      kDirectIoAlignment);
+      if (r < kDirectIoAlignment)
+        memset(buffer + r, 0, kDirectIoAlignment - r);
+    }
+
+    // Makes sure that the bounce buffer has at least |size| bytes
+    void resize_bounce_buffer(ham_u64_t size) {
+      if (size <= m_bounce_size)
+        return;
+      Memory::release(m_bounce_buffer);
+      m_bounce_buffer = 0;
+      m_bounce_size = 0;
+      m_bounce_buffer = Memory::allocate_aligned<ham_u8_t>((size_t)size,
+                      kDirectIoAlignment);
+      m_bounce_size = size;
+    }
+
+    // Rounds |size| up to the direct I/O alignment
+    static ham_u64_t align_up(ham_u64_t size) {
+      return ((size + kDirectIoAlignment - 1) / kDirectIoAlignment
+                      * kDirectIoAlignment);
+    }
+
+    // Returns a pointer to the mapped page at |address|; grows the mapping
+    // if necessary. Returns 0 if the page can not be mapped.
+    ham_u8_t *map_page(ham_u64_t address) {
+      if (m_flags & HAM_DISABLE_MMAP)
+        return (0);
+      // the mapping can exceed the file, but accessing these pages would
+      // raise SIGBUS
+      if (address + m_page_size > m_allocated_size)
+        return (0);
+      if (!is_mapped(address, m_page_size) && !grow_mapping(address))
+        return (0);
+      return (get_mapped_ptr(address));
+    }
+
+    // Returns a pointer to the mapped data at |address|, or 0 if the address
+    // is not mapped. The regions are sorted and usually few; the last one
+    // is the largest.
+    ham_u8_t *get_mapped_ptr(ham_u64_t address) const {
+      if (address >= m_mapped_size)
+        return (0);
+      for (std::vector<MappedRegion>::const_reverse_iterator it =
+              m_regions.rbegin(); it != m_regions.rend(); it++) {
+        if (address >= it->offset)
+          return (it->ptr + (address - it->offset));
+      }
+      return (0);
+    }
+
+    // Extends the mapping till it covers the page at |address|. The region
+    // boundaries are aligned to the page size and the OS granularity, so
+    // a page never spans two regions.
+    bool grow_mapping(ham_u64_t address) {
+      if (m_mapping_failed)
+        return (false);
+
+      ham_u64_t alignment = get_mapping_alignment();
+      ham_u64_t end = address + m_page_size;
+
+      // grow exponentially, but map at least the whole file
+      ham_u64_t size = std::min(m_mapped_size, (ham_u64_t)kMaxMappingGrowth);
+#ifdef WIN32
+      // win32 can not map beyond the end of the file; wait till the file
+      // has grown by another step
+      ham_u64_t limit = m_allocated_size - m_allocated_size % alignment;
+      if (limit < end || limit - m_mapped_size < size)
+        return (false);
+      size = limit - m_mapped_size;
+#else
+      // posix maps beyond the end of the file; these pages become
+      // accessible as soon as the file is extended
+      size = std::max(size, (ham_u64_t)kMinMappingGrowth);
+      size = std::max(size, end - m_mapped_size);
+      if (m_allocated_size > m_mapped_size)
+        size = std::max(size, m_allocated_size - m_mapped_size);
+      size += alignment - 1;
+      size -= size % alignment;
+#endif
+
+      try {
+        if (!m_regions.empty()) {
+          MappedRegion &last = m_regions.back();
+          if (os_mremap(&last.win32mmap, last.ptr, last.size,
+                      last.size + size)) {
+            last.size += size;
+            m_mapped_size += size;
+            return (true);
+          }
+        }
+
+        MappedRegion region;
+        region.offset = m_mapped_size;
+        region.size = size;
+        region.ptr = 0;
+        region.win32mmap = HAM_INVALID_FD;
+        os_mmap(m_fd, &region.win32mmap, region.offset, region.size,
+                    (m_flags & HAM_READ_ONLY) != 0, &region.ptr);
+        m_regions.push_back(region);
+        m_mapped_size += size;
+        return (true);
+      }
+      catch (Exception &) {
+        // i.e. out of address space; continue with read/write
+        m_mapping_failed = true;
+        return (false);
+      }
+    }
+
+    // Makes a mapped area consistent with data which was written to the file.
+    // The mapping is private; a copy which was created when the area was
+    // modified would otherwise hide the new file contents.
+    void update_mapping(ham_u64_t offset, ham_u8_t *buffer, ham_u64_t size) {
+      ham_u8_t *ptr = get_mapped_ptr(offset);
+      // nothing to do if this was a mapped page which was flushed
+      if (!ptr || ptr == buffer)
+        return;
+      // writes are limited to a single page and therefore to a single region
+      ham_assert(offset + size <= m_mapped_size);
+      ham_assert(get_mapped_ptr(offset + size - 1) == ptr + size - 1);
+
+      // copy the partial OS pages; discard the copies of the full OS pages
+      ham_u64_t granularity = os_get_granularity();
+      ham_u64_t start = offset + granularity - 1;
+      start -= start % granularity;
+      ham_u64_t end = offset + size;
+      end -= end % granularity;
+      if (start >= end) {
+        memcpy(ptr, buffer, size);
+        return;
+      }
+      memcpy(ptr, buffer, start - offset);
+      os_mmap_discard(ptr + (start - offset), end - start);
+      memcpy(ptr + (end - offset), buffer + (end - offset),
+                      offset + size - end);
+    }
+
+    // Returns the alignment of the mapped regions: the least common multiple
+    // of the page size and the OS granularity
+    ham_u64_t get_mapping_alignment() const {
+      ham_u64_t a = os_get_granularity();
+      ham_u64_t b = m_page_size;
+      while (b) {
+        ham_u64_t t = a % b;
+        a = b;
+        b = t;
+      }
+      return ((ham_u64_t)os_get_granularity() / a * m_page_size);
+    }
+
+    // Extends the file to |newsize| bytes. If a growth size was set then
+    // the file is extended (and pre-allocated) in steps of this size, and
+    // the unused space is handed out by the following calls
+    void extend(ham_u64_t newsize) {
+      if (newsize > m_allocated_size) {
+        ham_u64_t size = newsize;
+        if (m_growth_size) {
+          size = std::max(newsize, m_allocated_size + m_growth_size);
+          size += m_page_size - 1;
+          size -= size % m_page_size;
+          os_allocate(m_fd, m_allocated_size, size);
+        }
+        else
+          os_truncate(m_fd, size);
+        m_allocated_size = size;
+      }
+      m_file_size = newsize;
+    }
+
     // the file handle
     ham_fd_t m_fd;
 
-    // the win32 mmap handle
-    ham_fd_t m_win32mmap;
-
-    // pointer to the the mmapped data
-    ham_u8_t *m_mmapptr;
+    // the memory mapped regions, sorted by offset
+    std::vector<MappedRegion> m_regions;
 
-    // the size of m_mmapptr as used in os_mmap
+    // the size of the mapped area; the regions are contiguous and start
+    // at offset 0
     ham_u64_t m_mapped_size;
 
+    // true if mapping failed; then read/write is used
+    bool m_mapping_failed;
+
+    // number of pages read from the mapped area
+    ham_u64_t m_mapped_reads;
+
+    // number of pages read with read(2)
+    ham_u64_t m_unmapped_reads;
+
+    // the size of the file which is used by the Environment
+    ham_u64_t m_file_size;
+
+    // the size of the file, including the pre-allocated space
+    ham_u64_t m_allocated_size;
+
+    // aligned buffer for unaligned direct I/O requests
+    ham_u8_t *m_bounce_buffer;
+
+    // the size of m_bounce_buffer
+    ham_u64_t m_bounce_size;
+
+    // number of write requests
+    ham_u64_t m_writes;
+
+    // number of bytes written
+    ham_u64_t m_bytes_written;
+
     // dynamic byte array providing temporary space for encryption
     ByteArray m_encryption_buffer;
 };
@@ -15,6 +15,7 @@
 
 #include <ham/types.h>
 #include "device_disk.h"
+#include "device_async.h"
 #include "device_inmem.h"
 
 namespace hamsterdb {
@@ -25,6 +26,8 @@ class DeviceFactory {
     static Device *create(LocalEnvironment *env, ham_u32_t flags) {
       if (flags & HAM_IN_MEMORY)
         return (new InMemoryDevice(env, flags));
+      else if (env->get_io_backend() != HAM_IO_BACKEND_SYNC)
+        return (new AsyncDiskDevice(env, flags, env->get_io_backend()));
       else
         return (new DiskDevice(env, flags));
     }
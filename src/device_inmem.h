@@ -56,6 +56,15 @@ class InMemoryDevice : public Device {
     virtual void truncate(ham_u64_t newsize) {
     }
 
+    // releases the storage of an unused area; not supported
+    virtual void punch_hole(ham_u64_t offset, ham_u64_t size) {
+    }
+
+    // returns true if the area is memory mapped; always false
+    virtual bool is_mapped(ham_u64_t offset, ham_u64_t size) const {
+      return (false);
+    }
+
     // returns true if the device is open 
     virtual bool is_open() {
       return (m_is_open);
@@ -124,6 +124,19 @@ class Environment
     // Flushes the environment and its databases to disk (ham_env_flush)
     virtual ham_status_t flush(ham_u32_t flags) = 0;
 
+    // Flushes the journal of the committed Transactions to disk; does
+    // not write the cache (ham_env_sync)
+    virtual ham_status_t sync(ham_u32_t flags) {
+      return (HAM_NOT_IMPLEMENTED);
+    }
+
+    // Moves pages and blobs from the end of the file to free space, then
+    // truncates the file (ham_env_compact)
+    virtual ham_status_t compact(ham_u32_t max_pages, ham_u64_t *reclaimed,
+                    ham_u32_t flags) {
+      return (HAM_NOT_IMPLEMENTED);
+    }
+
     // Creates a new database in the environment (ham_env_create_db)
     virtual ham_status_t create_db(Database **db, ham_u16_t dbname,
                     ham_u32_t flags, const ham_parameter_t *param) = 0;
@@ -142,6 +155,11 @@ class Environment
     // Commits a transaction (ham_txn_commit)
     virtual ham_status_t txn_commit(Transaction *txn, ham_u32_t flags) = 0;
 
+    // Waits till the committed Transactions are durable (group commit);
+    // called by ham_txn_commit after the mutex was released. |start| is
+    // the time (os_get_microseconds) when ham_txn_commit was called
+    virtual void sync_commit(ham_u64_t start) { }
+
     // Closes the Environment (ham_env_close)
     virtual ham_status_t close(ham_u32_t flags) = 0;
 
@@ -42,8 +42,8 @@ typedef HAM_PACK_0 struct HAM_PACK_1
   /** maximum number of databases for this environment */
   ham_u16_t _max_databases;
 
-  /** reserved */
-  ham_u16_t _reserved1;
+  /** the freelist implementation (HAM_FREELIST_BITMAP, HAM_FREELIST_EXTENT) */
+  ham_u16_t _freelist_type;
 
   /*
    * following here:
@@ -127,6 +127,16 @@ class EnvironmentHeader
       get_header()->_max_databases = md;
     }
 
+    // Returns the freelist type (HAM_FREELIST_BITMAP or HAM_FREELIST_EXTENT)
+    ham_u16_t get_freelist_type() {
+      return (ham_db2h16(get_header()->_freelist_type));
+    }
+
+    // Sets the freelist type
+    void set_freelist_type(ham_u16_t type) {
+      get_header()->_freelist_type = ham_h2db16(type);
+    }
+
     // Returns the page size from the header page
     ham_u32_t get_page_size() {
       return (ham_db2h32(get_header()->_page_size));
@@ -23,6 +23,7 @@
 #include "mem.h"
 #include "cursor.h"
 #include "txn_cursor.h"
+#include "freelist_bitmap.h"
 #include "page_manager.h"
 #include "log.h"
 #include "journal.h"
@@ -61,8 +62,14 @@ LocalEnvironment::get_freelist_payload(ham_u32_t *psize)
 LocalEnvironment::LocalEnvironment()
   : Environment(), m_header(0), m_device(0), m_changeset(this),
     m_blob_manager(0), m_page_manager(0), m_log(0),
-    m_journal(0), m_txn_id(0), m_encryption_enabled(false), m_page_size(0)
+    m_journal(0), m_txn_id(0), m_encryption_enabled(false), m_page_size(0),
+    m_freelist_type(HAM_FREELIST_BITMAP), m_file_growth_size(0),
+    m_io_backend(HAM_IO_BACKEND_SYNC), m_group_commit_delay(0),
+    m_group_commit_size(0), m_journal_sync_interval(0),
+    m_txn_flush_limit(0), m_committed_txn_size(0), m_flusher(0),
+    m_flusher_pending(false), m_flusher_shutdown(false)
 {
+  memset(m_commit_latency, 0, sizeof(m_commit_latency));
 }
 
 LocalEnvironment::~LocalEnvironment()
@@ -85,6 +92,7 @@ LocalEnvironment::create(const char *filename, ham_u32_t flags,
   m_blob_manager = BlobManagerFactory::create(this, flags);
   m_device = DeviceFactory::create(this, flags);
   m_device->set_page_size(m_page_size);
+  m_device->set_growth_size(m_file_growth_size);
 
   /* create the file */
   m_device->create(filename, flags, mode);
@@ -107,6 +115,7 @@ LocalEnvironment::create(const char *filename, ham_u32_t flags,
     m_header->set_serialno(HAM_SERIALNO);
     m_header->set_page_size(m_page_size);
     m_header->set_max_databases(max_databases);
+    m_header->set_freelist_type((ham_u16_t)m_freelist_type);
 
     page->set_dirty(true);
   }
@@ -141,6 +150,7 @@ LocalEnvironment::open(const char *filename, ham_u32_t flags,
   m_blob_manager = BlobManagerFactory::create(this, flags);
   m_device = DeviceFactory::create(this, flags);
   m_device->set_page_size(m_page_size);
+  m_device->set_growth_size(m_file_growth_size);
 
   if (filename)
     m_filename = filename;
@@ -382,7 +392,8 @@ LocalEnvironment::close(ham_u32_t flags)
   ham_status_t st;
   Device *device = get_device();
 
-  /* flush all committed transactions */
+  /* stop the background thread, then flush all committed transactions */
+  stop_flusher();
   flush_committed_txns();
 
   /* close all databases */
@@ -398,7 +409,9 @@ LocalEnvironment::close(ham_u32_t flags)
       return (st);
   }
 
-  /* flush all committed transactions */
+  /* flush all committed transactions; closing the databases can
+   * restart the background thread */
+  stop_flusher();
   flush_committed_txns();
 
   /* flush all pages and the freelist, reduce the file size */
@@ -484,6 +497,27 @@ LocalEnvironment::get_parameters(ham_parameter_t *param)
       case HAM_PARAM_MAX_DATABASES:
         p->value = m_header->get_max_databases();
         break;
+      case HAM_PARAM_FREELIST_TYPE:
+        p->value = get_freelist_type();
+        break;
+      case HAM_PARAM_FILE_GROWTH_SIZE:
+        p->value = get_file_growth_size();
+        break;
+      case HAM_PARAM_IO_BACKEND:
+        p->value = get_io_backend();
+        break;
+      case HAM_PARAM_GROUP_COMMIT_DELAY:
+        p->value = get_group_commit_delay();
+        break;
+      case HAM_PARAM_GROUP_COMMIT_SIZE:
+        p->value = get_group_commit_size();
+        break;
+      case HAM_PARAM_JOURNAL_SYNC_INTERVAL:
+        p->value = get_journal_sync_interval();
+        break;
+      case HAM_PARAM_TXN_FLUSH_LIMIT:
+        p->value = get_txn_flush_limit();
+        break;
       case HAM_PARAM_FLAGS:
         p->value = get_flags();
         break;
@@ -537,6 +571,108 @@ LocalEnvironment::flush(ham_u32_t flags)
   return (HAM_SUCCESS);
 }
 
+ham_status_t
+LocalEnvironment::sync(ham_u32_t flags)
+{
+  /* never flush an in-memory-database */
+  if (get_flags() & HAM_IN_MEMORY)
+    return (0);
+
+  /* the journal stores all committed Transactions; without journal,
+   * flush the file */
+  if (m_journal)
+    m_journal->sync_commits();
+  else
+    get_device()->flush();
+
+  return (0);
+}
+
+ham_status_t
+LocalEnvironment::compact(ham_u32_t max_pages, ham_u64_t *reclaimed,
+                ham_u32_t flags)
+{
+  *reclaimed = 0;
+
+  /* an in-memory-database does not have a file */
+  if (get_flags() & HAM_IN_MEMORY)
+    return (0);
+
+  if (get_flags() & HAM_READ_ONLY) {
+    ham_trace(("cannot compact a read-only environment"));
+    return (HAM_WRITE_PROTECTED);
+  }
+
+  /* everything at or above the threshold is moved; the header page
+   * is never moved */
+  ham_u32_t page_size = get_page_size();
+  ham_u64_t filesize = m_device->get_filesize();
+  ham_u64_t window = (ham_u64_t)max_pages * page_size;
+  ham_u64_t threshold = filesize > window + page_size
+                            ? filesize - window
+                            : page_size;
+
+  /* move the pages and blobs of each Database; Databases which are not
+   * open are loaded temporarily */
+  for (ham_u16_t dbi = 0; dbi < m_header->get_max_databases(); dbi++) {
+    ham_u16_t name = get_btree_descriptor(dbi)->get_dbname();
+    if (name == 0)
+      continue;
+
+    LocalDatabase *db;
+    Environment::DatabaseMap::iterator it = get_database_map().find(name);
+    bool temporary = (it == get_database_map().end());
+    if (temporary) {
+      ham_status_t st = open_db((Database **)&db, name, 0, 0);
+      if (st)
+        return (st);
+    }
+    else
+      db = (LocalDatabase *)it->second;
+
+    try {
+      db->get_btree_index()->compact(threshold);
+
+      /* if logging is enabled: flush the changeset, the modified pages
+       * are written to the log before they're written to the file */
+      if (get_flags() & HAM_ENABLE_RECOVERY && !get_changeset().is_empty())
+        get_changeset().flush(get_incremented_lsn());
+    }
+    catch (Exception &ex) {
+      if (temporary)
+        (void)ham_db_close((ham_db_t *)db, HAM_DONT_LOCK);
+      return (ex.code);
+    }
+
+    if (temporary)
+      (void)ham_db_close((ham_db_t *)db, HAM_DONT_LOCK);
+  }
+
+  /* now truncate the free pages at the end of the file */
+  bool try_reclaim = get_flags() & HAM_DISABLE_RECLAIM_INTERNAL
+                ? false
+                : true;
+#ifdef WIN32
+  /* Win32: it's not possible to truncate the file while there's an active
+   * mapping */
+  if (!(get_flags() & HAM_DISABLE_MMAP))
+    try_reclaim = false;
+#endif
+  if (try_reclaim)
+    *reclaimed = get_page_manager()->reclaim_space(true);
+
+  /* the pages which could not be truncated are released with
+   * a hole in the file */
+  if (flags & HAM_COMPACT_PUNCH_HOLES)
+    get_page_manager()->punch_holes(threshold, filesize - *reclaimed);
+
+  /* the freelist was modified */
+  if (get_flags() & HAM_ENABLE_RECOVERY && !get_changeset().is_empty())
+    get_changeset().flush(get_incremented_lsn());
+
+  return (0);
+}
+
 ham_status_t
 LocalEnvironment::create_db(Database **pdb, ham_u16_t dbname,
     ham_u32_t flags, const ham_parameter_t *param)
@@ -780,6 +916,28 @@ LocalEnvironment::txn_commit(Transaction *txn, ham_u32_t flags)
   return (0);
 }
 
+void
+LocalEnvironment::sync_commit(ham_u64_t start)
+{
+  /* the journal is flushed by the first waiting thread (the "leader")
+   * for all commits which were appended so far. If a sync interval is
+   * set then the journal is flushed in the background, and the commit
+   * returns immediately */
+  if (m_journal && get_flags() & HAM_ENABLE_FSYNC
+      && !get_journal_sync_interval())
+    m_journal->sync_commits();
+
+  /* update the latency histogram */
+  ham_u64_t latency = os_get_microseconds() - start;
+  int bucket = 0;
+  for (latency >>= 4; latency && bucket < HAM_COMMIT_LATENCY_BUCKETS - 1;
+          latency >>= 1)
+    bucket++;
+
+  ScopedLock lock(m_commit_latency_mutex);
+  m_commit_latency[bucket]++;
+}
+
 ham_status_t
 LocalEnvironment::txn_abort(Transaction *txn, ham_u32_t flags)
 {
@@ -877,10 +1035,33 @@ LocalEnvironment::get_metrics(ham_env_metrics_t *metrics) const
 {
   // PageManager metrics (incl. cache and freelist)
   m_page_manager->get_metrics(metrics);
+  // the Device
+  m_device->get_metrics(metrics);
   // the BlobManagers
   m_blob_manager->get_metrics(metrics);
   // and of the btrees
   BtreeIndex::get_metrics(metrics);
+  // the journal
+  if (m_journal)
+    m_journal->get_metrics(metrics);
+  // and the commit latencies
+  ScopedLock lock(m_commit_latency_mutex);
+  memcpy(metrics->txn_commit_latency, m_commit_latency,
+          sizeof(m_commit_latency));
+}
+
+/* returns the (approximate) memory of a transaction's operations */
+static ham_u64_t
+__get_txn_size(Transaction *txn)
+{
+  ham_u64_t size = 0;
+  TransactionOperation *op = txn->get_oldest_op();
+  while (op) {
+    size += sizeof(TransactionOperation) + op->get_record()->size
+            + op->get_node()->get_key()->size;
+    op = op->get_next_in_txn();
+  }
+  return (size);
 }
 
 void
@@ -896,6 +1077,12 @@ LocalEnvironment::flush_committed_txns()
       if (last_id)
         ham_assert(last_id != oldest->get_id());
       last_id = oldest->get_id();
+      if (m_txn_flush_limit) {
+        ham_u64_t size = __get_txn_size(oldest);
+        m_committed_txn_size = size < m_committed_txn_size
+                ? m_committed_txn_size - size
+                : 0;
+      }
       flush_txn(oldest);
     }
     else if (oldest->is_aborted()) {
@@ -916,6 +1103,86 @@ LocalEnvironment::flush_committed_txns()
   get_changeset().clear();
 }
 
+void
+LocalEnvironment::signal_commit(Transaction *txn)
+{
+  /* without a background thread the transaction is flushed immediately;
+   * the same is done if the committed transactions exceed the memory
+   * limit, otherwise the committing threads would outpace the flusher */
+  if (m_txn_flush_limit) {
+    m_committed_txn_size += __get_txn_size(txn);
+    if (m_committed_txn_size <= m_txn_flush_limit) {
+      ScopedLock lock(m_flusher_mutex);
+      if (!m_flusher)
+        start_flusher();
+      m_flusher_pending = true;
+      m_flusher_cond.notify_one();
+      return;
+    }
+  }
+
+  flush_committed_txns();
+}
+
+void
+LocalEnvironment::start_flusher()
+{
+  m_flusher_shutdown = false;
+  m_flusher = new Thread(&LocalEnvironment::run_flusher, this);
+}
+
+void
+LocalEnvironment::stop_flusher()
+{
+  if (!m_flusher)
+    return;
+
+  {
+    ScopedLock lock(m_flusher_mutex);
+    m_flusher_shutdown = true;
+    m_flusher_cond.notify_all();
+  }
+
+  m_flusher->join();
+  delete m_flusher;
+  m_flusher = 0;
+  m_flusher_pending = false;
+}
+
+void
+LocalEnvironment::run_flusher()
+{
+  ScopedLock lock(m_flusher_mutex);
+  while (!m_flusher_shutdown) {
+    if (!m_flusher_pending) {
+      m_flusher_cond.wait(lock);
+      continue;
+    }
+
+    /* the Environment is locked while it's closed, and stop_flusher()
+     * then waits for this thread; therefore do not block on the
+     * Environment's mutex, but retry a bit later */
+    ScopedLock env_lock(m_mutex, boost::try_to_lock);
+    if (!env_lock.owns_lock()) {
+      m_flusher_cond.timed_wait(lock, boost::posix_time::milliseconds(1));
+      continue;
+    }
+
+    m_flusher_pending = false;
+    lock.unlock();
+    try {
+      flush_committed_txns();
+    }
+    catch (Exception &ex) {
+      /* the transactions are flushed again when the Environment is
+       * flushed or closed */
+      ham_log(("failed to flush committed transactions: %d", ex.code));
+    }
+    env_lock.unlock();
+    lock.lock();
+  }
+}
+
 void
 LocalEnvironment::flush_txn(Transaction *txn)
 {
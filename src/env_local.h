@@ -142,6 +142,76 @@ class LocalEnvironment : public Environment
       m_log_directory = dir;
     }
 
+    // Returns the freelist type (HAM_FREELIST_BITMAP or HAM_FREELIST_EXTENT)
+    ham_u32_t get_freelist_type() {
+      return (m_header ? m_header->get_freelist_type() : m_freelist_type);
+    }
+
+    // Sets the freelist type; only used when the Environment is created
+    void set_freelist_type(ham_u32_t type) {
+      m_freelist_type = type;
+    }
+
+    // Returns the size of the steps in which the file is extended
+    ham_u64_t get_file_growth_size() const {
+      return (m_file_growth_size);
+    }
+
+    // Sets the size of the steps in which the file is extended
+    void set_file_growth_size(ham_u64_t size) {
+      m_file_growth_size = size;
+    }
+
+    // Returns the I/O backend (HAM_IO_BACKEND_SYNC, HAM_IO_BACKEND_ASYNC
+    // or HAM_IO_BACKEND_THREADS)
+    ham_u32_t get_io_backend() const {
+      return (m_io_backend);
+    }
+
+    // Sets the I/O backend; used when the Device is created
+    void set_io_backend(ham_u32_t backend) {
+      m_io_backend = backend;
+    }
+
+    // Returns the maximum delay (in microseconds) of a group commit
+    ham_u32_t get_group_commit_delay() const {
+      return (m_group_commit_delay);
+    }
+
+    // Returns the maximum number of commits in a group (0: no limit)
+    ham_u32_t get_group_commit_size() const {
+      return (m_group_commit_size);
+    }
+
+    // Sets the group commit parameters
+    void set_group_commit(ham_u32_t delay, ham_u32_t size) {
+      m_group_commit_delay = delay;
+      m_group_commit_size = size;
+    }
+
+    // Returns the interval (in milliseconds) in which the journal is
+    // flushed by a background thread (0: flushed by ham_txn_commit)
+    ham_u32_t get_journal_sync_interval() const {
+      return (m_journal_sync_interval);
+    }
+
+    // Sets the interval in which the journal is flushed
+    void set_journal_sync_interval(ham_u32_t interval) {
+      m_journal_sync_interval = interval;
+    }
+
+    // Returns the memory limit (in bytes) of committed Transactions which
+    // are merged by a background thread (0: merged by ham_txn_commit)
+    ham_u64_t get_txn_flush_limit() const {
+      return (m_txn_flush_limit);
+    }
+
+    // Sets the memory limit of committed Transactions which are merged
+    // in the background
+    void set_txn_flush_limit(ham_u64_t limit) {
+      m_txn_flush_limit = limit;
+    }
+
     // Enables AES encryption
     void enable_encryption(const ham_u8_t *key) {
       m_encryption_enabled = true;
@@ -184,6 +254,14 @@ class LocalEnvironment : public Environment
     // Flushes the environment and its databases to disk (ham_env_flush)
     virtual ham_status_t flush(ham_u32_t flags);
 
+    // Flushes the journal of the committed Transactions (ham_env_sync)
+    virtual ham_status_t sync(ham_u32_t flags);
+
+    // Moves pages and blobs from the end of the file to free space, then
+    // truncates the file (ham_env_compact)
+    virtual ham_status_t compact(ham_u32_t max_pages, ham_u64_t *reclaimed,
+                    ham_u32_t flags);
+
     // Creates a new database in the environment (ham_env_create_db)
     virtual ham_status_t create_db(Database **db, ham_u16_t dbname,
                     ham_u32_t flags, const ham_parameter_t *param);
@@ -202,6 +280,9 @@ class LocalEnvironment : public Environment
     // Commits a transaction (ham_txn_commit)
     virtual ham_status_t txn_commit(Transaction *txn, ham_u32_t flags);
 
+    // Waits till the journal of the committed Transactions is flushed
+    virtual void sync_commit(ham_u64_t start);
+
     // Closes the Environment (ham_env_close)
     virtual ham_status_t close(ham_u32_t flags);
 
@@ -211,7 +292,20 @@ class LocalEnvironment : public Environment
     // Flushes all committed transactions to disk
     void flush_committed_txns();
 
+    // Called by Transaction::commit; flushes the committed transactions,
+    // or hands them to the background thread
+    void signal_commit(Transaction *txn);
+
   private:
+    // Starts the background thread which flushes committed transactions
+    void start_flusher();
+
+    // Stops the background thread
+    void stop_flusher();
+
+    // The main loop of the background thread
+    void run_flusher();
+
     // Flushes a single, committed transaction to disk
     void flush_txn(Transaction *txn);
 
@@ -254,6 +348,54 @@ class LocalEnvironment : public Environment
 
     // The page_size which was specified when the env was created
     ham_u32_t m_page_size;
+
+    // The freelist type which was specified when the env was created
+    ham_u32_t m_freelist_type;
+
+    // The file is extended in steps of this size (0: page by page)
+    ham_u64_t m_file_growth_size;
+
+    // The I/O backend of the Device
+    ham_u32_t m_io_backend;
+
+    // The maximum delay (in microseconds) of a group commit
+    ham_u32_t m_group_commit_delay;
+
+    // The maximum number of commits in a group (0: no limit)
+    ham_u32_t m_group_commit_size;
+
+    // The interval (in milliseconds) in which the journal is flushed by a
+    // background thread (0: flushed by ham_txn_commit)
+    ham_u32_t m_journal_sync_interval;
+
+    // Protects the commit latency histogram; it is updated without
+    // holding the Environment's mutex
+    mutable Mutex m_commit_latency_mutex;
+
+    // The commit latency histogram (see ham_env_metrics_t)
+    ham_u64_t m_commit_latency[HAM_COMMIT_LATENCY_BUCKETS];
+
+    // The memory limit (in bytes) of committed Transactions which are
+    // flushed by a background thread (0: flushed by ham_txn_commit)
+    ham_u64_t m_txn_flush_limit;
+
+    // The memory of the committed Transactions which are not yet flushed
+    ham_u64_t m_committed_txn_size;
+
+    // The background thread which flushes the committed Transactions
+    Thread *m_flusher;
+
+    // Protects the state of the background thread
+    Mutex m_flusher_mutex;
+
+    // Wakes up the background thread
+    Condition m_flusher_cond;
+
+    // Set to true if there are committed Transactions to flush
+    bool m_flusher_pending;
+
+    // Set to true to stop the background thread
+    bool m_flusher_shutdown;
 };
 
 } // namespace hamsterdb
@@ -21,7 +21,7 @@
 #include "endianswap.h"
 #include "env.h"
 #include "error.h"
-#include "freelist.h"
+#include "freelist_bitmap.h"
 #include "page_manager.h"
 #include "mem.h"
 #include "btree_stats.h"
@@ -439,13 +439,13 @@ BITSCAN_LSBit8(ham_u8_t v, ham_u32_t pos)
 }
 
 void
-Freelist::free_page(Page *page)
+BitmapFreelist::free_page(Page *page)
 {
   free_area(page->get_address(), m_env->get_page_size());
 }
 
 void
-Freelist::free_area(ham_u64_t address, ham_u32_t size)
+BitmapFreelist::free_area(ham_u64_t address, ham_u32_t size)
 {
   Page *page = 0;
 
@@ -502,13 +502,13 @@ Freelist::free_area(ham_u64_t address, ham_u32_t size)
 }
 
 ham_u64_t
-Freelist::alloc_page()
+BitmapFreelist::alloc_page()
 {
   return (alloc_area_impl(m_env->get_page_size(), true, 0));
 }
 
 ham_u64_t
-Freelist::alloc_area_impl(ham_u32_t size, bool aligned,
+BitmapFreelist::alloc_area_impl(ham_u32_t size, bool aligned,
                 ham_u64_t lower_bound_address)
 {
   FreelistEntry *entry = NULL;
@@ -763,7 +763,7 @@ Freelist::alloc_area_impl(ham_u32_t size, bool aligned,
 }
 
 bool
-Freelist::is_page_free(ham_u64_t address)
+BitmapFreelist::is_page_free(ham_u64_t address)
 {
   ham_u32_t page_size = m_env->get_page_size();
   ham_u32_t size_bits = page_size / kBlobAlignment;
@@ -810,7 +810,7 @@ Freelist::is_page_free(ham_u64_t address)
 }
 
 void
-Freelist::truncate_page(ham_u64_t address)
+BitmapFreelist::truncate_page(ham_u64_t address)
 {
   ham_u32_t page_size = m_env->get_page_size();
   ham_u32_t size_bits = page_size / kBlobAlignment;
@@ -857,7 +857,7 @@ Freelist::truncate_page(ham_u64_t address)
 }
 
 ham_s32_t
-Freelist::search_bits(FreelistEntry *entry, PFreelistPayload *f,
+BitmapFreelist::search_bits(FreelistEntry *entry, PFreelistPayload *f,
         ham_u32_t size_bits, FreelistStatistics::Hints *hints)
 {
   ham_assert(hints->cost == 1);
@@ -2467,7 +2467,7 @@ Freelist::search_bits(FreelistEntry *entry, PFreelistPayload *f,
 }
 
 ham_s32_t
-Freelist::locate_sufficient_free_space(FreelistStatistics::Hints *dst,
+BitmapFreelist::locate_sufficient_free_space(FreelistStatistics::Hints *dst,
         FreelistStatistics::GlobalHints *hints, ham_s32_t start_index)
 {
   FreelistEntry *entry;
@@ -2677,7 +2677,7 @@ Freelist::locate_sufficient_free_space(FreelistStatistics::Hints *dst,
 }
 
 void
-Freelist::initialize()
+BitmapFreelist::initialize()
 {
   FreelistEntry entry = {0};
 
@@ -2716,7 +2716,7 @@ Freelist::initialize()
 }
 
 FreelistEntry *
-Freelist::get_entry_for_address(ham_u64_t address)
+BitmapFreelist::get_entry_for_address(ham_u64_t address)
 {
   ham_u32_t i;
 
@@ -2752,7 +2752,7 @@ Freelist::get_entry_for_address(ham_u64_t address)
 }
 
 ham_u32_t
-Freelist::get_entry_maxspan()
+BitmapFreelist::get_entry_maxspan()
 {
   ham_u32_t size = m_env->get_usable_page_size()
           - PFreelistPayload::get_bitmap_offset();
@@ -2765,7 +2765,7 @@ Freelist::get_entry_maxspan()
 }
 
 void
-Freelist::resize(ham_u32_t new_count)
+BitmapFreelist::resize(ham_u32_t new_count)
 {
   ham_u32_t size_bits = get_entry_maxspan();
   ham_assert(((size_bits / 8) % sizeof(ham_u64_t)) == 0);
@@ -2785,7 +2785,7 @@ Freelist::resize(ham_u32_t new_count)
 }
 
 Page *
-Freelist::alloc_freelist_page(FreelistEntry *entry)
+BitmapFreelist::alloc_freelist_page(FreelistEntry *entry)
 {
   FreelistEntry *entries = &m_entries[0];
   PFreelistPayload *fp;
@@ -2853,7 +2853,7 @@ Freelist::alloc_freelist_page(FreelistEntry *entry)
 }
 
 ham_u32_t
-Freelist::set_bits(FreelistEntry *entry, PFreelistPayload *fp,
+BitmapFreelist::set_bits(FreelistEntry *entry, PFreelistPayload *fp,
             ham_u32_t start_bit, ham_u32_t size_bits,
             bool set, FreelistStatistics::Hints *hints)
 {
@@ -2944,7 +2944,7 @@ Freelist::set_bits(FreelistEntry *entry, PFreelistPayload *fp,
 }
 
 ham_u32_t
-Freelist::check_bits(FreelistEntry *entry, PFreelistPayload *fp,
+BitmapFreelist::check_bits(FreelistEntry *entry, PFreelistPayload *fp,
             ham_u32_t start_bit, ham_u32_t size_bits)
 {
   ham_u32_t i;
@@ -3004,7 +3004,7 @@ Freelist::check_bits(FreelistEntry *entry, PFreelistPayload *fp,
 }
 
 void
-Freelist::mark_dirty(Page *page)
+BitmapFreelist::mark_dirty(Page *page)
 {
   if (!page)
     m_env->mark_header_page_dirty();
@@ -3013,7 +3013,7 @@ Freelist::mark_dirty(Page *page)
 }
 
 void
-Freelist::get_metrics(ham_env_metrics_t *metrics) const
+BitmapFreelist::get_metrics(ham_env_metrics_t *metrics) const
 {
   metrics->freelist_hits = m_count_hits;
   metrics->freelist_misses = m_count_misses;
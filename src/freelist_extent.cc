@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2005-2013 Christoph Rupp (chris@crupp.de).
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * See files COPYING.* for License information.
+ */
+
+#include "config.h"
+
+#include <vector>
+
+#include "env_local.h"
+#include "error.h"
+#include "freelist_bitmap.h"
+#include "freelist_extent.h"
+#include "page_manager.h"
+
+namespace hamsterdb {
+
+void
+ExtentFreelist::free_page(Page *page)
+{
+  free_area(page->get_address(), m_env->get_page_size());
+}
+
+void
+ExtentFreelist::free_area(ham_u64_t address, ham_u32_t size)
+{
+  ham_assert(size % kBlobAlignment == 0);
+  ham_assert(address % kBlobAlignment == 0);
+
+  initialize();
+  add_extent(address, size);
+}
+
+ham_u64_t
+ExtentFreelist::alloc_page()
+{
+  ham_u64_t page_size = m_env->get_page_size();
+
+  initialize();
+
+  /* walk through all extents which are large enough (smallest first) till
+   * one of them contains a page-aligned page. Extents with 2 * page_size
+   * bytes (or more) always do, therefore the loop is usually very short */
+  SizeIndex::iterator it = m_by_size.lower_bound(std::make_pair(page_size,
+                          (ham_u64_t)0));
+  for (; it != m_by_size.end(); ++it) {
+    ham_u64_t address = it->second;
+    ham_u64_t aligned = address + page_size - 1;
+    aligned -= aligned % page_size;
+    if (aligned + page_size <= address + it->first) {
+      allocate_from(m_by_address.find(address), aligned, page_size);
+      m_count_hits++;
+      return (aligned);
+    }
+  }
+
+  m_count_misses++;
+  return (0);
+}
+
+ham_u64_t
+ExtentFreelist::alloc_area(ham_u32_t size)
+{
+  ham_assert(size % kBlobAlignment == 0);
+
+  initialize();
+
+  /* best fit: the smallest extent which is large enough */
+  SizeIndex::iterator it = m_by_size.lower_bound(std::make_pair(
+                          (ham_u64_t)size, (ham_u64_t)0));
+  if (it == m_by_size.end()) {
+    m_count_misses++;
+    return (0);
+  }
+
+  ham_u64_t address = it->second;
+  allocate_from(m_by_address.find(address), address, size);
+  m_count_hits++;
+  return (address);
+}
+
+void
+ExtentFreelist::truncate_page(ham_u64_t address)
+{
+  ham_u32_t page_size = m_env->get_page_size();
+  ham_assert(address % page_size == 0);
+
+  initialize();
+
+  AddressIndex::iterator it = find_extent(address, page_size);
+  ham_assert(it != m_by_address.end());
+  if (it != m_by_address.end())
+    allocate_from(it, address, page_size);
+}
+
+bool
+ExtentFreelist::is_page_free(ham_u64_t address)
+{
+  ham_u32_t page_size = m_env->get_page_size();
+  ham_assert(address % page_size == 0);
+
+  initialize();
+
+  return (find_extent(address, page_size) != m_by_address.end());
+}
+
+void
+ExtentFreelist::get_metrics(ham_env_metrics_t *metrics) const
+{
+  metrics->freelist_hits = m_count_hits;
+  metrics->freelist_misses = m_count_misses;
+}
+
+ham_u64_t
+ExtentFreelist::get_free_bytes()
+{
+  ham_u64_t total = 0;
+
+  initialize();
+
+  for (AddressIndex::iterator it = m_by_address.begin();
+          it != m_by_address.end(); ++it)
+    total += it->second;
+  return (total);
+}
+
+void
+ExtentFreelist::close()
+{
+  /* the list was never loaded - the persisted copy is still valid */
+  if (!m_initialized)
+    return;
+
+  PageManager *pm = m_env->get_page_manager();
+  ham_u32_t size;
+  PExtentFreelistPayload *fp =
+          (PExtentFreelistPayload *)m_env->get_freelist_payload(&size);
+  size += PFreelistPayload::get_bitmap_offset();
+
+  ham_u32_t header_capacity = (size
+                  - PExtentFreelistPayload::get_extents_offset())
+                  / (2 * sizeof(ham_u64_t));
+  ham_u32_t page_capacity = (m_env->get_usable_page_size()
+                  - PExtentFreelistPayload::get_extents_offset())
+                  / (2 * sizeof(ham_u64_t));
+
+  /* allocate the overflow pages. They are allocated from this freelist,
+   * which can change the number of extents; therefore repeat till
+   * all extents fit */
+  std::vector<Page *> pages;
+  while (m_by_address.size() > header_capacity
+                  + pages.size() * page_capacity)
+    pages.push_back(pm->alloc_page(0, Page::kTypeFreelist,
+                            PageManager::kClearWithZero));
+
+  /* now write the extents to the header page, then to the overflow pages */
+  AddressIndex::iterator it = m_by_address.begin();
+  ham_u32_t capacity = header_capacity;
+  for (size_t p = 0; ; p++) {
+    ham_u32_t count = 0;
+    for (; it != m_by_address.end() && count < capacity; ++it, ++count)
+      fp->set_extent(count, it->first, it->second);
+    fp->set_count(count);
+
+    if (p == pages.size()) {
+      fp->set_overflow(0);
+      break;
+    }
+
+    fp->set_overflow(pages[p]->get_address());
+    pages[p]->set_dirty(true);
+    fp = (PExtentFreelistPayload *)pages[p]->get_payload();
+    capacity = page_capacity;
+  }
+
+  m_env->mark_header_page_dirty();
+
+  /* the persisted copy is now up-to-date; if the freelist is used again
+   * then it is reloaded */
+  m_by_address.clear();
+  m_by_size.clear();
+  m_initialized = false;
+}
+
+void
+ExtentFreelist::initialize()
+{
+  if (m_initialized)
+    return;
+
+  ham_assert(!(m_env->get_flags() & HAM_READ_ONLY));
+
+  m_initialized = true;
+
+  PExtentFreelistPayload *fp =
+          (PExtentFreelistPayload *)m_env->get_freelist_payload();
+
+  /* an empty list? then there's nothing to do */
+  if (fp->get_count() == 0 && fp->get_overflow() == 0)
+    return;
+
+  std::vector<ham_u64_t> overflow_pages;
+  ham_u64_t overflow = fp->get_overflow();
+
+  for (ham_u32_t i = 0; i < fp->get_count(); i++)
+    add_extent(fp->get_address(i), fp->get_size(i));
+
+  /* discard the persisted copy, otherwise its space could be allocated
+   * twice after a crash */
+  fp->set_count(0);
+  fp->set_overflow(0);
+  m_env->mark_header_page_dirty();
+
+  while (overflow) {
+    Page *page = m_env->get_page_manager()->fetch_page(0, overflow);
+    fp = (PExtentFreelistPayload *)page->get_payload();
+    for (ham_u32_t i = 0; i < fp->get_count(); i++)
+      add_extent(fp->get_address(i), fp->get_size(i));
+    overflow_pages.push_back(overflow);
+    overflow = fp->get_overflow();
+  }
+
+  /* the overflow pages are no longer required */
+  for (std::vector<ham_u64_t>::iterator it = overflow_pages.begin();
+          it != overflow_pages.end(); ++it)
+    add_extent(*it, m_env->get_page_size());
+
+  /* without recovery the header page is written immediately; otherwise
+   * it is part of the current changeset */
+  if (!(m_env->get_flags() & HAM_ENABLE_RECOVERY))
+    m_env->get_page_manager()->flush_page(
+                    m_env->get_header()->get_header_page());
+}
+
+void
+ExtentFreelist::add_extent(ham_u64_t address, ham_u64_t size)
+{
+  ham_u64_t end = address + size;
+
+  /* merge with the following extent */
+  AddressIndex::iterator next = m_by_address.lower_bound(address);
+  ham_assert(next == m_by_address.end() || next->first >= end);
+  if (next != m_by_address.end() && next->first == end) {
+    AddressIndex::iterator tmp = next;
+    ++next;
+    size += tmp->second;
+    remove_extent(tmp);
+  }
+
+  /* merge with the previous extent */
+  if (next != m_by_address.begin()) {
+    AddressIndex::iterator prev = next;
+    --prev;
+    ham_assert(prev->first + prev->second <= address);
+    if (prev->first + prev->second == address) {
+      address = prev->first;
+      size += prev->second;
+      remove_extent(prev);
+    }
+  }
+
+  m_by_address[address] = size;
+  m_by_size.insert(std::make_pair(size, address));
+}
+
+void
+ExtentFreelist::remove_extent(AddressIndex::iterator it)
+{
+  m_by_size.erase(std::make_pair(it->second, it->first));
+  m_by_address.erase(it);
+}
+
+void
+ExtentFreelist::allocate_from(AddressIndex::iterator it, ham_u64_t address,
+                ham_u64_t size)
+{
+  ham_u64_t extent_address = it->first;
+  ham_u64_t extent_end = it->first + it->second;
+
+  ham_assert(address >= extent_address);
+  ham_assert(address + size <= extent_end);
+
+  remove_extent(it);
+
+  /* return the remaining space to the freelist */
+  if (address > extent_address)
+    add_extent(extent_address, address - extent_address);
+  if (address + size < extent_end)
+    add_extent(address + size, extent_end - (address + size));
+}
+
+ExtentFreelist::AddressIndex::iterator
+ExtentFreelist::find_extent(ham_u64_t address, ham_u64_t size)
+{
+  AddressIndex::iterator it = m_by_address.upper_bound(address);
+  if (it == m_by_address.begin())
+    return (m_by_address.end());
+  --it;
+  if (it->first + it->second >= address + size)
+    return (it);
+  return (m_by_address.end());
+}
+
+} // namespace hamsterdb
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2005-2013 Christoph Rupp (chris@crupp.de).
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * See files COPYING.* for License information.
+ */
+
+/**
+ * @brief A freelist which keeps the free extents in memory
+ *
+ */
+
+#ifndef HAM_FREELIST_EXTENT_H__
+#define HAM_FREELIST_EXTENT_H__
+
+#include <map>
+#include <set>
+#include <utility>
+
+#include "ham/hamsterdb_int.h"
+
+#include "endianswap.h"
+#include "freelist.h"
+
+namespace hamsterdb {
+
+class LocalEnvironment;
+
+//
+// The ExtentFreelist stores the free space as a list of extents
+// (address, size). The extents are indexed twice: ordered by address (to
+// merge neighbouring extents when space is freed, and to answer
+// is_page_free()), and ordered by size (for a best-fit search when space
+// is allocated). All operations are O(log n) and never touch the disk.
+//
+// The list is only written to the file when the Environment is closed.
+// It is stored in the freelist area of the header page; if it does not fit
+// then the remaining extents are stored in a linked list of freelist pages.
+// The persisted list is loaded when the freelist is accessed for the first
+// time. Afterwards the persisted copy is discarded (and the overflow pages
+// are moved to the freelist). If the application crashes then the
+// space which was freed after opening the Environment is lost, but it
+// is never used twice.
+//
+class ExtentFreelist : public Freelist
+{
+    // address -> size
+    typedef std::map<ham_u64_t, ham_u64_t> AddressIndex;
+
+    // (size, address)
+    typedef std::set<std::pair<ham_u64_t, ham_u64_t> > SizeIndex;
+
+  public:
+    // Constructor
+    ExtentFreelist(LocalEnvironment *env)
+      : m_env(env), m_initialized(false), m_count_hits(0),
+        m_count_misses(0) {
+    }
+
+    // Adds a page to the freelist
+    virtual void free_page(Page *page);
+
+    // Adds an arbitrary file area to the freelist
+    // Asserts that address and size are aligned to |kBlobAlignment|!
+    virtual void free_area(ham_u64_t address, ham_u32_t size);
+
+    // Tries to allocate an (aligned) page from the freelist.
+    // Returns 0 if there was not enough free space to satisfy
+    // the request.
+    virtual ham_u64_t alloc_page();
+
+    // Tries to allocate space from the freelist (best fit).
+    // Returns 0 if there was not enough free space to satisfy the request.
+    // Asserts that size is aligned to |kBlobAlignment|.
+    virtual ham_u64_t alloc_area(ham_u32_t size);
+
+    // Truncates the page at the given |address| and removes it
+    // from the freelist.
+    // Asserts that |address| is page_size-aligned.
+    virtual void truncate_page(ham_u64_t address);
+
+    // Returns true if the page at |address| is free, otherwise false
+    // Asserts that |address| is page_size-aligned.
+    virtual bool is_page_free(ham_u64_t address);
+
+    // Fills in the collected metrics and usage statistics
+    virtual void get_metrics(ham_env_metrics_t *metrics) const;
+
+    // Writes the extent list to the header page and the overflow pages
+    virtual void close();
+
+    // Returns the number of free extents
+    size_t get_extent_count() {
+      initialize();
+      return (m_by_address.size());
+    }
+
+    // Returns the total number of free bytes
+    ham_u64_t get_free_bytes();
+
+  private:
+    // Loads the persisted extent list, if this was not yet done
+    void initialize();
+
+    // Adds an extent to both indices, merges it with its neighbours
+    void add_extent(ham_u64_t address, ham_u64_t size);
+
+    // Removes an extent from both indices
+    void remove_extent(AddressIndex::iterator it);
+
+    // Allocates |size| bytes at |address|, which must be part of the
+    // extent |it|; the remaining space is returned to the freelist
+    void allocate_from(AddressIndex::iterator it, ham_u64_t address,
+                    ham_u64_t size);
+
+    // Returns the iterator of the extent which fully contains the area
+    // [address, address + size[, or m_by_address.end()
+    AddressIndex::iterator find_extent(ham_u64_t address, ham_u64_t size);
+
+    // Environment which owns this Freelist
+    LocalEnvironment *m_env;
+
+    // true if the persisted list was loaded
+    bool m_initialized;
+
+    // the extents, ordered by address
+    AddressIndex m_by_address;
+
+    // the extents, ordered by size (and then by address)
+    SizeIndex m_by_size;
+
+    // count the freelist hits
+    ham_u64_t m_count_hits;
+
+    // count the freelist misses
+    ham_u64_t m_count_misses;
+};
+
+#include "packstart.h"
+
+/*
+ * The persistent extent list; it is stored in the freelist area of the
+ * header page and in the payload of the overflow pages
+ */
+HAM_PACK_0 class HAM_PACK_1 PExtentFreelistPayload
+{
+  public:
+    // Returns the offset of the first extent
+    static ham_u32_t get_extents_offset() {
+      return (OFFSETOF(PExtentFreelistPayload, m_extents));
+    }
+
+    // Returns the address of the next overflow page
+    ham_u64_t get_overflow() const {
+      return (ham_db2h_offset(m_overflow));
+    }
+
+    // Sets the address of the next overflow page
+    void set_overflow(ham_u64_t address) {
+      m_overflow = ham_h2db_offset(address);
+    }
+
+    // Returns the number of extents stored in this payload
+    ham_u32_t get_count() const {
+      return (ham_db2h32(m_count));
+    }
+
+    // Sets the number of extents stored in this payload
+    void set_count(ham_u32_t count) {
+      m_count = ham_h2db32(count);
+    }
+
+    // Returns the address of the extent |i|
+    ham_u64_t get_address(ham_u32_t i) const {
+      return (ham_db2h64(m_extents[i * 2]));
+    }
+
+    // Returns the size of the extent |i|
+    ham_u64_t get_size(ham_u32_t i) const {
+      return (ham_db2h64(m_extents[i * 2 + 1]));
+    }
+
+    // Sets the address and the size of extent |i|
+    void set_extent(ham_u32_t i, ham_u64_t address, ham_u64_t size) {
+      m_extents[i * 2] = ham_h2db64(address);
+      m_extents[i * 2 + 1] = ham_h2db64(size);
+    }
+
+  private:
+    // address of the next overflow page
+    ham_u64_t m_overflow;
+
+    // number of extents in this payload
+    ham_u32_t m_count;
+
+    // Reserved padding
+    ham_u32_t m_reserved;
+
+    // The extents; pairs of (address, size)
+    ham_u64_t m_extents[1];
+
+} HAM_PACK_2;
+
+#include "packstop.h"
+
+} // namespace hamsterdb
+
+#endif /* HAM_FREELIST_EXTENT_H__ */
@@ -23,7 +23,7 @@
 #include "error.h"
 #include "mem.h"
 #include "util.h"
-#include "freelist.h"
+#include "freelist_bitmap.h"
 #include "freelist_stats.h"
 
 namespace hamsterdb {
@@ -162,7 +162,7 @@ ham_bucket_index2bitcount(ham_u16_t bucket)
 }
 
 void
-FreelistStatistics::fail(Freelist *fl, FreelistEntry *entry,
+FreelistStatistics::fail(BitmapFreelist *fl, FreelistEntry *entry,
     PFreelistPayload *f, FreelistStatistics::Hints *hints)
 {
   /*
@@ -229,7 +229,7 @@ FreelistStatistics::fail(Freelist *fl, FreelistEntry *entry,
 }
 
 void
-FreelistStatistics::update(Freelist *fl, FreelistEntry *entry,
+FreelistStatistics::update(BitmapFreelist *fl, FreelistEntry *entry,
     PFreelistPayload *f, ham_u32_t position,
     FreelistStatistics::Hints *hints)
 {
@@ -288,7 +288,7 @@ FreelistStatistics::update(Freelist *fl, FreelistEntry *entry,
  * below.
  */
 void
-FreelistStatistics::edit(Freelist *fl, FreelistEntry *entry,
+FreelistStatistics::edit(BitmapFreelist *fl, FreelistEntry *entry,
     PFreelistPayload *f, ham_u32_t position, ham_u32_t size_bits,
     bool free_these, FreelistStatistics::Hints *hints)
 {
@@ -438,7 +438,7 @@ FreelistStatistics::edit(Freelist *fl, FreelistEntry *entry,
 }
 
 void
-FreelistStatistics::globalhints_no_hit(Freelist *fl,
+FreelistStatistics::globalhints_no_hit(BitmapFreelist *fl,
     FreelistEntry *entry, FreelistStatistics::Hints *hints)
 {
   GlobalStatistics *globalstats = fl->get_global_statistics();
@@ -482,7 +482,7 @@ FreelistStatistics::globalhints_no_hit(Freelist *fl,
  * freelist pages visited.
  */
 void
-FreelistStatistics::get_global_hints(Freelist *fl,
+FreelistStatistics::get_global_hints(BitmapFreelist *fl,
         FreelistStatistics::GlobalHints *dst)
 {
   GlobalStatistics *globalstats = fl->get_global_statistics();
@@ -556,8 +556,8 @@ FreelistStatistics::get_global_hints(Freelist *fl,
   freelist page.
   */
   ham_assert(HAM_MAX_U32 >= dst->lower_bound_address
-                  / (Freelist::kBlobAlignment * dst->freelist_page_size_bits));
-  pos = (ham_u32_t)(dst->lower_bound_address / (Freelist::kBlobAlignment
+                  / (BitmapFreelist::kBlobAlignment * dst->freelist_page_size_bits));
+  pos = (ham_u32_t)(dst->lower_bound_address / (BitmapFreelist::kBlobAlignment
                           * dst->freelist_page_size_bits));
   if (dst->start_entry < pos)
     dst->start_entry = pos;
@@ -596,15 +596,15 @@ FreelistStatistics::get_global_hints(Freelist *fl,
    * utilization is such that our chance at finding a match is still
    * rather low.
    */
-  switch (dst->mgt_mode & (Freelist::kDamSequentialInsert
-                          | Freelist::kDamRandomWrite))
+  switch (dst->mgt_mode & (BitmapFreelist::kDamSequentialInsert
+                          | BitmapFreelist::kDamRandomWrite))
   {
     /* SEQ+RANDOM_ACCESS: impossible mode; nasty trick for testing
      * to help Overflow4 unittest pass: disables global hinting,
      * but does do reverse scan for a bit of speed */
-  case Freelist::kDamRandomWrite | Freelist::kDamSequentialInsert:
+  case BitmapFreelist::kDamRandomWrite | BitmapFreelist::kDamSequentialInsert:
     dst->max_rounds = fl->get_count();
-    dst->mgt_mode &= ~Freelist::kDamRandomWrite;
+    dst->mgt_mode &= ~BitmapFreelist::kDamRandomWrite;
     if (0)
     {
   default:
@@ -628,8 +628,8 @@ FreelistStatistics::get_global_hints(Freelist *fl,
      *
      * for 'UBER/FAST' modes: a limit of 3 freelist pages tops.
      */
-  case Freelist::kDamSequentialInsert:
-  case Freelist::kDamRandomWrite:
+  case BitmapFreelist::kDamSequentialInsert:
+  case BitmapFreelist::kDamRandomWrite:
       dst->max_rounds = 8;
     }
     if (dst->max_rounds >= fl->get_count()) {
@@ -727,7 +727,7 @@ FreelistStatistics::get_global_hints(Freelist *fl,
  * where it deems necessary.
  */
 void
-FreelistStatistics::get_entry_hints(Freelist *fl,
+FreelistStatistics::get_entry_hints(BitmapFreelist *fl,
         FreelistEntry *entry, FreelistStatistics::Hints *dst)
 {
   PFreelistPageStatistics *entrystats = &entry->perf_data;
@@ -801,7 +801,7 @@ FreelistStatistics::get_entry_hints(Freelist *fl,
     /* take alignment into account as well! */
     if (dst->aligned) {
       ham_u32_t alignment = fl->get_env()->get_page_size()
-              / Freelist::kBlobAlignment;
+              / BitmapFreelist::kBlobAlignment;
       dst->startpos += alignment - 1;
       dst->startpos -= dst->startpos % alignment;
     }
@@ -18,7 +18,7 @@
 
 namespace hamsterdb {
 
-class Freelist;
+class BitmapFreelist;
 class PFreelistPayload;
 
 /*
@@ -229,25 +229,25 @@ class FreelistStatistics {
     ham_u32_t freelist_page_size_bits;
   };
 
-  static void globalhints_no_hit(Freelist *fl, FreelistEntry *entry,
+  static void globalhints_no_hit(BitmapFreelist *fl, FreelistEntry *entry,
                 FreelistStatistics::Hints *hints);
 
-  static void edit(Freelist *fl, FreelistEntry *entry,
+  static void edit(BitmapFreelist *fl, FreelistEntry *entry,
                 PFreelistPayload *f, ham_u32_t position,
                 ham_u32_t size_bits, bool free_these,
                 FreelistStatistics::Hints *hints);
 
-  static void fail(Freelist *fl, FreelistEntry *entry,
+  static void fail(BitmapFreelist *fl, FreelistEntry *entry,
                 PFreelistPayload *f, FreelistStatistics::Hints *hints);
 
-  static void update(Freelist *fl, FreelistEntry *entry,
+  static void update(BitmapFreelist *fl, FreelistEntry *entry,
                 PFreelistPayload *f, ham_u32_t position,
                 FreelistStatistics::Hints *hints);
 
-  static void get_entry_hints(Freelist *fl, FreelistEntry *entry,
+  static void get_entry_hints(BitmapFreelist *fl, FreelistEntry *entry,
                 FreelistStatistics::Hints *dst);
 
-  static void get_global_hints(Freelist *fl,
+  static void get_global_hints(BitmapFreelist *fl,
                 FreelistStatistics::GlobalHints *dst);
 };
 
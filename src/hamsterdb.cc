@@ -42,7 +42,7 @@
 #include "txn.h"
 #include "util.h"
 #include "version.h"
-#include "freelist.h"
+#include "freelist_bitmap.h"
 
 using namespace hamsterdb;
 
@@ -124,16 +124,27 @@ ham_txn_commit(ham_txn_t *htxn, ham_u32_t flags)
   }
 
   Environment *env = txn->get_env();
+  ham_u64_t start = os_get_microseconds();
 
   try {
-    ScopedLock lock;
-    if (!(flags & HAM_DONT_LOCK))
-      lock = ScopedLock(env->get_mutex());
-
-    /* mark this transaction as committed; will also call
-     * env->signal_commit() to write committed transactions
-     * to disk */
-    return (env->txn_commit(txn, flags));
+    {
+      ScopedLock lock;
+      if (!(flags & HAM_DONT_LOCK))
+        lock = ScopedLock(env->get_mutex());
+
+      /* mark this transaction as committed; will also call
+       * env->signal_commit() to merge committed transactions
+       * into the database */
+      ham_status_t st = env->txn_commit(txn, flags);
+      if (st)
+        return (st);
+    }
+
+    /* wait till the commit is durable; the Environment is no longer
+     * locked, and other threads can append their commits to the same
+     * group (group commit) */
+    env->sync_commit(start);
+    return (0);
   }
   catch (Exception &ex) {
     return (ex.code);
@@ -331,6 +342,13 @@ ham_env_create(ham_env_t **henv, const char *filename,
   ham_u32_t timeout = 0;
   std::string logdir;
   ham_u8_t *encryption_key = 0;
+  ham_u32_t freelist_type = HAM_FREELIST_BITMAP;
+  ham_u64_t file_growth_size = 0;
+  ham_u32_t io_backend = HAM_IO_BACKEND_SYNC;
+  ham_u32_t group_commit_delay = 0;
+  ham_u32_t group_commit_size = 0;
+  ham_u32_t journal_sync_interval = 0;
+  ham_u64_t txn_flush_limit = 0;
 
   if (!henv) {
     ham_trace(("parameter 'env' must not be NULL"));
@@ -359,6 +377,23 @@ ham_env_create(ham_env_t **henv, const char *filename,
     return (HAM_INV_PARAMETER);
   }
 
+  /* in-memory? direct I/O is not possible */
+  if ((flags & HAM_IN_MEMORY) && (flags & HAM_DIRECT_IO)) {
+    ham_trace(("combination of HAM_IN_MEMORY and HAM_DIRECT_IO "
+            "not allowed"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  /* direct I/O does not work with memory mapped files */
+  if (flags & HAM_DIRECT_IO) {
+#ifdef WIN32
+    ham_trace(("HAM_DIRECT_IO is not supported on this platform"));
+    return (HAM_NOT_IMPLEMENTED);
+#else
+    flags |= HAM_DISABLE_MMAP;
+#endif
+  }
+
   /* since 1.0.4: HAM_ENABLE_TRANSACTIONS implies HAM_ENABLE_RECOVERY */
   if (flags & HAM_ENABLE_TRANSACTIONS)
     flags |= HAM_ENABLE_RECOVERY;
@@ -374,6 +409,7 @@ ham_env_create(ham_env_t **henv, const char *filename,
   ham_u32_t mask = HAM_ENABLE_FSYNC
             | HAM_IN_MEMORY
             | HAM_DISABLE_MMAP
+            | HAM_DIRECT_IO
             | HAM_CACHE_STRICT
             | HAM_CACHE_UNLIMITED
             | HAM_ENABLE_RECOVERY
@@ -418,6 +454,48 @@ ham_env_create(ham_env_t **henv, const char *filename,
       case HAM_PARAM_NETWORK_TIMEOUT_SEC:
         timeout = (ham_u32_t)param->value;
         break;
+      case HAM_PARAM_FREELIST_TYPE:
+        if (param->value != HAM_FREELIST_BITMAP
+            && param->value != HAM_FREELIST_EXTENT) {
+          ham_trace(("invalid value %u for parameter HAM_PARAM_FREELIST_TYPE",
+                 (unsigned)param->value));
+          return (HAM_INV_PARAMETER);
+        }
+        freelist_type = (ham_u32_t)param->value;
+        break;
+      case HAM_PARAM_FILE_GROWTH_SIZE:
+        file_growth_size = param->value;
+        if (flags & HAM_IN_MEMORY && file_growth_size != 0) {
+          ham_trace(("combination of HAM_IN_MEMORY and file_growth_size "
+                "!= 0 not allowed"));
+          return (HAM_INV_PARAMETER);
+        }
+        break;
+      case HAM_PARAM_IO_BACKEND:
+        if (param->value > HAM_IO_BACKEND_THREADS) {
+          ham_trace(("invalid value %u for parameter HAM_PARAM_IO_BACKEND",
+                 (unsigned)param->value));
+          return (HAM_INV_PARAMETER);
+        }
+        io_backend = (ham_u32_t)param->value;
+        if (flags & HAM_IN_MEMORY && io_backend != HAM_IO_BACKEND_SYNC) {
+          ham_trace(("combination of HAM_IN_MEMORY and an asynchronous "
+                "I/O backend not allowed"));
+          return (HAM_INV_PARAMETER);
+        }
+        break;
+      case HAM_PARAM_GROUP_COMMIT_DELAY:
+        group_commit_delay = (ham_u32_t)param->value;
+        break;
+      case HAM_PARAM_GROUP_COMMIT_SIZE:
+        group_commit_size = (ham_u32_t)param->value;
+        break;
+      case HAM_PARAM_JOURNAL_SYNC_INTERVAL:
+        journal_sync_interval = (ham_u32_t)param->value;
+        break;
+      case HAM_PARAM_TXN_FLUSH_LIMIT:
+        txn_flush_limit = param->value;
+        break;
       case HAM_PARAM_ENCRYPTION_KEY:
 #ifdef HAM_ENABLE_ENCRYPTION
         /* in-memory? encryption is not possible */
@@ -494,6 +572,12 @@ ham_env_create(ham_env_t **henv, const char *filename,
         lenv->set_log_directory(logdir);
       if (encryption_key)
         lenv->enable_encryption(encryption_key);
+      lenv->set_freelist_type(freelist_type);
+      lenv->set_file_growth_size(file_growth_size);
+      lenv->set_io_backend(io_backend);
+      lenv->set_group_commit(group_commit_delay, group_commit_size);
+      lenv->set_journal_sync_interval(journal_sync_interval);
+      lenv->set_txn_flush_limit(txn_flush_limit);
     }
     else {
 #ifndef HAM_ENABLE_REMOTE
@@ -644,6 +728,12 @@ ham_env_open(ham_env_t **henv, const char *filename, ham_u32_t flags,
   ham_u32_t timeout = 0;
   std::string logdir;
   ham_u8_t *encryption_key = 0;
+  ham_u64_t file_growth_size = 0;
+  ham_u32_t io_backend = HAM_IO_BACKEND_SYNC;
+  ham_u32_t group_commit_delay = 0;
+  ham_u32_t group_commit_size = 0;
+  ham_u32_t journal_sync_interval = 0;
+  ham_u64_t txn_flush_limit = 0;
 
   if (!henv) {
     ham_trace(("parameter 'env' must not be NULL"));
@@ -673,6 +763,16 @@ ham_env_open(ham_env_t **henv, const char *filename, ham_u32_t flags,
   if (flags & HAM_AUTO_RECOVERY)
     flags |= HAM_ENABLE_RECOVERY;
 
+  /* direct I/O does not work with memory mapped files */
+  if (flags & HAM_DIRECT_IO) {
+#ifdef WIN32
+    ham_trace(("HAM_DIRECT_IO is not supported on this platform"));
+    return (HAM_NOT_IMPLEMENTED);
+#else
+    flags |= HAM_DISABLE_MMAP;
+#endif
+  }
+
   if (!filename && !(flags & HAM_IN_MEMORY)) {
     ham_trace(("filename is missing"));
     return (HAM_INV_PARAMETER);
@@ -690,6 +790,29 @@ ham_env_open(ham_env_t **henv, const char *filename, ham_u32_t flags,
       case HAM_PARAM_NETWORK_TIMEOUT_SEC:
         timeout = (ham_u32_t)param->value;
         break;
+      case HAM_PARAM_FILE_GROWTH_SIZE:
+        file_growth_size = param->value;
+        break;
+      case HAM_PARAM_IO_BACKEND:
+        if (param->value > HAM_IO_BACKEND_THREADS) {
+          ham_trace(("invalid value %u for parameter HAM_PARAM_IO_BACKEND",
+                 (unsigned)param->value));
+          return (HAM_INV_PARAMETER);
+        }
+        io_backend = (ham_u32_t)param->value;
+        break;
+      case HAM_PARAM_GROUP_COMMIT_DELAY:
+        group_commit_delay = (ham_u32_t)param->value;
+        break;
+      case HAM_PARAM_GROUP_COMMIT_SIZE:
+        group_commit_size = (ham_u32_t)param->value;
+        break;
+      case HAM_PARAM_JOURNAL_SYNC_INTERVAL:
+        journal_sync_interval = (ham_u32_t)param->value;
+        break;
+      case HAM_PARAM_TXN_FLUSH_LIMIT:
+        txn_flush_limit = param->value;
+        break;
       case HAM_PARAM_ENCRYPTION_KEY:
 #ifdef HAM_ENABLE_ENCRYPTION
         encryption_key = (ham_u8_t *)param->value;
@@ -729,6 +852,11 @@ ham_env_open(ham_env_t **henv, const char *filename, ham_u32_t flags,
         lenv->set_log_directory(logdir);
       if (encryption_key)
         lenv->enable_encryption(encryption_key);
+      lenv->set_file_growth_size(file_growth_size);
+      lenv->set_io_backend(io_backend);
+      lenv->set_group_commit(group_commit_delay, group_commit_size);
+      lenv->set_journal_sync_interval(journal_sync_interval);
+      lenv->set_txn_flush_limit(txn_flush_limit);
     }
     else {
 #ifndef HAM_ENABLE_REMOTE
@@ -903,6 +1031,65 @@ ham_env_flush(ham_env_t *henv, ham_u32_t flags)
   }
 }
 
+ham_status_t HAM_CALLCONV
+ham_env_sync(ham_env_t *henv, ham_u32_t flags)
+{
+  Environment *env = (Environment *)henv;
+  if (!env) {
+    ham_trace(("parameter 'env' must not be NULL"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  if (flags) {
+    ham_trace(("parameter 'flags' is unused, set to 0"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  /* the Environment is not locked; other threads can continue to
+   * commit while the journal is flushed */
+  try {
+    return (env->sync(flags));
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
+ham_status_t HAM_CALLCONV
+ham_env_compact(ham_env_t *henv, ham_u32_t max_pages, ham_u64_t *reclaimed,
+                ham_u32_t flags)
+{
+  Environment *env = (Environment *)henv;
+  if (!env) {
+    ham_trace(("parameter 'env' must not be NULL"));
+    return (HAM_INV_PARAMETER);
+  }
+  if (!reclaimed) {
+    ham_trace(("parameter 'reclaimed' must not be NULL"));
+    return (HAM_INV_PARAMETER);
+  }
+  if (!max_pages) {
+    ham_trace(("parameter 'max_pages' must not be 0"));
+    return (HAM_INV_PARAMETER);
+  }
+  if (flags & ~HAM_COMPACT_PUNCH_HOLES) {
+    ham_trace(("invalid flag 0x%x", flags));
+    return (HAM_INV_PARAMETER);
+  }
+
+  *reclaimed = 0;
+
+  try {
+    ScopedLock lock = ScopedLock(env->get_mutex());
+
+    /* compact the Environment */
+    return (env->compact(max_pages, reclaimed, flags));
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
 ham_status_t HAM_CALLCONV
 ham_env_close(ham_env_t *henv, ham_u32_t flags)
 {
@@ -1078,6 +1265,11 @@ ham_db_find(ham_db_t *hdb, ham_txn_t *htxn, ham_key_t *key,
             "ham_cursor_insert"));
       return (db->set_error(HAM_INV_PARAMETER));
     }
+    if (flags & HAM_FIND_PREFIX_MATCH) {
+      ham_trace(("flag HAM_FIND_PREFIX_MATCH is only allowed in "
+            "ham_cursor_find"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
     if ((flags & HAM_DIRECT_ACCESS)
         && !(env->get_flags() & HAM_IN_MEMORY)) {
       ham_trace(("flag HAM_DIRECT_ACCESS is only allowed in "
@@ -1534,6 +1726,82 @@ ham_cursor_move(ham_cursor_t *hcursor, ham_key_t *key,
   }
 }
 
+HAM_EXPORT ham_status_t HAM_CALLCONV
+ham_cursor_get_batch(ham_cursor_t *hcursor, ham_key_t *keys,
+        ham_record_t *records, ham_u32_t *count, ham_u32_t flags)
+{
+  Database *db;
+  Environment *env;
+
+  if (!hcursor) {
+    ham_trace(("parameter 'cursor' must not be NULL"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  Cursor *cursor = (Cursor *)hcursor;
+
+  db = cursor->get_db();
+
+  try {
+    ScopedLock lock(db->get_env()->get_mutex());
+
+    if (!count) {
+      ham_trace(("parameter 'count' must not be NULL"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+    if (!keys && !records) {
+      ham_trace(("parameters 'keys' and 'records' must not both be NULL"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+    if (!(flags & (HAM_CURSOR_FIRST | HAM_CURSOR_LAST
+                    | HAM_CURSOR_NEXT | HAM_CURSOR_PREVIOUS))) {
+      ham_trace(("a direction (HAM_CURSOR_FIRST, HAM_CURSOR_LAST, "
+            "HAM_CURSOR_NEXT or HAM_CURSOR_PREVIOUS) is required"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+    if ((flags & HAM_ONLY_DUPLICATES) && (flags & HAM_SKIP_DUPLICATES)) {
+      ham_trace(("combination of HAM_ONLY_DUPLICATES and "
+            "HAM_SKIP_DUPLICATES not allowed"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+    if (flags & HAM_PARTIAL) {
+      ham_trace(("flag HAM_PARTIAL is not allowed in ham_cursor_get_batch"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+
+    env = db->get_env();
+
+    if ((flags & HAM_DIRECT_ACCESS)
+        && !(env->get_flags() & HAM_IN_MEMORY)) {
+      ham_trace(("flag HAM_DIRECT_ACCESS is only allowed in "
+             "In-Memory Databases"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+    if ((flags & HAM_DIRECT_ACCESS)
+        && (env->get_flags() & HAM_ENABLE_TRANSACTIONS)) {
+      ham_trace(("flag HAM_DIRECT_ACCESS is not allowed in "
+            "combination with Transactions"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+
+    for (ham_u32_t i = 0; i < *count; i++) {
+      if (keys && !__prepare_key(&keys[i]))
+        return (db->set_error(HAM_INV_PARAMETER));
+      if (records && !__prepare_record(&records[i]))
+        return (db->set_error(HAM_INV_PARAMETER));
+    }
+
+    if (*count == 0)
+      return (db->set_error(0));
+
+    return (db->set_error(db->cursor_get_batch(cursor, keys, records,
+                            count, flags)));
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
 HAM_EXPORT ham_status_t HAM_CALLCONV
 ham_cursor_find(ham_cursor_t *hcursor, ham_key_t *key, ham_record_t *record,
         ham_u32_t flags)
@@ -1588,6 +1856,12 @@ ham_cursor_find(ham_cursor_t *hcursor, ham_key_t *key, ham_record_t *record,
             "transactions"));
       return (db->set_error(HAM_INV_PARAMETER));
     }
+    if ((flags & HAM_FIND_PREFIX_MATCH)
+        && (flags & (HAM_FIND_LT_MATCH | HAM_FIND_GT_MATCH))) {
+      ham_trace(("flag HAM_FIND_PREFIX_MATCH is not allowed in combination "
+            "with other 'find' flags"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
 
     if (key && !__prepare_key(key))
       return (db->set_error(HAM_INV_PARAMETER));
@@ -1810,6 +2084,98 @@ ham_cursor_get_record_size(ham_cursor_t *hcursor, ham_u64_t *size)
   }
 }
 
+ham_status_t HAM_CALLCONV
+ham_cursor_set_filter(ham_cursor_t *hcursor, const ham_cursor_filter_t *filter)
+{
+  Database *db;
+
+  if (!hcursor) {
+    ham_trace(("parameter 'cursor' must not be NULL"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  Cursor *cursor = (Cursor *)hcursor;
+
+  db = cursor->get_db();
+
+  try {
+    ScopedLock lock(db->get_env()->get_mutex());
+
+    if (filter && filter->max_record_size
+        && filter->max_record_size < filter->min_record_size) {
+      ham_trace(("filter's max_record_size must not be smaller than "
+            "min_record_size"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+
+    return (db->set_error(db->cursor_set_filter(cursor, filter)));
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
+ham_status_t HAM_CALLCONV
+ham_cursor_skip_prefix(ham_cursor_t *hcursor, ham_u32_t prefix_size,
+        ham_key_t *key, ham_record_t *record, ham_u32_t flags)
+{
+  Database *db;
+  Environment *env;
+
+  if (!hcursor) {
+    ham_trace(("parameter 'cursor' must not be NULL"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  Cursor *cursor = (Cursor *)hcursor;
+
+  db = cursor->get_db();
+
+  try {
+    ScopedLock lock(db->get_env()->get_mutex());
+
+    env = db->get_env();
+
+    if (!prefix_size) {
+      ham_trace(("parameter 'prefix_size' must not be 0"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+    if (flags & ~(HAM_CURSOR_NEXT | HAM_CURSOR_PREVIOUS | HAM_DIRECT_ACCESS)) {
+      ham_trace(("only HAM_CURSOR_NEXT, HAM_CURSOR_PREVIOUS and "
+            "HAM_DIRECT_ACCESS are allowed"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+    if ((flags & HAM_CURSOR_NEXT) && (flags & HAM_CURSOR_PREVIOUS)) {
+      ham_trace(("combination of HAM_CURSOR_NEXT and HAM_CURSOR_PREVIOUS "
+            "not allowed"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+    if ((flags & HAM_DIRECT_ACCESS)
+        && !(env->get_flags() & HAM_IN_MEMORY)) {
+      ham_trace(("flag HAM_DIRECT_ACCESS is only allowed in "
+             "In-Memory Databases"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+    if ((flags & HAM_DIRECT_ACCESS)
+        && (env->get_flags() & HAM_ENABLE_TRANSACTIONS)) {
+      ham_trace(("flag HAM_DIRECT_ACCESS is not allowed in "
+            "combination with Transactions"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+
+    if (key && !__prepare_key(key))
+      return (db->set_error(HAM_INV_PARAMETER));
+    if (record && !__prepare_record(record))
+      return (db->set_error(HAM_INV_PARAMETER));
+
+    return (db->set_error(db->cursor_skip_prefix(cursor, prefix_size,
+                    key, record, flags)));
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
 ham_status_t HAM_CALLCONV
 ham_cursor_close(ham_cursor_t *hcursor)
 {
@@ -1934,6 +2300,37 @@ ham_db_get_key_count(ham_db_t *hdb, ham_txn_t *htxn, ham_u32_t flags,
   }
 }
 
+ham_status_t HAM_CALLCONV
+ham_db_scan(ham_db_t *hdb, ham_u32_t partitions, ham_scan_visitor_t visitor,
+      void *context, ham_u32_t flags)
+{
+  Database *db = (Database *)hdb;
+
+  if (!db) {
+    ham_trace(("parameter 'db' must not be NULL"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  if (!visitor) {
+    ham_trace(("parameter 'visitor' must not be NULL"));
+    return (db->set_error(HAM_INV_PARAMETER));
+  }
+
+  if (partitions == 0) {
+    ham_trace(("parameter 'partitions' must be > 0"));
+    return (db->set_error(HAM_INV_PARAMETER));
+  }
+
+  try {
+    ScopedLock lock(db->get_env()->get_mutex());
+
+    return (db->set_error(db->scan(partitions, visitor, context, flags)));
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
 void HAM_CALLCONV
 ham_set_errhandler(ham_errhandler_fun f)
 {
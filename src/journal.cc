@@ -229,8 +229,137 @@ Journal::append_txn_commit(Transaction *txn, ham_u64_t lsn)
   m_closed_txn[idx]++;
 
   append_entry(idx, &entry, sizeof(entry));
-  if (m_env->get_flags() & HAM_ENABLE_FSYNC)
-    os_flush(m_fd[idx]);
+  flush_buffer(idx);
+
+  // the file is flushed in sync_commits(), together with the commits
+  // of other threads
+  ScopedLock lock(m_sync_mutex);
+  m_appended_commits++;
+  m_needs_sync[idx] = true;
+  m_sync_cond.notify_all();
+
+  if (!m_syncer && m_env->get_flags() & HAM_ENABLE_FSYNC
+      && m_env->get_journal_sync_interval())
+    start_syncer();
+}
+
+void
+Journal::sync_commits()
+{
+  ScopedLock lock(m_sync_mutex);
+  ham_u64_t target = m_appended_commits;
+
+  while (m_synced_commits < target) {
+    // another thread is already flushing the files; wait till it's done,
+    // then check if our commit was part of its group
+    if (m_sync_in_progress) {
+      m_sync_cond.wait(lock);
+      continue;
+    }
+
+    // otherwise become the leader of the next group
+    m_sync_in_progress = true;
+
+    // wait for more commits to join the group
+    ham_u32_t delay = m_env->get_group_commit_delay();
+    ham_u32_t size = m_env->get_group_commit_size();
+    if (delay) {
+      boost::system_time deadline = boost::get_system_time()
+              + boost::posix_time::microseconds(delay);
+      while (!size || m_appended_commits - m_synced_commits < size) {
+        if (!m_sync_cond.timed_wait(lock, deadline))
+          break;
+      }
+    }
+
+    ham_u64_t group = m_appended_commits;
+    bool needs_sync[2] = {m_needs_sync[0], m_needs_sync[1]};
+    m_needs_sync[0] = m_needs_sync[1] = false;
+
+    // flush the files without holding the lock; other threads can
+    // append new commits in the meantime
+    lock.unlock();
+    try {
+      for (int i = 0; i < 2; i++) {
+        if (needs_sync[i])
+          os_flush(m_fd[i]);
+      }
+    }
+    catch (Exception &) {
+      lock.lock();
+      m_needs_sync[0] |= needs_sync[0];
+      m_needs_sync[1] |= needs_sync[1];
+      m_sync_in_progress = false;
+      m_sync_cond.notify_all();
+      throw;
+    }
+    lock.lock();
+
+    m_sync_count++;
+    m_synced_commits = group;
+    m_sync_in_progress = false;
+    m_sync_cond.notify_all();
+  }
+}
+
+void
+Journal::start_syncer()
+{
+  m_syncer_shutdown = false;
+  m_syncer = new Thread(&Journal::run_syncer, this);
+}
+
+void
+Journal::stop_syncer()
+{
+  if (!m_syncer)
+    return;
+
+  {
+    ScopedLock lock(m_sync_mutex);
+    m_syncer_shutdown = true;
+    m_syncer_cond.notify_all();
+  }
+
+  m_syncer->join();
+  delete m_syncer;
+  m_syncer = 0;
+}
+
+void
+Journal::run_syncer()
+{
+  boost::posix_time::milliseconds interval(
+                  m_env->get_journal_sync_interval());
+
+  ScopedLock lock(m_sync_mutex);
+  while (!m_syncer_shutdown) {
+    boost::system_time deadline = boost::get_system_time() + interval;
+    while (!m_syncer_shutdown && m_syncer_cond.timed_wait(lock, deadline))
+      ;
+    if (m_syncer_shutdown || m_synced_commits == m_appended_commits)
+      continue;
+
+    lock.unlock();
+    try {
+      sync_commits();
+    }
+    catch (Exception &) {
+      // the error was already logged; the flush is repeated in the next
+      // interval
+    }
+    lock.lock();
+  }
+}
+
+void
+Journal::get_metrics(ham_env_metrics_t *metrics)
+{
+  ScopedLock lock(m_sync_mutex);
+  metrics->journal_commit_syncs = m_sync_count;
+  metrics->journal_synced_commits = m_synced_commits;
+  metrics->journal_writes = m_write_count;
+  metrics->journal_bytes_written = m_bytes_written;
 }
 
 void
@@ -311,6 +440,9 @@ Journal::get_entry(Iterator *iter, PJournalEntry *entry, ByteArray *auxbuffer)
   // The oldest of the two logfiles is always the "other" one (the one
   // NOT in current_fd).
   if (iter->offset == 0) {
+    flush_buffer(0);
+    flush_buffer(1);
+
     iter->fdstart = iter->fdidx=
                   m_current_fd == 0
                       ? 1
@@ -360,6 +492,17 @@ Journal::close(bool noclear)
 {
   int i;
 
+  if (noclear) {
+    flush_buffer(0);
+    flush_buffer(1);
+  }
+
+  // flush the pending commits; this also waits till a running group
+  // commit is finished
+  stop_syncer();
+  if (m_env->get_flags() & HAM_ENABLE_FSYNC)
+    sync_commits();
+
   if (!noclear) {
     PEnvironmentHeader header;
 
@@ -614,6 +757,59 @@ Journal::clear_file(int idx)
   // clear the transaction counters
   m_open_txn[idx] = 0;
   m_closed_txn[idx] = 0;
+
+  // and discard the buffered entries; they belong to Transactions which
+  // were already closed
+  m_buffer_size[idx] = 0;
+}
+
+void
+Journal::append_entry(int fdidx, void *ptr1, ham_u32_t ptr1_size,
+                void *ptr2, ham_u32_t ptr2_size,
+                void *ptr3, ham_u32_t ptr3_size,
+                void *ptr4, ham_u32_t ptr4_size,
+                void *ptr5, ham_u32_t ptr5_size)
+{
+  void *ptrs[5] = {ptr1, ptr2, ptr3, ptr4, ptr5};
+  ham_u32_t sizes[5] = {ptr1_size, ptr2_size, ptr3_size, ptr4_size,
+                ptr5_size};
+  ham_u32_t size = ptr1_size + ptr2_size + ptr3_size + ptr4_size + ptr5_size;
+
+  if (m_buffer_size[fdidx] + size > kBufferSize)
+    flush_buffer(fdidx);
+
+  // large entries are not buffered
+  if (size > kBufferSize) {
+    os_writev(m_fd[fdidx], ptr1, ptr1_size, ptr2, ptr2_size,
+                ptr3, ptr3_size, ptr4, ptr4_size, ptr5, ptr5_size);
+    m_write_count++;
+    m_bytes_written += size;
+    return;
+  }
+
+  if (m_buffer[fdidx].get_size() == 0)
+    m_buffer[fdidx].resize(kBufferSize);
+
+  ham_u8_t *p = (ham_u8_t *)m_buffer[fdidx].get_ptr() + m_buffer_size[fdidx];
+  for (int i = 0; i < 5; i++) {
+    if (sizes[i]) {
+      memcpy(p, ptrs[i], sizes[i]);
+      p += sizes[i];
+    }
+  }
+  m_buffer_size[fdidx] += size;
+}
+
+void
+Journal::flush_buffer(int fdidx)
+{
+  if (m_buffer_size[fdidx] == 0)
+    return;
+
+  os_write(m_fd[fdidx], m_buffer[fdidx].get_ptr(), m_buffer_size[fdidx]);
+  m_write_count++;
+  m_bytes_written += m_buffer_size[fdidx];
+  m_buffer_size[fdidx] = 0;
 }
 
 std::string
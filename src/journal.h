@@ -26,22 +26,24 @@
 
 #include "mem.h"
 #include "env_local.h"
+#include "mutex.h"
 #include "os.h"
+#include "util.h"
 #include "journal_entries.h"
 
 namespace hamsterdb {
 
-class ByteArray;
-
-#include "packstart.h"
-
 //
 // The Journal object
 //
 class Journal
 {
     enum {
-      kDefaultThreshold = 16
+      kDefaultThreshold = 16,
+
+      // The size of the write buffer of each file; larger entries are
+      // written directly
+      kBufferSize = 256 * 1024
     };
 
   public:
@@ -64,6 +66,8 @@ class Journal
       ENTRY_TYPE_ERASE      = 5
     };
 
+#include "packstart.h"
+
     //
     // The header structure of a journal file
     //
@@ -82,6 +86,8 @@ class Journal
       ham_u64_t lsn;
     } HAM_PACK_2;
 
+#include "packstop.h"
+
     //
     // An "iterator" structure for traversing the journal files
     //
@@ -103,13 +109,25 @@ class Journal
     // Constructor
     Journal(LocalEnvironment *env)
       : m_env(env), m_current_fd(0), m_lsn(1), m_last_cp_lsn(0),
-        m_threshold(kDefaultThreshold), m_disable_logging(false) {
+        m_threshold(kDefaultThreshold), m_disable_logging(false),
+        m_appended_commits(0), m_synced_commits(0), m_sync_count(0),
+        m_sync_in_progress(false), m_syncer(0), m_syncer_shutdown(false),
+        m_write_count(0), m_bytes_written(0) {
       m_fd[0] = HAM_INVALID_FD;
       m_fd[1] = HAM_INVALID_FD;
+      m_buffer_size[0] = 0;
+      m_buffer_size[1] = 0;
       m_open_txn[0] = 0;
       m_open_txn[1] = 0;
       m_closed_txn[0] = 0;
       m_closed_txn[1] = 0;
+      m_needs_sync[0] = false;
+      m_needs_sync[1] = false;
+    }
+
+    // Destructor; stops the background thread
+    ~Journal() {
+      stop_syncer();
     }
 
     // Creates a new journal
@@ -126,6 +144,8 @@ class Journal
         return (true);
 
       for (int i = 0; i < 2; i++) {
+        if (m_buffer_size[i])
+          return (false);
         size = os_get_filesize(m_fd[i]);
         if (size && size != sizeof(PEnvironmentHeader))
           return (false);
@@ -141,9 +161,24 @@ class Journal
     // Appends a journal entry for ham_txn_abort/ENTRY_TYPE_TXN_ABORT
     void append_txn_abort(Transaction *txn, ham_u64_t lsn);
 
-    // Appends a journal entry for ham_txn_commit/ENTRY_TYPE_TXN_COMMIT
+    // Appends a journal entry for ham_txn_commit/ENTRY_TYPE_TXN_COMMIT.
+    // The file is not flushed immediately; with HAM_ENABLE_FSYNC, the
+    // caller has to call sync_commits() afterwards, or the background
+    // thread flushes it (see HAM_PARAM_JOURNAL_SYNC_INTERVAL)
     void append_txn_commit(Transaction *txn, ham_u64_t lsn);
 
+    // Waits till all commits which were appended so far are flushed to
+    // disk (group commit). Must not be called while holding the
+    // Environment's mutex, otherwise no other commits can join the group.
+    // The first waiting thread becomes the "leader": it waits up to
+    // HAM_PARAM_GROUP_COMMIT_DELAY microseconds for further commits, then
+    // flushes the files for the whole group and wakes up all waiting
+    // threads
+    void sync_commits();
+
+    // Fills in the group commit metrics
+    void get_metrics(ham_env_metrics_t *metrics);
+
     // Appends a journal entry for ham_insert/ENTRY_TYPE_INSERT
     void append_insert(Database *db, Transaction *txn,
                 ham_key_t *key, ham_record_t *record, ham_u32_t flags,
@@ -198,17 +233,27 @@ class Journal
     void get_entry(Iterator *iter, PJournalEntry *entry,
                     ByteArray *auxbuffer);
 
-    // Appends an entry to the journal
+    // Starts the background thread which flushes the journal every
+    // HAM_PARAM_JOURNAL_SYNC_INTERVAL milliseconds
+    void start_syncer();
+
+    // Stops the background thread
+    void stop_syncer();
+
+    // The main loop of the background thread
+    void run_syncer();
+
+    // Appends an entry to the write buffer of a file; the buffer is
+    // written when a Transaction is committed, or if it is full
     void append_entry(int fdidx,
                 void *ptr1 = 0, ham_u32_t ptr1_size = 0,
                 void *ptr2 = 0, ham_u32_t ptr2_size = 0,
                 void *ptr3 = 0, ham_u32_t ptr3_size = 0,
                 void *ptr4 = 0, ham_u32_t ptr4_size = 0,
-                void *ptr5 = 0, ham_u32_t ptr5_size = 0) {
-      os_writev(m_fd[fdidx], ptr1, ptr1_size,
-                  ptr2, ptr2_size, ptr3, ptr3_size,
-                  ptr4, ptr4_size, ptr5, ptr5_size);
-    }
+                void *ptr5 = 0, ham_u32_t ptr5_size = 0);
+
+    // Writes the buffered entries of a file
+    void flush_buffer(int fdidx);
 
     // Clears a single file
     void clear_file(int idx);
@@ -240,9 +285,51 @@ class Journal
 
     // Set to false to disable logging; used during recovery
     bool m_disable_logging;
-};
 
-#include "packstop.h"
+    // Protects the group commit state below; the files are flushed
+    // without holding the Environment's mutex
+    Mutex m_sync_mutex;
+
+    // Signalled when a group was flushed, or when a commit was appended
+    // while the leader is waiting for more commits
+    Condition m_sync_cond;
+
+    // The number of commits which were appended to the journal
+    ham_u64_t m_appended_commits;
+
+    // The number of commits which were flushed to disk
+    ham_u64_t m_synced_commits;
+
+    // The number of flushes; each flush covers a group of commits
+    ham_u64_t m_sync_count;
+
+    // True while a leader flushes the files
+    bool m_sync_in_progress;
+
+    // True if a file has commits which were not yet flushed
+    bool m_needs_sync[2];
+
+    // The background thread which flushes the journal periodically
+    Thread *m_syncer;
+
+    // Wakes up the background thread when the journal is closed
+    Condition m_syncer_cond;
+
+    // Set to true to stop the background thread
+    bool m_syncer_shutdown;
+
+    // The write buffers of the two files
+    ByteArray m_buffer[2];
+
+    // The number of bytes in the write buffers
+    ham_u32_t m_buffer_size[2];
+
+    // The number of write requests
+    ham_u64_t m_write_count;
+
+    // The number of bytes written
+    ham_u64_t m_bytes_written;
+};
 
 } // namespace hamsterdb
 
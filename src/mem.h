@@ -64,6 +64,32 @@ class Memory {
       return (t);
     }
 
+    // allocates a byte array of |size| elements which starts at a multiple
+    // of |alignment| (a power of two); the memory is released with
+    // Memory::release(). Required for buffers which are used with
+    // HAM_DIRECT_IO. Win32 does not support direct I/O, and the memory
+    // is not aligned.
+    template<typename T>
+    static T *allocate_aligned(size_t size, size_t alignment) {
+      ms_total_allocations++;
+      ms_current_allocations++;
+
+      void *p = 0;
+#ifdef HAM_USE_TCMALLOC
+      if (::tc_posix_memalign(&p, alignment, size))
+        p = 0;
+#elif defined(WIN32)
+      (void)alignment;
+      p = ::malloc(size);
+#else
+      if (::posix_memalign(&p, alignment, size))
+        p = 0;
+#endif
+      if (!p)
+        throw Exception(HAM_OUT_OF_MEMORY);
+      return ((T *)p);
+    }
+
     // allocation function; returns null if out of memory. initializes
     // the allocated memory with zeroes.
     // usage:
@@ -35,11 +35,28 @@ os_mmap(ham_fd_t fd, ham_fd_t *mmaph, ham_u64_t position,
 extern void
 os_munmap(ham_fd_t *mmaph, void *buffer, ham_u64_t size);
 
+// grows a mapping from |oldsize| to |newsize| bytes without moving it;
+// returns false if this is not possible (or not supported)
+extern bool
+os_mremap(ham_fd_t *mmaph, void *buffer, ham_u64_t oldsize,
+            ham_u64_t newsize);
+
+// discards the modified (private) copy of a mapped area; the next access
+// reads the file again
+extern void
+os_mmap_discard(void *buffer, ham_u64_t size);
+
 // positional read from a file
 extern void
 os_pread(ham_fd_t fd, ham_u64_t addr, void *buffer,
             ham_u64_t bufferlen);
 
+// positional read from a file; unlike os_pread, a short read at the end
+// of the file is not an error. Returns the number of bytes read
+extern ham_u64_t
+os_pread_partial(ham_fd_t fd, ham_u64_t addr, void *buffer,
+            ham_u64_t bufferlen);
+
 // positional write to a file
 extern void
 os_pwrite(ham_fd_t fd, ham_u64_t addr, const void *buffer,
@@ -57,6 +74,12 @@ os_writev(ham_fd_t fd, void *buffer1, ham_u64_t buffer1_len,
             void *buffer4 = 0, ham_u64_t buffer4_len = 0,
             void *buffer5 = 0, ham_u64_t buffer5_len = 0);
 
+// positional write of |count| buffers to a file (pwritev(2)); the buffers
+// are written back-to-back, starting at |addr|
+extern void
+os_pwritev(ham_fd_t fd, ham_u64_t addr, void **buffers, ham_u64_t *sizes,
+            ham_u32_t count);
+
 #ifdef HAM_OS_POSIX
 #  define HAM_OS_SEEK_SET   SEEK_SET
 #  define HAM_OS_SEEK_END   SEEK_END
@@ -73,6 +96,11 @@ os_writev(ham_fd_t fd, void *buffer1, ham_u64_t buffer1_len,
 extern ham_u32_t
 os_get_granularity();
 
+// returns a monotonic timestamp in microseconds; used for measuring
+// latencies
+extern ham_u64_t
+os_get_microseconds();
+
 // seek position in a file
 extern void
 os_seek(ham_fd_t fd, ham_u64_t offset, int whence);
@@ -89,7 +117,20 @@ os_get_filesize(ham_fd_t fd);
 extern void
 os_truncate(ham_fd_t fd, ham_u64_t newsize);
 
-// create a new file
+// extends the file to |newsize| bytes and reserves the disk space for the
+// new area (if the file system supports it), so that the file is not
+// fragmented; falls back to os_truncate
+extern void
+os_allocate(ham_fd_t fd, ham_u64_t oldsize, ham_u64_t newsize);
+
+// releases the disk space of a file area without changing the file size;
+// the area reads back as zeroes. Does nothing if the file system does not
+// support this
+extern void
+os_punch_hole(ham_fd_t fd, ham_u64_t offset, ham_u64_t size);
+
+// create a new file; if |flags| contains HAM_DIRECT_IO then the file
+// bypasses the page cache of the operating system
 extern ham_fd_t
 os_create(const char *filename, ham_u32_t flags, ham_u32_t mode);
 
@@ -26,11 +26,13 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/file.h>
+#include <sys/time.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netdb.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <time.h>
 
 #include "error.h"
 #include "os.h"
@@ -43,6 +45,10 @@ namespace hamsterdb {
 #  define os_log(x)
 #endif
 
+// the max. number of buffers per pwritev(2) call; IOV_MAX is larger on
+// all common platforms
+enum { kMaxIovecs = 64 };
+
 static void
 lock_exclusive(int fd, bool lock)
 {
@@ -82,12 +88,39 @@ enable_largefile(int fd)
 #endif
 }
 
+static void
+disable_caching(int fd)
+{
+  // O_DIRECT is set when the file is opened; MacOS does not have O_DIRECT
+  // but can disable the caching of a file descriptor
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+  if (fcntl(fd, F_NOCACHE, 1) < 0)
+    ham_log(("fcntl(F_NOCACHE) failed with status %u (%s)",
+            errno, strerror(errno)));
+#else
+  (void)fd;
+#endif
+}
+
 ham_u32_t
 os_get_granularity()
 {
   return ((ham_u32_t)sysconf(_SC_PAGE_SIZE));
 }
 
+ham_u64_t
+os_get_microseconds()
+{
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+    return ((ham_u64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+#endif
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return ((ham_u64_t)tv.tv_sec * 1000000 + tv.tv_usec);
+}
+
 void
 os_mmap(ham_fd_t fd, ham_fd_t *mmaph, ham_u64_t position,
             ham_u64_t size, bool readonly, ham_u8_t **buffer)
@@ -131,6 +164,40 @@ os_munmap(ham_fd_t *mmaph, void *buffer, ham_u64_t size)
 #endif
 }
 
+bool
+os_mremap(ham_fd_t *mmaph, void *buffer, ham_u64_t oldsize,
+            ham_u64_t newsize)
+{
+  os_log(("os_mremap: oldsize=%lld, newsize=%lld", oldsize, newsize));
+
+  (void)mmaph; /* only used on win32-platforms */
+
+#if HAVE_MMAP && defined(__linux__)
+  /* no MREMAP_MAYMOVE - the pages which point into the mapped area
+   * must remain valid */
+  if (mremap(buffer, oldsize, newsize, 0) != MAP_FAILED)
+    return (true);
+  os_log(("mremap failed with status %d (%s)", errno, strerror(errno)));
+#else
+  (void)buffer;
+  (void)oldsize;
+  (void)newsize;
+#endif
+  return (false);
+}
+
+void
+os_mmap_discard(void *buffer, ham_u64_t size)
+{
+#if HAVE_MMAP && defined(MADV_DONTNEED)
+  if (madvise(buffer, size, MADV_DONTNEED))
+    os_log(("madvise failed with status %d (%s)", errno, strerror(errno)));
+#else
+  (void)buffer;
+  (void)size;
+#endif
+}
+
 static void
 os_read(ham_fd_t fd, ham_u8_t *buffer, ham_u64_t bufferlen)
 {
@@ -187,6 +254,32 @@ os_pread(ham_fd_t fd, ham_u64_t addr, void *buffer,
 #endif
 }
 
+ham_u64_t
+os_pread_partial(ham_fd_t fd, ham_u64_t addr, void *buffer,
+            ham_u64_t bufferlen)
+{
+  os_log(("os_pread_partial: fd=%d, address=%lld, size=%lld",
+          fd, addr, bufferlen));
+
+  ssize_t r;
+  ham_u64_t total = 0;
+
+  while (total < bufferlen) {
+    r = pread(fd, (ham_u8_t *)buffer + total, bufferlen - total, addr + total);
+    if (r < 0) {
+      if (errno == EINTR)
+        continue;
+      ham_log(("os_pread_partial failed with status %u (%s)",
+              errno, strerror(errno)));
+      throw Exception(HAM_IO_ERROR);
+    }
+    if (r == 0)
+      break;
+    total += r;
+  }
+  return (total);
+}
+
 void
 os_write(ham_fd_t fd, const void *buffer, ham_u64_t bufferlen)
 {
@@ -321,6 +414,66 @@ os_writev(ham_fd_t fd, void *buffer1, ham_u64_t buffer1_len,
 #endif
 }
 
+void
+os_pwritev(ham_fd_t fd, ham_u64_t addr, void **buffers, ham_u64_t *sizes,
+            ham_u32_t count)
+{
+  os_log(("os_pwritev: fd=%d, address=%lld, count=%u", fd, addr, count));
+
+#ifdef HAVE_PWRITEV
+  struct iovec vec[kMaxIovecs];
+
+  while (count > 0) {
+    int c = count < kMaxIovecs ? (int)count : (int)kMaxIovecs;
+    ham_u64_t total = 0;
+    for (int i = 0; i < c; i++) {
+      vec[i].iov_base = buffers[i];
+      vec[i].iov_len = sizes[i];
+      total += sizes[i];
+    }
+
+    // retry after short writes; skip the iovecs which were written
+    struct iovec *v = &vec[0];
+    int remaining = c;
+    ham_u64_t written = 0;
+    while (written < total) {
+      ssize_t s = pwritev(fd, v, remaining, addr + written);
+      if (s < 0) {
+        if (errno == EINTR)
+          continue;
+        ham_log(("pwritev failed with status %u (%s)",
+                errno, strerror(errno)));
+        throw Exception(HAM_IO_ERROR);
+      }
+      if (s == 0) {
+        ham_log(("pwritev failed with short write"));
+        throw Exception(HAM_IO_ERROR);
+      }
+      written += s;
+      while (remaining > 0 && (size_t)s >= v->iov_len) {
+        s -= v->iov_len;
+        v++;
+        remaining--;
+      }
+      if (remaining > 0) {
+        v->iov_base = (ham_u8_t *)v->iov_base + s;
+        v->iov_len -= s;
+      }
+    }
+
+    addr += total;
+    buffers += c;
+    sizes += c;
+    count -= c;
+  }
+#else
+  for (ham_u32_t i = 0; i < count; i++) {
+    os_pwrite(fd, addr, buffers[i], sizes[i]);
+    addr += sizes[i];
+  }
+#endif
+}
+
 void
 os_seek(ham_fd_t fd, ham_u64_t offset, int whence)
 {
@@ -356,6 +509,39 @@ os_truncate(ham_fd_t fd, ham_u64_t newsize)
     throw Exception(HAM_IO_ERROR);
 }
 
+void
+os_allocate(ham_fd_t fd, ham_u64_t oldsize, ham_u64_t newsize)
+{
+  os_log(("os_allocate: fd=%d, size=%lld", fd, newsize));
+  ham_assert(newsize >= oldsize);
+#if defined(__linux__)
+  /* fallocate() fails if the file system does not support it; then
+   * fall back to ftruncate(). posix_fallocate() is not used because
+   * it would write zeroes instead */
+  if (fallocate(fd, 0, (off_t)oldsize, (off_t)(newsize - oldsize)) == 0)
+    return;
+  os_log(("fallocate failed with status %d (%s)", errno, strerror(errno)));
+#endif
+  os_truncate(fd, newsize);
+}
+
+void
+os_punch_hole(ham_fd_t fd, ham_u64_t offset, ham_u64_t size)
+{
+  os_log(("os_punch_hole: fd=%d, offset=%lld, size=%lld", fd, offset, size));
+#if defined(__linux__) && defined(FALLOC_FL_PUNCH_HOLE)
+  /* not all file systems support this; then the space is simply not
+   * released */
+  if (fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+              (off_t)offset, (off_t)size))
+    os_log(("fallocate failed with status %d (%s)", errno, strerror(errno)));
+#else
+  (void)fd;
+  (void)offset;
+  (void)size;
+#endif
+}
+
 ham_fd_t
 os_create(const char *filename, ham_u32_t flags, ham_u32_t mode)
 {
@@ -363,7 +549,10 @@ os_create(const char *filename, ham_u32_t flags, ham_u32_t mode)
 #if HAVE_O_NOATIME
   flags |= O_NOATIME;
 #endif
-  (void)flags;
+#ifdef O_DIRECT
+  if (flags & HAM_DIRECT_IO)
+    osflags |= O_DIRECT;
+#endif
 
   if (!mode)
     mode = 0644;
@@ -375,6 +564,9 @@ os_create(const char *filename, ham_u32_t flags, ham_u32_t mode)
     throw Exception(HAM_IO_ERROR);
   }
 
+  if (flags & HAM_DIRECT_IO)
+    disable_caching(fd);
+
   /* lock the file - this is default behaviour since 1.1.0 */
   lock_exclusive(fd, true);
 
@@ -413,6 +605,10 @@ os_open(const char *filename, ham_u32_t flags)
 #if HAVE_O_NOATIME
   osflags |= O_NOATIME;
 #endif
+#ifdef O_DIRECT
+  if (flags & HAM_DIRECT_IO)
+    osflags |= O_DIRECT;
+#endif
 
   ham_fd_t fd = open(filename, osflags);
   if (fd < 0) {
@@ -421,6 +617,9 @@ os_open(const char *filename, ham_u32_t flags)
     throw Exception(errno == ENOENT ? HAM_FILE_NOT_FOUND : HAM_IO_ERROR);
   }
 
+  if (flags & HAM_DIRECT_IO)
+    disable_caching(fd);
+
   /* lock the file - this is default behaviour since 1.1.0 */
   lock_exclusive(fd, true);
 
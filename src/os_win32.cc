@@ -88,6 +88,17 @@ os_get_granularity()
   return ((ham_u32_t)info.dwAllocationGranularity);
 }
 
+ham_u64_t
+os_get_microseconds()
+{
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return ((ham_u64_t)(counter.QuadPart / frequency.QuadPart) * 1000000
+          + (counter.QuadPart % frequency.QuadPart) * 1000000
+                / frequency.QuadPart);
+}
+
 void
 os_mmap(ham_fd_t fd, ham_fd_t *mmaph, ham_u64_t position,
             ham_u64_t size, bool readonly, ham_u8_t **buffer)
@@ -148,6 +159,26 @@ os_munmap(ham_fd_t *mmaph, void *buffer, ham_u64_t size)
   *mmaph = 0;
 }
 
+bool
+os_mremap(ham_fd_t *mmaph, void *buffer, ham_u64_t oldsize,
+            ham_u64_t newsize)
+{
+  /* a view can not be extended; the caller maps an additional view */
+  (void)mmaph;
+  (void)buffer;
+  (void)oldsize;
+  (void)newsize;
+  return (false);
+}
+
+void
+os_mmap_discard(void *buffer, ham_u64_t size)
+{
+  /* not supported for copy-on-write views */
+  (void)buffer;
+  (void)size;
+}
+
 void
 os_pread(ham_fd_t fd, ham_u64_t addr, void *buffer, ham_u64_t bufferlen)
 {
@@ -177,6 +208,39 @@ os_pread(ham_fd_t fd, ham_u64_t addr, void *buffer, ham_u64_t bufferlen)
     throw Exception(HAM_IO_ERROR);
 }
 
+ham_u64_t
+os_pread_partial(ham_fd_t fd, ham_u64_t addr, void *buffer,
+    ham_u64_t bufferlen)
+{
+  ham_status_t st;
+  OVERLAPPED ov = { 0 };
+  ov.Offset = (DWORD)addr;
+  ov.OffsetHigh = addr >> 32;
+  DWORD read;
+  if (!::ReadFile(fd, buffer, (DWORD)bufferlen, &read, &ov)) {
+    st = (ham_status_t)GetLastError();
+    if (st == ERROR_HANDLE_EOF)
+      return (0);
+    if (st != ERROR_IO_PENDING) {
+      char buf[256];
+      ham_log(("ReadFile failed with OS status %u (%s)",
+            st, DisplayError(buf, sizeof(buf), st)));
+      throw Exception(HAM_IO_ERROR);
+    }
+    if (!::GetOverlappedResult(fd, &ov, &read, TRUE)) {
+      st = (ham_status_t)GetLastError();
+      if (st == ERROR_HANDLE_EOF)
+        return (0);
+      char buf[256];
+      ham_log(("GetOverlappedResult failed with OS status %u (%s)",
+            st, DisplayError(buf, sizeof(buf), st)));
+      throw Exception(HAM_IO_ERROR);
+    }
+  }
+
+  return (read);
+}
+
 void
 os_pwrite(ham_fd_t fd, ham_u64_t addr, const void *buffer,
     ham_u64_t bufferlen)
@@ -256,6 +320,17 @@ os_writev(ham_fd_t fd, void *buffer1, ham_u64_t buffer1_len,
   }
 }
 
+void
+os_pwritev(ham_fd_t fd, ham_u64_t addr, void **buffers, ham_u64_t *sizes,
+            ham_u32_t count)
+{
+  // WriteFileGather requires unbuffered I/O and page-sized buffers
+  for (ham_u32_t i = 0; i < count; i++) {
+    os_pwrite(fd, addr, buffers[i], sizes[i]);
+    addr += sizes[i];
+  }
+}
+
 #ifndef INVALID_SET_FILE_POINTER
 #   define INVALID_SET_FILE_POINTER  ((DWORD)-1)
 #endif
@@ -334,6 +409,24 @@ os_truncate(ham_fd_t fd, ham_u64_t newsize)
   }
 }
 
+void
+os_allocate(ham_fd_t fd, ham_u64_t oldsize, ham_u64_t newsize)
+{
+  /* SetEndOfFile() already reserves the disk space */
+  (void)oldsize;
+  os_truncate(fd, newsize);
+}
+
+void
+os_punch_hole(ham_fd_t fd, ham_u64_t offset, ham_u64_t size)
+{
+  /* not supported; the file would have to be converted to a sparse
+   * file (FSCTL_SET_SPARSE) */
+  (void)fd;
+  (void)offset;
+  (void)size;
+}
+
 ham_fd_t
 os_create(const char *filename, ham_u32_t flags, ham_u32_t mode)
 {
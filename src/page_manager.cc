@@ -10,6 +10,7 @@
  */
 
 #include <string.h>
+#include <algorithm>
 
 #include "page.h"
 #include "cache.h"
@@ -58,6 +59,12 @@ PageManager::get_metrics(ham_env_metrics_t *metrics) const
     m_freelist->get_metrics(metrics);
 }
 
+static bool
+page_address_less(const Page *lhs, const Page *rhs)
+{
+  return (lhs->get_address() < rhs->get_address());
+}
+
 Page *
 PageManager::fetch_page(LocalDatabase *db, ham_u64_t address,
                 bool only_from_cache)
@@ -106,19 +113,58 @@ PageManager::fetch_page(LocalDatabase *db, ham_u64_t address,
   return (page);
 }
 
+void
+PageManager::flush_pages(Page **pages, ham_u32_t count)
+{
+  std::vector<Page *> dirty;
+  dirty.reserve(count);
+  for (ham_u32_t i = 0; i < count; i++) {
+    if (pages[i]->is_dirty())
+      dirty.push_back(pages[i]);
+  }
+  if (dirty.empty())
+    return;
+
+  // sort by address; the Device coalesces adjacent pages into large
+  // sequential writes
+  std::sort(dirty.begin(), dirty.end(), page_address_less);
+  m_env->get_device()->write_pages(&dirty[0], (ham_u32_t)dirty.size());
+
+  for (std::vector<Page *>::iterator it = dirty.begin();
+          it != dirty.end(); ++it)
+    (*it)->set_dirty(false);
+  m_page_count_flushed += dirty.size();
+}
+
+void
+PageManager::prefetch_page(ham_u64_t address)
+{
+  if (address == 0 || m_env->get_flags() & HAM_IN_MEMORY)
+    return;
+  if (m_cache->contains(address))
+    return;
+  m_env->get_device()->prefetch_page(address);
+}
+
 Page *
 PageManager::alloc_page(LocalDatabase *db, ham_u32_t page_type, ham_u32_t flags)
 {
   ham_u64_t freelist = 0;
   Page *page = 0;
   bool allocated_by_me = false;
+  Freelist *f = 0;
 
   ham_assert(0 == (flags & ~(PageManager::kIgnoreFreelist
-                                | PageManager::kClearWithZero)));
+                                | PageManager::kClearWithZero
+                                | PageManager::kOnlyFromFreelist)));
 
   /* first, we ask the freelist for a page */
-  if (!(flags & PageManager::kIgnoreFreelist) && m_freelist) {
-    freelist = m_freelist->alloc_page();
+  if (flags & PageManager::kOnlyFromFreelist)
+    f = get_freelist();
+  else if (!(flags & PageManager::kIgnoreFreelist))
+    f = get_freelist_for_alloc();
+  if (f) {
+    freelist = f->alloc_page();
     if (freelist > 0) {
       ham_assert(freelist % m_env->get_page_size() == 0);
       /* try to fetch the page from the cache */
@@ -132,6 +178,9 @@ PageManager::alloc_page(LocalDatabase *db, ham_u32_t page_type, ham_u32_t flags)
     }
   }
 
+  if (flags & PageManager::kOnlyFromFreelist)
+    return (0);
+
   if (!page) {
     page = new Page(m_env, db);
     allocated_by_me = true;
@@ -154,6 +203,10 @@ done:
   if (flags & PageManager::kClearWithZero)
     memset(page->get_data(), 0, m_env->get_page_size());
 
+  /* a cached page from the freelist might have been a blob page, which
+   * does not have a header */
+  page->set_flags(page->get_flags() & ~Page::kNpersNoHeader);
+
   /* initialize the page; also set the 'dirty' flag to force logging */
   page->set_type(page_type);
   page->set_dirty(true);
@@ -195,8 +248,9 @@ PageManager::alloc_blob(Database *db, ham_u32_t size, bool *pallocated)
     *pallocated = false;
 
   // first check the freelist
-  if (m_freelist)
-    address = m_freelist->alloc_area(size);
+  Freelist *f = get_freelist_for_alloc();
+  if (f)
+    address = f->alloc_area(size);
 
   return (address);
 }
@@ -221,6 +275,13 @@ flush_all_pages_callback(Page *page, Database *db, ham_u32_t flags)
 void
 PageManager::flush_all_pages(bool nodelete)
 {
+  // first write all dirty pages in one batch, then uncouple the cursors
+  // and delete the pages
+  std::vector<Page *> dirty;
+  m_cache->get_dirty_pages(&dirty);
+  if (!dirty.empty())
+    flush_pages(&dirty[0], (ham_u32_t)dirty.size());
+
   m_cache->visit(flush_all_pages_callback, 0, nodelete ? 1 : 0);
 }
 
@@ -241,32 +302,79 @@ PageManager::purge_cache()
             (m_env->get_flags() & HAM_CACHE_STRICT) != 0);
 }
 
-void
-PageManager::reclaim_space()
+ham_u64_t
+PageManager::reclaim_space(bool online)
 {
   if (!m_freelist)
-    return;
+    return (0);
 
   ham_assert(!(m_env->get_flags() & HAM_DISABLE_RECLAIM_INTERNAL));
 
   ham_u32_t page_size = m_env->get_page_size();
-  ham_u64_t filesize = m_env->get_device()->get_filesize();
+  Device *device = m_env->get_device();
+  ham_u64_t filesize = device->get_filesize();
 
   // ignore subsequent errors - we're closing the database, and if
   // reclaiming fails then this is not a tragedy
   try {
     ham_u64_t new_size = filesize;
     while (true) {
+#ifdef WIN32
+      // Win32: a mapped file can not be truncated while the Environment
+      // is in use. Other platforms just drop the truncated pages from the
+      // mapping (the cached copies are removed below).
+      if (online && device->is_mapped(new_size - page_size, page_size))
+        break;
+#endif
       if (!m_freelist->is_page_free(new_size - page_size))
         break;
       new_size -= page_size;
       m_freelist->truncate_page(new_size);
     }
     if (new_size == filesize)
-      return;
-    m_env->get_device()->truncate(new_size);
+      return (0);
+
+    // the truncated pages are free, but they might still be cached
+    if (online) {
+      for (ham_u64_t address = new_size; address < filesize;
+              address += page_size) {
+        Page *page = m_cache->get_page(address);
+        if (page)
+          delete page;
+      }
+    }
+
+    device->truncate(new_size);
+    return (filesize - new_size);
   }
   catch (Exception &) {
+    return (0);
+  }
+}
+
+void
+PageManager::punch_holes(ham_u64_t start, ham_u64_t end)
+{
+  if (!m_freelist)
+    return;
+
+  ham_u32_t page_size = m_env->get_page_size();
+  ham_u64_t hole = 0;
+
+  for (ham_u64_t address = start; address <= end; address += page_size) {
+    if (address < end && m_freelist->is_page_free(address)) {
+      // a cached copy would be written back when it's flushed
+      Page *page = m_cache->get_page(address);
+      if (page)
+        delete page;
+      if (!hole)
+        hole = address;
+      continue;
+    }
+    if (hole) {
+      m_env->get_device()->punch_hole(hole, address - hole);
+      hole = 0;
+    }
   }
 }
 
@@ -333,7 +441,8 @@ PageManager::close()
 {
   flush_all_pages();
 
-  // reclaim unused disk space
+  // reclaim unused disk space, then write the freelist state (if the
+  // freelist keeps it in memory)
   // if logging is enabled: also flush the changeset to write back the
   // modified freelist pages
   bool try_reclaim = m_env->get_flags() & HAM_DISABLE_RECLAIM_INTERNAL
@@ -346,12 +455,15 @@ PageManager::close()
     try_reclaim = false;
 #endif
 
-  if (try_reclaim) {
+  if (try_reclaim)
     reclaim_space();
 
-    if (m_env->get_flags() & HAM_ENABLE_RECOVERY)
-      m_env->get_changeset().flush(m_env->get_incremented_lsn());
-  }
+  if (m_freelist)
+    m_freelist->close();
+
+  if ((m_env->get_flags() & HAM_ENABLE_RECOVERY)
+      && (try_reclaim || !m_env->get_changeset().is_empty()))
+    m_env->get_changeset().flush(m_env->get_incremented_lsn());
 
   // flush again; there were pages fetched during reclaim, and they have
   // to be released now
@@ -19,6 +19,8 @@
 
 #include "error.h"
 #include "freelist.h"
+#include "freelist_bitmap.h"
+#include "freelist_extent.h"
 #include "env_local.h"
 #include "db_local.h"
 
@@ -37,7 +39,11 @@ class PageManager {
       kIgnoreFreelist =  8,
 
       // Clear the full page with zeroes
-      kClearWithZero  = 16
+      kClearWithZero  = 16,
+
+      // Only allocate the page from the freelist (which is loaded if
+      // necessary); returns NULL if the freelist is empty
+      kOnlyFromFreelist = 32
     };
 
     // Default constructor
@@ -65,7 +71,8 @@ class PageManager {
     //
     // @param db The Database which allocates this page
     // @param page_type One of Page::TYPE_* in page.h
-    // @param flags Either kIgnoreFreelist or kClearWithZero
+    // @param flags A combination of kIgnoreFreelist, kClearWithZero and
+    //              kOnlyFromFreelist
     Page *alloc_page(LocalDatabase *db, ham_u32_t page_type, ham_u32_t flags);
 
     // Flushes a Page to disk
@@ -76,6 +83,14 @@ class PageManager {
       }
     }
 
+    // Flushes a batch of Pages to disk; the dirty pages are handed to the
+    // Device at once, which can write them in parallel
+    void flush_pages(Page **pages, ham_u32_t count);
+
+    // Starts reading a page in the background if it's not yet cached;
+    // used by the cursors to read ahead the next sibling
+    void prefetch_page(ham_u64_t address);
+
     // Allocates space for a blob, either by using the freelist or by
     // allocating free disk space at the end of the file
     //
@@ -93,8 +108,17 @@ class PageManager {
     // Purges the cache if the cache limits are exceeded
     void purge_cache();
 
-    // Reclaim file space
-    void reclaim_space();
+    // Reclaim file space; truncates the free pages at the end of the file.
+    //
+    // If |online| is true then the Environment remains in use: pages in
+    // the memory mapped area are not truncated, and the truncated pages
+    // are removed from the cache. Returns the number of released bytes.
+    ham_u64_t reclaim_space(bool online = false);
+
+    // Releases the storage of all free pages in the file area
+    // [|start|, |end|[ (see Device::punch_hole), and removes them from
+    // the cache
+    void punch_holes(ham_u64_t start, ham_u64_t end);
 
     // Flushes all pages of a database (but not the header page,
     // it's still required and will be flushed below)
@@ -128,6 +152,7 @@ class PageManager {
   private:
     friend struct BlobManagerFixture;
     friend struct CacheFixture;
+    friend struct ExtentFreelistFixture;
     friend struct FreelistFixture;
     friend struct PageManagerFixture;
 
@@ -140,8 +165,22 @@ class PageManager {
     Freelist *get_freelist() {
       if (!m_freelist
           && !(m_env->get_flags() & HAM_IN_MEMORY)
-          && !(m_env->get_flags() & HAM_READ_ONLY))
-        m_freelist = new Freelist(m_env);
+          && !(m_env->get_flags() & HAM_READ_ONLY)) {
+        if (m_env->get_freelist_type() == HAM_FREELIST_EXTENT)
+          m_freelist = new ExtentFreelist(m_env);
+        else
+          m_freelist = new BitmapFreelist(m_env);
+      }
+      return (m_freelist);
+    }
+
+    // Returns the freelist which is used for allocations. The
+    // BitmapFreelist is only used if space was freed since the Environment
+    // was opened; the ExtentFreelist is always used because loading
+    // the extent list is cheap
+    Freelist *get_freelist_for_alloc() {
+      if (!m_freelist && m_env->get_freelist_type() == HAM_FREELIST_EXTENT)
+        return (get_freelist());
       return (m_freelist);
     }
 
@@ -996,6 +996,59 @@ handle_cursor_get_record_count(ServerContext *srv, uv_stream_t *tcp,
   send_wrapper(srv, tcp, &reply);
 }
 
+static void
+handle_cursor_set_filter(ServerContext *srv, uv_stream_t *tcp,
+            Protocol *request)
+{
+  ham_status_t st = 0;
+  ham_cursor_filter_t filter;
+  ham_key_t lower_bound, upper_bound, prefix;
+
+  ham_assert(request != 0);
+  ham_assert(request->has_cursor_set_filter_request());
+
+  const CursorSetFilterRequest &r = request->cursor_set_filter_request();
+
+  Cursor *cursor = srv->get_cursor(r.cursor_handle());
+  if (!cursor) {
+    st = HAM_INV_PARAMETER;
+    goto bail;
+  }
+
+  memset(&filter, 0, sizeof(filter));
+  if (r.has_lower_bound()) {
+    memset(&lower_bound, 0, sizeof(lower_bound));
+    lower_bound.data = (void *)&r.lower_bound().data()[0];
+    lower_bound.size = (ham_u16_t)r.lower_bound().data().size();
+    filter.lower_bound = &lower_bound;
+  }
+  if (r.has_upper_bound()) {
+    memset(&upper_bound, 0, sizeof(upper_bound));
+    upper_bound.data = (void *)&r.upper_bound().data()[0];
+    upper_bound.size = (ham_u16_t)r.upper_bound().data().size();
+    filter.upper_bound = &upper_bound;
+  }
+  if (r.has_prefix()) {
+    memset(&prefix, 0, sizeof(prefix));
+    prefix.data = (void *)&r.prefix().data()[0];
+    prefix.size = (ham_u16_t)r.prefix().data().size();
+    filter.prefix = &prefix;
+  }
+  filter.min_record_size = r.min_record_size();
+  filter.max_record_size = r.max_record_size();
+
+  /* the filter is evaluated by the local Cursor; only matching keys
+   * and records are sent back to the client */
+  st = ham_cursor_set_filter((ham_cursor_t *)cursor,
+                        r.has_filter() ? &filter : 0);
+
+bail:
+  Protocol reply(Protocol::CURSOR_SET_FILTER_REPLY);
+  reply.mutable_cursor_set_filter_reply()->set_status(st);
+
+  send_wrapper(srv, tcp, &reply);
+}
+
 static void
 handle_cursor_overwrite(ServerContext *srv, uv_stream_t *tcp,
             Protocol *request)
@@ -1205,6 +1258,9 @@ dispatch(ServerContext *srv, uv_stream_t *tcp, ham_u8_t *data, ham_u32_t size)
     case ProtoWrapper_Type_CURSOR_MOVE_REQUEST:
       handle_cursor_move(srv, tcp, wrapper);
       break;
+    case ProtoWrapper_Type_CURSOR_SET_FILTER_REQUEST:
+      handle_cursor_set_filter(srv, tcp, wrapper);
+      break;
     case ProtoWrapper_Type_CURSOR_CLOSE_REQUEST:
       handle_cursor_close(srv, tcp, wrapper);
       break;
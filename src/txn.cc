@@ -238,10 +238,10 @@ Transaction::commit(ham_u32_t flags)
   /* this transaction is now committed!  */
   m_flags |= kStateCommitted;
 
-  // TODO ugly - better move flush_committed_txns() in the caller
+  // TODO ugly - better move signal_commit() in the caller
   LocalEnvironment *lenv = dynamic_cast<LocalEnvironment *>(m_env);
   if (lenv)
-    lenv->flush_committed_txns();
+    lenv->signal_commit(this);
 }
 
 void
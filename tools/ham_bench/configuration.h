@@ -76,11 +76,14 @@ struct Configuration
       use_remote(false), duplicate(kDuplicateDisabled), overwrite(false),
       transactions_nth(0), use_fsync(false), inmemory(false),
       use_recovery(false), use_transactions(false), no_mmap(false),
-      cacheunlimited(false), cachesize(0), hints(0), pagesize(0),
-      num_threads(1), use_cursors(false), direct_access(false),
+      direct_io(false), cacheunlimited(false), cachesize(0), hints(0),
+      pagesize(0), num_threads(1), use_cursors(false), direct_access(false),
       use_berkeleydb(false), use_hamsterdb(true), fullcheck(kFullcheckDefault),
       fullcheck_frequency(1000), metrics(kMetricsDefault),
-      extkey_threshold(0), duptable_threshold(0) {
+      extkey_threshold(0), duptable_threshold(0),
+      freelist_type(HAM_FREELIST_BITMAP), file_growth_size(0),
+      io_backend(HAM_IO_BACKEND_SYNC), group_commit_delay(0),
+      group_commit_size(0), journal_sync_interval(0), txn_flush_limit(0) {
   }
 
   void print() const {
@@ -105,6 +108,8 @@ struct Configuration
       printf("--inmemorydb ");
     if (no_mmap)
       printf("--no-mmap ");
+    if (direct_io)
+      printf("--direct-io ");
     if (cacheunlimited)
       printf("--cache=unlimited ");
     if (cachesize)
@@ -141,6 +146,22 @@ struct Configuration
       printf("--extkey-threshold=%d ", extkey_threshold);
     if (duptable_threshold)
       printf("--duptable-threshold=%d ", duptable_threshold);
+    if (freelist_type == HAM_FREELIST_EXTENT)
+      printf("--freelist=extent ");
+    if (file_growth_size)
+      printf("--file-growth-size=%lu ", file_growth_size);
+    if (io_backend == HAM_IO_BACKEND_ASYNC)
+      printf("--io-backend=async ");
+    else if (io_backend == HAM_IO_BACKEND_THREADS)
+      printf("--io-backend=threads ");
+    if (group_commit_delay)
+      printf("--group-commit-delay=%u ", group_commit_delay);
+    if (group_commit_size)
+      printf("--group-commit-size=%u ", group_commit_size);
+    if (journal_sync_interval)
+      printf("--journal-sync-interval=%u ", journal_sync_interval);
+    if (txn_flush_limit)
+      printf("--txn-flush-limit=%lu ", txn_flush_limit);
     if (!filename.empty()) {
       printf("%s\n", filename.c_str());
     }
@@ -223,6 +244,7 @@ struct Configuration
   bool use_recovery;
   bool use_transactions;
   bool no_mmap;
+  bool direct_io;
   bool cacheunlimited;
   int cachesize;
   int hints;
@@ -238,6 +260,13 @@ struct Configuration
   int metrics;
   int extkey_threshold;
   int duptable_threshold;
+  int freelist_type;
+  unsigned long file_growth_size;
+  int io_backend;
+  unsigned group_commit_delay;
+  unsigned group_commit_size;
+  unsigned journal_sync_interval;
+  unsigned long txn_flush_limit;
 };
 
 #endif /* CONFIGURATION_H__ */
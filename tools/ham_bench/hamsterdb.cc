@@ -70,7 +70,7 @@ HamsterDatabase::do_create_env()
 {
   ham_status_t st = 0;
   ham_u32_t flags = 0;
-  ham_parameter_t params[6] = {{0, 0}};
+  ham_parameter_t params[12] = {{0, 0}};
 
   ScopedLock lock(ms_mutex);
 
@@ -86,13 +86,28 @@ HamsterDatabase::do_create_env()
     params[1].value = m_config->pagesize;
     //params[2].name = HAM_PARAM_MAX_DATABASES;
     //params[2].value = 32; // for up to 32 threads
+    params[2].name = HAM_PARAM_FREELIST_TYPE;
+    params[2].value = m_config->freelist_type;
+    params[3].name = HAM_PARAM_FILE_GROWTH_SIZE;
+    params[3].value = m_config->file_growth_size;
+    params[4].name = HAM_PARAM_IO_BACKEND;
+    params[4].value = m_config->io_backend;
+    params[5].name = HAM_PARAM_GROUP_COMMIT_DELAY;
+    params[5].value = m_config->group_commit_delay;
+    params[6].name = HAM_PARAM_GROUP_COMMIT_SIZE;
+    params[6].value = m_config->group_commit_size;
+    params[7].name = HAM_PARAM_JOURNAL_SYNC_INTERVAL;
+    params[7].value = m_config->journal_sync_interval;
+    params[8].name = HAM_PARAM_TXN_FLUSH_LIMIT;
+    params[8].value = m_config->txn_flush_limit;
     if (m_config->use_encryption) {
-      params[2].name = HAM_PARAM_ENCRYPTION_KEY;
-      params[2].value = (ham_u64_t)"1234567890123456";
+      params[9].name = HAM_PARAM_ENCRYPTION_KEY;
+      params[9].value = (ham_u64_t)"1234567890123456";
     }
 
     flags |= m_config->inmemory ? HAM_IN_MEMORY : 0; 
     flags |= m_config->no_mmap ? HAM_DISABLE_MMAP : 0; 
+    flags |= m_config->direct_io ? HAM_DIRECT_IO : 0;
     flags |= m_config->use_recovery ? HAM_ENABLE_RECOVERY : 0;
     flags |= m_config->cacheunlimited ? HAM_CACHE_UNLIMITED : 0;
     flags |= m_config->use_transactions ? HAM_ENABLE_TRANSACTIONS : 0;
@@ -140,7 +155,7 @@ HamsterDatabase::do_open_env()
 {
   ham_status_t st = 0;
   ham_u32_t flags = 0;
-  ham_parameter_t params[6] = {{0, 0}};
+  ham_parameter_t params[10] = {{0, 0}};
 
   ScopedLock lock(ms_mutex);
 
@@ -153,12 +168,25 @@ HamsterDatabase::do_open_env()
   if (ms_env == 0) {
     params[0].name = HAM_PARAM_CACHESIZE;
     params[0].value = m_config->cachesize;
+    params[1].name = HAM_PARAM_FILE_GROWTH_SIZE;
+    params[1].value = m_config->file_growth_size;
+    params[2].name = HAM_PARAM_IO_BACKEND;
+    params[2].value = m_config->io_backend;
+    params[3].name = HAM_PARAM_GROUP_COMMIT_DELAY;
+    params[3].value = m_config->group_commit_delay;
+    params[4].name = HAM_PARAM_GROUP_COMMIT_SIZE;
+    params[4].value = m_config->group_commit_size;
+    params[5].name = HAM_PARAM_JOURNAL_SYNC_INTERVAL;
+    params[5].value = m_config->journal_sync_interval;
+    params[6].name = HAM_PARAM_TXN_FLUSH_LIMIT;
+    params[6].value = m_config->txn_flush_limit;
     if (m_config->use_encryption) {
-      params[1].name = HAM_PARAM_ENCRYPTION_KEY;
-      params[1].value = (ham_u64_t)"1234567890123456";
+      params[7].name = HAM_PARAM_ENCRYPTION_KEY;
+      params[7].value = (ham_u64_t)"1234567890123456";
     }
 
     flags |= m_config->no_mmap ? HAM_DISABLE_MMAP : 0; 
+    flags |= m_config->direct_io ? HAM_DIRECT_IO : 0;
     flags |= m_config->cacheunlimited ? HAM_CACHE_UNLIMITED : 0;
     flags |= m_config->use_transactions ? HAM_ENABLE_TRANSACTIONS : 0;
     flags |= m_config->use_fsync ? HAM_ENABLE_FSYNC : 0;
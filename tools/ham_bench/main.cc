@@ -76,6 +76,14 @@
 #define ARG_DISTRIBUTION            56
 #define ARG_EXTKEY_THRESHOLD        57
 #define ARG_DUPTABLE_THRESHOLD      58
+#define ARG_FREELIST                59
+#define ARG_FILE_GROWTH_SIZE        60
+#define ARG_IO_BACKEND              61
+#define ARG_DIRECT_IO               62
+#define ARG_GROUP_COMMIT_DELAY      63
+#define ARG_GROUP_COMMIT_SIZE       64
+#define ARG_JOURNAL_SYNC_INTERVAL   65
+#define ARG_TXN_FLUSH_LIMIT         66
 
 /*
  * command line parameters
@@ -185,6 +193,12 @@ static option_t opts[] = {
     "no-mmap",
     "Disables memory mapped I/O",
     0 },
+  {
+    ARG_DIRECT_IO,
+    0,
+    "direct-io",
+    "Bypasses the page cache of the operating system",
+    0 },
   {
     ARG_FULLCHECK,
     0,
@@ -347,6 +361,51 @@ static option_t opts[] = {
     "duptable-threshold",
     "Duplicates > threshold are moved to an external table",
     GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_FREELIST,
+    0,
+    "freelist",
+    "Sets the freelist implementation ('bitmap', 'extent')",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_FILE_GROWTH_SIZE,
+    0,
+    "file-growth-size",
+    "Extends (and pre-allocates) the file in steps of this many bytes",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_IO_BACKEND,
+    0,
+    "io-backend",
+    "Sets the file I/O backend ('sync', 'async', 'threads')",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_GROUP_COMMIT_DELAY,
+    0,
+    "group-commit-delay",
+    "Waits up to this many microseconds for other commits before the "
+            "journal is flushed",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_GROUP_COMMIT_SIZE,
+    0,
+    "group-commit-size",
+    "Flushes the journal as soon as this many commits are waiting",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_JOURNAL_SYNC_INTERVAL,
+    0,
+    "journal-sync-interval",
+    "Flushes the journal in the background every N milliseconds; commits "
+            "do not wait for the flush",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_TXN_FLUSH_LIMIT,
+    0,
+    "txn-flush-limit",
+    "Merges committed transactions in the background, as long as they do "
+            "not exceed N bytes",
+    GETOPTS_NEED_ARGUMENT },
   { 0, 0, 0, 0, 0 }
 };
 
@@ -457,6 +516,9 @@ parse_config(int argc, char **argv, Configuration *c)
     else if (opt == ARG_DISABLE_MMAP) {
       c->no_mmap = true;
     }
+    else if (opt == ARG_DIRECT_IO) {
+      c->direct_io = true;
+    }
     else if (opt == ARG_PAGESIZE) {
       c->pagesize = strtoul(param, 0, 0);
     }
@@ -643,6 +705,63 @@ parse_config(int argc, char **argv, Configuration *c)
         exit(-1);
       }
     }
+    else if (opt == ARG_FREELIST) {
+      if (param && !strcmp(param, "bitmap"))
+        c->freelist_type = HAM_FREELIST_BITMAP;
+      else if (param && !strcmp(param, "extent"))
+        c->freelist_type = HAM_FREELIST_EXTENT;
+      else {
+        printf("[FAIL] invalid parameter for --freelist\n");
+        exit(-1);
+      }
+    }
+    else if (opt == ARG_FILE_GROWTH_SIZE) {
+      c->file_growth_size = strtoul(param, 0, 0);
+      if (!c->file_growth_size) {
+        printf("[FAIL] invalid parameter for 'file-growth-size'\n");
+        exit(-1);
+      }
+    }
+    else if (opt == ARG_IO_BACKEND) {
+      if (param && !strcmp(param, "sync"))
+        c->io_backend = HAM_IO_BACKEND_SYNC;
+      else if (param && !strcmp(param, "async"))
+        c->io_backend = HAM_IO_BACKEND_ASYNC;
+      else if (param && !strcmp(param, "threads"))
+        c->io_backend = HAM_IO_BACKEND_THREADS;
+      else {
+        printf("[FAIL] invalid parameter for --io-backend\n");
+        exit(-1);
+      }
+    }
+    else if (opt == ARG_GROUP_COMMIT_DELAY) {
+      c->group_commit_delay = strtoul(param, 0, 0);
+      if (!c->group_commit_delay) {
+        printf("[FAIL] invalid parameter for 'group-commit-delay'\n");
+        exit(-1);
+      }
+    }
+    else if (opt == ARG_GROUP_COMMIT_SIZE) {
+      c->group_commit_size = strtoul(param, 0, 0);
+      if (!c->group_commit_size) {
+        printf("[FAIL] invalid parameter for 'group-commit-size'\n");
+        exit(-1);
+      }
+    }
+    else if (opt == ARG_JOURNAL_SYNC_INTERVAL) {
+      c->journal_sync_interval = strtoul(param, 0, 0);
+      if (!c->journal_sync_interval) {
+        printf("[FAIL] invalid parameter for 'journal-sync-interval'\n");
+        exit(-1);
+      }
+    }
+    else if (opt == ARG_TXN_FLUSH_LIMIT) {
+      c->txn_flush_limit = strtoul(param, 0, 0);
+      if (!c->txn_flush_limit) {
+        printf("[FAIL] invalid parameter for 'txn-flush-limit'\n");
+        exit(-1);
+      }
+    }
     else if (opt == GETOPTS_PARAMETER) {
       c->filename = param;
     }
@@ -760,6 +879,42 @@ print_metrics(Metrics *metrics, Configuration *conf)
           metrics->hamster_metrics.extended_keys);
   printf("\thamsterdb extended_duptables          %lu\n",
           metrics->hamster_metrics.extended_duptables);
+  printf("\thamsterdb extended_key_prefix_hits   %lu\n",
+          metrics->hamster_metrics.extended_key_prefix_hits);
+  printf("\thamsterdb extended_key_prefix_misses %lu\n",
+          metrics->hamster_metrics.extended_key_prefix_misses);
+  printf("\thamsterdb device_mapped_reads        %lu\n",
+          metrics->hamster_metrics.device_mapped_reads);
+  printf("\thamsterdb device_unmapped_reads      %lu\n",
+          metrics->hamster_metrics.device_unmapped_reads);
+  printf("\thamsterdb device_mapped_size         %lu\n",
+          metrics->hamster_metrics.device_mapped_size);
+  printf("\thamsterdb device_prefetch_hits       %lu\n",
+          metrics->hamster_metrics.device_prefetch_hits);
+  printf("\thamsterdb device_writes              %lu\n",
+          metrics->hamster_metrics.device_writes);
+  printf("\thamsterdb device_bytes_written       %lu\n",
+          metrics->hamster_metrics.device_bytes_written);
+  printf("\thamsterdb device_avg_write_size      %lu\n",
+          metrics->hamster_metrics.device_avg_write_size);
+  printf("\thamsterdb journal_commit_syncs       %lu\n",
+          metrics->hamster_metrics.journal_commit_syncs);
+  printf("\thamsterdb journal_synced_commits     %lu\n",
+          metrics->hamster_metrics.journal_synced_commits);
+  printf("\thamsterdb journal_writes             %lu\n",
+          metrics->hamster_metrics.journal_writes);
+  printf("\thamsterdb journal_bytes_written      %lu\n",
+          metrics->hamster_metrics.journal_bytes_written);
+  for (int i = 0; i < HAM_COMMIT_LATENCY_BUCKETS; i++) {
+    if (!metrics->hamster_metrics.txn_commit_latency[i])
+      continue;
+    if (i == 0)
+      printf("\thamsterdb txn_commit_latency < %8u us %lu\n", 16,
+          metrics->hamster_metrics.txn_commit_latency[i]);
+    else
+      printf("\thamsterdb txn_commit_latency >= %7u us %lu\n", 8u << i,
+          metrics->hamster_metrics.txn_commit_latency[i]);
+  }
 }
 
 struct Callable
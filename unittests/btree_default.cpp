@@ -195,6 +195,73 @@ struct BtreeDefaultFixture {
     }
   }
 
+  // Inserts and looks up extended keys; if |same_prefix| is true then
+  // the keys only differ after the inline prefix
+  void extendedKeyPrefixTest(const IntVector &inserts, bool same_prefix) {
+    ham_record_t rec = {0};
+    char buffer[300];
+    ham_env_metrics_t before, after;
+
+    for (IntVector::const_iterator it = inserts.begin();
+            it != inserts.end(); it++) {
+      ham_key_t key = makePrefixKey(*it, buffer, same_prefix);
+      REQUIRE(0 == ham_db_insert(m_db, 0, &key, &rec, 0));
+    }
+    REQUIRE(0 == ham_db_check_integrity(m_db, 0));
+
+    REQUIRE(0 == ham_env_get_metrics(m_env, &before));
+    for (IntVector::const_iterator it = inserts.begin();
+            it != inserts.end(); it++) {
+      ham_key_t key = makePrefixKey(*it, buffer, same_prefix);
+      REQUIRE(0 == ham_db_find(m_db, 0, &key, &rec, 0));
+    }
+    REQUIRE(0 == ham_env_get_metrics(m_env, &after));
+
+    ham_u64_t hits = after.extended_key_prefix_hits
+                        - before.extended_key_prefix_hits;
+    ham_u64_t misses = after.extended_key_prefix_misses
+                        - before.extended_key_prefix_misses;
+    if (same_prefix) {
+      REQUIRE(hits == 0);
+      REQUIRE(misses > inserts.size());
+    }
+    else {
+      // only the final comparison of each lookup (the one with the
+      // matching key) has to read the full key
+      REQUIRE(hits > inserts.size());
+      REQUIRE(misses <= 2 * inserts.size());
+    }
+
+    // lookups of keys which only differ in the last byte
+    ham_key_t key = makePrefixKey(inserts[0], buffer, same_prefix);
+    buffer[sizeof(buffer) - 1] = 'y';
+    REQUIRE(HAM_KEY_NOT_FOUND == ham_db_find(m_db, 0, &key, &rec, 0));
+    key.size = 20;
+    REQUIRE(HAM_KEY_NOT_FOUND == ham_db_find(m_db, 0, &key, &rec, 0));
+
+    for (IntVector::const_iterator it = inserts.begin();
+            it != inserts.end(); it += 2) {
+      ham_key_t key = makePrefixKey(*it, buffer, same_prefix);
+      REQUIRE(0 == ham_db_erase(m_db, 0, &key, 0));
+    }
+    REQUIRE(0 == ham_db_check_integrity(m_db, 0));
+
+    for (ham_u32_t i = 0; i < inserts.size(); i++) {
+      ham_key_t key = makePrefixKey(inserts[i], buffer, same_prefix);
+      REQUIRE((i & 1 ? 0 : HAM_KEY_NOT_FOUND)
+                      == ham_db_find(m_db, 0, &key, &rec, 0));
+    }
+  }
+
+  ham_key_t makePrefixKey(int i, char *buffer, bool same_prefix) {
+    memset(buffer, 'x', 300);
+    sprintf(same_prefix ? &buffer[32] : &buffer[0], "%08d", i);
+    ham_key_t key = {0};
+    key.data = &buffer[0];
+    key.size = 300;
+    return (key);
+  }
+
   void eraseCursorTest(const IntVector &inserts) {
     ham_key_t key = {0};
     ham_cursor_t *cursor;
@@ -451,7 +518,8 @@ TEST_CASE("BtreeDefault/insertExtendedKeySplitTest", "")
   g_split_count = 0;
   BtreeDefaultFixture f;
   f.insertExtendedTest(ivec);
-  REQUIRE(g_split_count == 1);
+  // extended keys store the blob id and a 16 byte prefix
+  REQUIRE(g_split_count == 2);
 }
 
 TEST_CASE("BtreeDefault/insertRandomExtendedKeySplitTest", "")
@@ -466,7 +534,7 @@ TEST_CASE("BtreeDefault/insertRandomExtendedKeySplitTest", "")
   g_split_count = 0;
   BtreeDefaultFixture f;
   f.insertExtendedTest(ivec);
-  REQUIRE(g_split_count == 1);
+  REQUIRE(g_split_count == 3);
 }
 
 TEST_CASE("BtreeDefault/eraseExtendedKeyTest", "")
@@ -490,7 +558,7 @@ TEST_CASE("BtreeDefault/eraseExtendedKeySplitTest", "")
   g_split_count = 0;
   BtreeDefaultFixture f;
   f.insertExtendedTest(ivec);
-  REQUIRE(g_split_count == 1);
+  REQUIRE(g_split_count == 2);
   f.eraseExtendedTest(ivec);
 }
 
@@ -504,7 +572,7 @@ TEST_CASE("BtreeDefault/eraseReverseExtendedKeySplitTest", "")
   g_split_count = 0;
   BtreeDefaultFixture f;
   f.insertExtendedTest(ivec);
-  REQUIRE(g_split_count == 1);
+  REQUIRE(g_split_count == 2);
   std::reverse(ivec.begin(), ivec.end());
   f.eraseExtendedTest(ivec);
 }
@@ -521,10 +589,34 @@ TEST_CASE("BtreeDefault/eraseRandomExtendedKeySplitTest", "")
   g_split_count = 0;
   BtreeDefaultFixture f;
   f.insertExtendedTest(ivec);
-  REQUIRE(g_split_count == 1);
+  REQUIRE(g_split_count == 3);
   f.eraseExtendedTest(ivec);
 }
 
+TEST_CASE("BtreeDefault/extendedKeyPrefixTest", "")
+{
+  BtreeDefaultFixture::IntVector ivec;
+  for (int i = 0; i < 1000; i++)
+    ivec.push_back(i);
+  std::srand(0); // make this reproducable
+  std::random_shuffle(ivec.begin(), ivec.end());
+
+  BtreeDefaultFixture f;
+  f.extendedKeyPrefixTest(ivec, false);
+}
+
+TEST_CASE("BtreeDefault/extendedKeySamePrefixTest", "")
+{
+  BtreeDefaultFixture::IntVector ivec;
+  for (int i = 0; i < 1000; i++)
+    ivec.push_back(i);
+  std::srand(0); // make this reproducable
+  std::random_shuffle(ivec.begin(), ivec.end());
+
+  BtreeDefaultFixture f;
+  f.extendedKeyPrefixTest(ivec, true);
+}
+
 TEST_CASE("BtreeDefault/eraseReverseKeySplitTest", "")
 {
   BtreeDefaultFixture::IntVector ivec;
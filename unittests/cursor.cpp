@@ -19,6 +19,7 @@
 #include "../src/cursor.h"
 #include "../src/btree_index.h"
 #include "../src/btree_cursor.h"
+#include "../src/btree_node_proxy.h"
 
 using namespace hamsterdb;
 
@@ -131,6 +132,402 @@ struct BaseCursorFixture {
     REQUIRE(0 == ham_cursor_close(c));
   }
 
+  void getBatchTest() {
+    const int MAX = 50;
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    ham_key_t keys[7];
+    ham_record_t recs[7];
+    ham_u32_t count;
+    ham_cursor_t *c;
+    char buf[16];
+
+    /* insert the even keys into the btree and the odd keys through the
+     * Transaction (if enabled), then erase one of them */
+    BtreeIndex *be = ((LocalDatabase *)m_db)->get_btree_index();
+    for (int i = 0; i < MAX; i++) {
+      ::sprintf(buf, "%05d", i);
+      key.data = buf;
+      key.size = 6;
+      rec.data = &i;
+      rec.size = sizeof(i);
+      if (i & 1)
+        REQUIRE(0 == ham_db_insert(m_db, m_txn, &key, &rec, 0));
+      else
+        REQUIRE(0 == be->insert(0, 0, &key, &rec, 0));
+    }
+    ::sprintf(buf, "%05d", 20);
+    key.data = buf;
+    key.size = 6;
+    REQUIRE(0 == ham_db_erase(m_db, m_txn, &key, 0));
+
+    REQUIRE(0 == ham_cursor_create(&c, m_db, m_txn, 0));
+
+    /* fetch everything in batches of 7 items */
+    int next = 0;
+    int batches = 0;
+    while (true) {
+      ::memset(&keys, 0, sizeof(keys));
+      ::memset(&recs, 0, sizeof(recs));
+      count = 7;
+      ham_status_t st = ham_cursor_get_batch(c, keys, recs, &count,
+                      HAM_CURSOR_NEXT);
+      if (st == HAM_KEY_NOT_FOUND) {
+        REQUIRE(0u == count);
+        break;
+      }
+      REQUIRE(0 == st);
+      REQUIRE(count > 0u);
+      batches++;
+      for (ham_u32_t j = 0; j < count; j++) {
+        if (next == 20)
+          next++;
+        ::sprintf(buf, "%05d", next);
+        REQUIRE(6u == keys[j].size);
+        REQUIRE(0 == ::strcmp(buf, (char *)keys[j].data));
+        REQUIRE(sizeof(int) == recs[j].size);
+        REQUIRE(next == *(int *)recs[j].data);
+        next++;
+      }
+    }
+    REQUIRE(MAX == next);
+    REQUIRE(7 == batches);
+
+    /* now fetch backwards, starting with the last key; only keys are
+     * requested, and they're copied to a user-allocated buffer */
+    char userbuf[7][6];
+    for (int j = 0; j < 7; j++) {
+      keys[j].data = &userbuf[j][0];
+      keys[j].size = 6;
+      keys[j].flags = HAM_KEY_USER_ALLOC;
+    }
+    count = 7;
+    REQUIRE(0 == ham_cursor_get_batch(c, keys, 0, &count, HAM_CURSOR_LAST));
+    REQUIRE(7u == count);
+    for (int j = 0; j < 7; j++) {
+      ::sprintf(buf, "%05d", MAX - 1 - j);
+      REQUIRE(keys[j].data == &userbuf[j][0]);
+      REQUIRE(0 == ::strcmp(buf, (char *)keys[j].data));
+    }
+
+    /* the cursor is positioned on the last key of the batch */
+    ::memset(&key, 0, sizeof(key));
+    REQUIRE(0 == ham_cursor_move(c, &key, 0, HAM_CURSOR_PREVIOUS));
+    ::sprintf(buf, "%05d", MAX - 8);
+    REQUIRE(0 == ::strcmp(buf, (char *)key.data));
+
+    /* invalid parameters */
+    count = 7;
+    REQUIRE(HAM_INV_PARAMETER ==
+          ham_cursor_get_batch(0, keys, recs, &count, HAM_CURSOR_NEXT));
+    REQUIRE(HAM_INV_PARAMETER ==
+          ham_cursor_get_batch(c, 0, 0, &count, HAM_CURSOR_NEXT));
+    REQUIRE(HAM_INV_PARAMETER ==
+          ham_cursor_get_batch(c, keys, recs, 0, HAM_CURSOR_NEXT));
+    REQUIRE(HAM_INV_PARAMETER ==
+          ham_cursor_get_batch(c, keys, recs, &count, 0));
+    REQUIRE(HAM_INV_PARAMETER ==
+          ham_cursor_get_batch(c, keys, recs, &count,
+                  HAM_CURSOR_NEXT | HAM_PARTIAL));
+
+    REQUIRE(0 == ham_cursor_close(c));
+  }
+
+  static ham_bool_t HAM_CALLCONV oddKeyPredicate(void *context,
+            const ham_key_t *key, ham_u64_t record_size) {
+    (void)record_size;
+    (*(int *)context)++;
+    return (((const char *)key->data)[2] & 1);
+  }
+
+  // moves the cursor with |flags| till the end, and concatenates the keys
+  std::string scanWithFilter(ham_cursor_t *c, ham_u32_t flags) {
+    std::string s;
+    ham_key_t key = {0};
+    ham_status_t st;
+    while ((st = ham_cursor_move(c, &key, 0, flags)) == 0) {
+      s += std::string((const char *)key.data) + " ";
+      if (flags & HAM_CURSOR_FIRST)
+        flags = (flags & ~HAM_CURSOR_FIRST) | HAM_CURSOR_NEXT;
+      if (flags & HAM_CURSOR_LAST)
+        flags = (flags & ~HAM_CURSOR_LAST) | HAM_CURSOR_PREVIOUS;
+    }
+    REQUIRE(HAM_KEY_NOT_FOUND == st);
+    return (s);
+  }
+
+  void filterTest() {
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    ham_cursor_t *c;
+    ham_cursor_filter_t filter;
+    char buf[16];
+    char data[8] = {0};
+
+    /* insert "a00" .. "c09"; the record size is (i % 4) + 1; the even keys
+     * are inserted into the btree, the odd keys through the Transaction */
+    BtreeIndex *be = ((LocalDatabase *)m_db)->get_btree_index();
+    for (int i = 0; i < 30; i++) {
+      ::sprintf(buf, "%c%02d", 'a' + i / 10, i % 10);
+      key.data = buf;
+      key.size = 4;
+      rec.data = data;
+      rec.size = (i % 4) + 1;
+      if (i & 1)
+        REQUIRE(0 == ham_db_insert(m_db, m_txn, &key, &rec, 0));
+      else
+        REQUIRE(0 == be->insert(0, 0, &key, &rec, 0));
+    }
+
+    REQUIRE(0 == ham_cursor_create(&c, m_db, m_txn, 0));
+
+    /* prefix */
+    ham_key_t prefix = {0};
+    prefix.data = (void *)"b";
+    prefix.size = 1;
+    ::memset(&filter, 0, sizeof(filter));
+    filter.prefix = &prefix;
+    REQUIRE(0 == ham_cursor_set_filter(c, &filter));
+    REQUIRE(scanWithFilter(c, HAM_CURSOR_NEXT)
+          == "b00 b01 b02 b03 b04 b05 b06 b07 b08 b09 ");
+    REQUIRE(scanWithFilter(c, HAM_CURSOR_LAST)
+          == "b09 b08 b07 b06 b05 b04 b03 b02 b01 b00 ");
+
+    /* key range */
+    ham_key_t lower = {0}, upper = {0};
+    lower.data = (void *)"a07";
+    lower.size = 4;
+    upper.data = (void *)"b02";
+    upper.size = 4;
+    ::memset(&filter, 0, sizeof(filter));
+    filter.lower_bound = &lower;
+    filter.upper_bound = &upper;
+    REQUIRE(0 == ham_cursor_set_filter(c, &filter));
+    REQUIRE(scanWithFilter(c, HAM_CURSOR_FIRST)
+          == "a07 a08 a09 b00 b01 b02 ");
+    REQUIRE(scanWithFilter(c, HAM_CURSOR_LAST)
+          == "b02 b01 b00 a09 a08 a07 ");
+
+    /* record size bounds; the filter is copied, therefore the bounds
+     * do not have to stay alive */
+    {
+      ham_key_t lower2 = {0};
+      lower2.data = (void *)"c00";
+      lower2.size = 4;
+      ::memset(&filter, 0, sizeof(filter));
+      filter.lower_bound = &lower2;
+      filter.min_record_size = 2;
+      filter.max_record_size = 3;
+      REQUIRE(0 == ham_cursor_set_filter(c, &filter));
+      lower2.data = (void *)"xxx";
+    }
+    REQUIRE(scanWithFilter(c, HAM_CURSOR_FIRST)
+          == "c01 c02 c05 c06 c09 ");
+
+    /* predicate */
+    int calls = 0;
+    ::memset(&filter, 0, sizeof(filter));
+    filter.prefix = &prefix;
+    filter.predicate = oddKeyPredicate;
+    filter.predicate_context = &calls;
+    REQUIRE(0 == ham_cursor_set_filter(c, &filter));
+    REQUIRE(scanWithFilter(c, HAM_CURSOR_FIRST)
+          == "b01 b03 b05 b07 b09 ");
+    REQUIRE(10 == calls);
+
+    /* the filter is also applied to ham_cursor_get_batch */
+    ham_key_t keys[20];
+    ham_u32_t count = 20;
+    ::memset(&keys[0], 0, sizeof(keys));
+    REQUIRE(0 == ham_cursor_get_batch(c, keys, 0, &count, HAM_CURSOR_FIRST));
+    REQUIRE(5u == count);
+    REQUIRE(0 == ::strcmp("b09", (char *)keys[4].data));
+
+    /* remove the filter */
+    REQUIRE(0 == ham_cursor_set_filter(c, 0));
+    count = 20;
+    REQUIRE(0 == ham_cursor_get_batch(c, keys, 0, &count, HAM_CURSOR_FIRST));
+    REQUIRE(20u == count);
+
+    ::memset(&filter, 0, sizeof(filter));
+    filter.min_record_size = 3;
+    filter.max_record_size = 2;
+    REQUIRE(HAM_INV_PARAMETER == ham_cursor_set_filter(c, &filter));
+    REQUIRE(HAM_INV_PARAMETER == ham_cursor_set_filter(0, &filter));
+
+    REQUIRE(0 == ham_cursor_close(c));
+  }
+
+  void prefixScanTest() {
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    ham_cursor_t *c;
+    ham_cursor_filter_t filter;
+    char buf[16];
+    char data[8] = {0};
+
+    /* insert "a/0" .. "d/4"; the even keys are inserted into the btree,
+     * the odd keys through the Transaction */
+    BtreeIndex *be = ((LocalDatabase *)m_db)->get_btree_index();
+    for (int i = 0; i < 20; i++) {
+      ::sprintf(buf, "%c/%d", 'a' + i / 5, i % 5);
+      key.data = buf;
+      key.size = 4;
+      rec.data = data;
+      rec.size = i + 1;
+      if (i & 1)
+        REQUIRE(0 == ham_db_insert(m_db, m_txn, &key, &rec, 0));
+      else
+        REQUIRE(0 == be->insert(0, 0, &key, &rec, 0));
+    }
+
+    REQUIRE(0 == ham_cursor_create(&c, m_db, m_txn, 0));
+
+    /* prefix lookup; binds the cursor to the prefix */
+    key.data = (void *)"b/";
+    key.size = 2;
+    REQUIRE(0 == ham_cursor_find(c, &key, &rec, HAM_FIND_PREFIX_MATCH));
+    REQUIRE(0 == ::strcmp("b/0", (char *)key.data));
+    REQUIRE(6u == rec.size);
+    REQUIRE(scanWithFilter(c, HAM_CURSOR_NEXT) == "b/1 b/2 b/3 b/4 ");
+    REQUIRE(scanWithFilter(c, HAM_CURSOR_LAST)
+          == "b/4 b/3 b/2 b/1 b/0 ");
+
+    key.data = (void *)"x";
+    key.size = 1;
+    REQUIRE(HAM_KEY_NOT_FOUND
+          == ham_cursor_find(c, &key, 0, HAM_FIND_PREFIX_MATCH));
+
+    /* FIRST and LAST jump directly to the range */
+    ham_key_t prefix = {0};
+    prefix.data = (void *)"c";
+    prefix.size = 1;
+    ::memset(&filter, 0, sizeof(filter));
+    filter.prefix = &prefix;
+    REQUIRE(0 == ham_cursor_set_filter(c, &filter));
+    REQUIRE(scanWithFilter(c, HAM_CURSOR_FIRST)
+          == "c/0 c/1 c/2 c/3 c/4 ");
+    REQUIRE(scanWithFilter(c, HAM_CURSOR_LAST)
+          == "c/4 c/3 c/2 c/1 c/0 ");
+
+    ham_key_t upper = {0};
+    upper.data = (void *)"a/2";
+    upper.size = 4;
+    ::memset(&filter, 0, sizeof(filter));
+    filter.upper_bound = &upper;
+    REQUIRE(0 == ham_cursor_set_filter(c, &filter));
+    REQUIRE(scanWithFilter(c, HAM_CURSOR_LAST) == "a/2 a/1 a/0 ");
+
+    /* skip-scan over the distinct prefixes */
+    REQUIRE(0 == ham_cursor_set_filter(c, 0));
+    REQUIRE(0 == ham_cursor_move(c, &key, 0, HAM_CURSOR_FIRST));
+    std::string s;
+    while (0 == ham_cursor_skip_prefix(c, 1, &key, &rec, 0))
+      s += std::string((char *)key.data) + " ";
+    REQUIRE(s == "b/0 c/0 d/0 ");
+    /* the position is not changed if there is no next prefix */
+    REQUIRE(0 == ham_cursor_move(c, &key, &rec, 0));
+    REQUIRE(0 == ::strcmp("d/0", (char *)key.data));
+    REQUIRE(16u == rec.size);
+
+    s.clear();
+    while (0 == ham_cursor_skip_prefix(c, 1, &key, 0, HAM_CURSOR_PREVIOUS))
+      s += std::string((char *)key.data) + " ";
+    REQUIRE(s == "c/4 b/4 a/4 ");
+
+    /* keys which are shorter than the prefix only share it with
+     * identical keys */
+    REQUIRE(0 == ham_cursor_move(c, &key, 0, HAM_CURSOR_FIRST));
+    REQUIRE(0 == ham_cursor_skip_prefix(c, 10, &key, 0, HAM_CURSOR_NEXT));
+    REQUIRE(0 == ::strcmp("a/1", (char *)key.data));
+
+    /* the filter is applied to the new position */
+    ham_key_t lower = {0};
+    lower.data = (void *)"b/2";
+    lower.size = 4;
+    ::memset(&filter, 0, sizeof(filter));
+    filter.lower_bound = &lower;
+    REQUIRE(0 == ham_cursor_set_filter(c, &filter));
+    REQUIRE(0 == ham_cursor_skip_prefix(c, 1, &key, 0, 0));
+    REQUIRE(0 == ::strcmp("b/2", (char *)key.data));
+
+    REQUIRE(HAM_INV_PARAMETER == ham_cursor_skip_prefix(c, 0, 0, 0, 0));
+    REQUIRE(HAM_INV_PARAMETER
+          == ham_cursor_skip_prefix(c, 1, 0, 0, HAM_CURSOR_FIRST));
+    REQUIRE(HAM_INV_PARAMETER == ham_cursor_skip_prefix(0, 1, 0, 0, 0));
+    REQUIRE(HAM_INV_PARAMETER
+          == ham_cursor_find(c, &key, 0,
+                  HAM_FIND_PREFIX_MATCH | HAM_FIND_GEQ_MATCH));
+    key.data = (void *)"a";
+    key.size = 1;
+    REQUIRE(HAM_INV_PARAMETER
+          == ham_db_find(m_db, m_txn, &key, &rec, HAM_FIND_PREFIX_MATCH));
+
+    REQUIRE(0 == ham_cursor_close(c));
+  }
+
+  void prefixBoundaryTest() {
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    ham_cursor_t *c;
+    char buf[16];
+
+    for (int i = 0; i < 3000; i++) {
+      ::sprintf(buf, "k%05d", i);
+      key.data = buf;
+      key.size = 7;
+      REQUIRE(0 == ham_db_insert(m_db, 0, &key, &rec, 0));
+    }
+
+    /* find the last key of the first leaf */
+    REQUIRE(0 == ham_cursor_create(&c, m_db, 0, 0));
+    REQUIRE(0 == ham_cursor_move(c, &key, 0, HAM_CURSOR_FIRST));
+    BtreeCursor *btc = ((Cursor *)c)->get_btree_cursor();
+    Page *leaf;
+    btc->get_coupled_key(&leaf, 0);
+    BtreeNodeProxy *node = ((LocalDatabase *)m_db)->get_btree_index()
+                ->get_node_from_page(leaf);
+    REQUIRE(node->get_right() != 0);
+    int count = (int)node->get_count();
+
+    /* bind the scan to this key; the scan terminates without moving
+     * to the next leaf */
+    ham_key_t upper = {0};
+    ::sprintf(buf, "k%05d", count - 1);
+    upper.data = buf;
+    upper.size = 7;
+    ham_cursor_filter_t filter;
+    ::memset(&filter, 0, sizeof(filter));
+    filter.upper_bound = &upper;
+    REQUIRE(0 == ham_cursor_set_filter(c, &filter));
+
+    int i = 0;
+    ham_status_t st;
+    ham_u32_t flags = HAM_CURSOR_FIRST;
+    while ((st = ham_cursor_move(c, &key, 0, flags)) == 0) {
+      flags = HAM_CURSOR_NEXT;
+      i++;
+    }
+    REQUIRE(HAM_KEY_NOT_FOUND == st);
+    REQUIRE(count == i);
+    Page *page;
+    btc->get_coupled_key(&page, 0);
+    REQUIRE(page == leaf);
+    REQUIRE(0 == ham_cursor_move(c, &key, 0, 0));
+    REQUIRE(0 == ::strcmp(buf, (char *)key.data));
+
+    /* skip-scan: "k000" -> "k001" -> ... */
+    REQUIRE(0 == ham_cursor_set_filter(c, 0));
+    REQUIRE(0 == ham_cursor_move(c, &key, 0, HAM_CURSOR_FIRST));
+    i = 0;
+    while (0 == ham_cursor_skip_prefix(c, 4, &key, 0, 0))
+      i++;
+    REQUIRE(29 == i);
+    REQUIRE(0 == ::strcmp("k02900", (char *)key.data));
+
+    REQUIRE(0 == ham_cursor_close(c));
+  }
+
   void insertFindTest() {
     ham_key_t key = {0};
     ham_record_t rec = {0};
@@ -305,6 +702,30 @@ TEST_CASE("Cursor-temptxn/insertFindTest", "")
   f.insertFindTest();
 }
 
+TEST_CASE("Cursor-temptxn/getBatchTest", "")
+{
+  TempTxnCursorFixture f;
+  f.getBatchTest();
+}
+
+TEST_CASE("Cursor-temptxn/filterTest", "")
+{
+  TempTxnCursorFixture f;
+  f.filterTest();
+}
+
+TEST_CASE("Cursor-temptxn/prefixScanTest", "")
+{
+  TempTxnCursorFixture f;
+  f.prefixScanTest();
+}
+
+TEST_CASE("Cursor-temptxn/prefixBoundaryTest", "")
+{
+  TempTxnCursorFixture f;
+  f.prefixBoundaryTest();
+}
+
 TEST_CASE("Cursor-temptxn/insertFindMultipleCursorsTest", "")
 {
   TempTxnCursorFixture f;
@@ -461,6 +882,30 @@ TEST_CASE("Cursor-inmem/getRecordSizeTest", "")
   f.getRecordSizeTest();
 }
 
+TEST_CASE("Cursor-inmem/getBatchTest", "")
+{
+  InMemoryCursorFixture f;
+  f.getBatchTest();
+}
+
+TEST_CASE("Cursor-inmem/filterTest", "")
+{
+  InMemoryCursorFixture f;
+  f.filterTest();
+}
+
+TEST_CASE("Cursor-inmem/prefixScanTest", "")
+{
+  InMemoryCursorFixture f;
+  f.prefixScanTest();
+}
+
+TEST_CASE("Cursor-inmem/prefixBoundaryTest", "")
+{
+  InMemoryCursorFixture f;
+  f.prefixBoundaryTest();
+}
+
 
 struct LongTxnCursorFixture : public BaseCursorFixture {
   LongTxnCursorFixture() {
@@ -3512,6 +3957,24 @@ TEST_CASE("Cursor-longtxn/getRecordSizeTest", "")
   f.getRecordSizeTest();
 }
 
+TEST_CASE("Cursor-longtxn/getBatchTest", "")
+{
+  LongTxnCursorFixture f;
+  f.getBatchTest();
+}
+
+TEST_CASE("Cursor-longtxn/filterTest", "")
+{
+  LongTxnCursorFixture f;
+  f.filterTest();
+}
+
+TEST_CASE("Cursor-longtxn/prefixScanTest", "")
+{
+  LongTxnCursorFixture f;
+  f.prefixScanTest();
+}
+
 TEST_CASE("Cursor-longtxn/insertFindTest", "")
 {
   LongTxnCursorFixture f;
@@ -25,6 +25,7 @@
 #include "../src/btree_index.h"
 #include "../src/btree_index_factory.h"
 #include "../src/blob_manager.h"
+#include "../src/freelist_bitmap.h"
 #include "../src/page_manager.h"
 #include "../src/txn.h"
 #include "../src/log.h"
@@ -11,6 +11,8 @@
 
 #include "../src/config.h"
 
+#include <vector>
+
 #include "3rdparty/catch/catch.hpp"
 
 #include "globals.h"
@@ -27,12 +29,12 @@ struct DeviceFixture
   ham_env_t *m_env;
   Device *m_dev;
 
-  DeviceFixture(bool inmemory) {
+  DeviceFixture(bool inmemory, ham_u32_t flags = 0) {
     (void)os::unlink(Globals::opath(".test"));
 
     REQUIRE(0 ==
         ham_env_create(&m_env, Globals::opath(".test"),
-            inmemory ? HAM_IN_MEMORY : 0, 0644, 0));
+            (inmemory ? HAM_IN_MEMORY : 0) | flags, 0644, 0));
     REQUIRE(0 ==
         ham_env_create_db(m_env, &m_db, 1, 0, 0));
     m_dev = ((LocalEnvironment *)m_env)->get_device();
@@ -45,11 +47,13 @@ struct DeviceFixture
   void newDeleteTest() {
   }
 
+  // the Environment's pages must not point into the mapped area while
+  // the device is closed; therefore mmap is disabled for these tests
   void createCloseTest() {
     REQUIRE(true == m_dev->is_open());
     m_dev->close();
     REQUIRE(false == m_dev->is_open());
-    m_dev->open(Globals::opath(".test"), 0);
+    m_dev->open(Globals::opath(".test"), HAM_DISABLE_MMAP);
     REQUIRE(true == m_dev->is_open());
   }
 
@@ -57,11 +61,11 @@ struct DeviceFixture
     REQUIRE(true == m_dev->is_open());
      m_dev->close();
     REQUIRE(false == m_dev->is_open());
-    m_dev->open(Globals::opath(".test"), 0);
+    m_dev->open(Globals::opath(".test"), HAM_DISABLE_MMAP);
     REQUIRE(true == m_dev->is_open());
     m_dev->close();
     REQUIRE(false == m_dev->is_open());
-    m_dev->open(Globals::opath(".test"), 0);
+    m_dev->open(Globals::opath(".test"), HAM_DISABLE_MMAP);
     REQUIRE(true == m_dev->is_open());
   }
 
@@ -125,6 +129,45 @@ struct DeviceFixture
     free(temp);
   }
 
+  void growMappingTest() {
+    LocalEnvironment *lenv = (LocalEnvironment *)m_env;
+    ham_u32_t ps = lenv->get_page_size();
+    std::vector<ham_u64_t> addresses;
+    ham_env_metrics_t before = {0};
+    ham_env_metrics_t after = {0};
+
+    m_dev->get_metrics(&before);
+
+    // grow the file way beyond the initial mapping; all new pages
+    // are mapped
+    for (int i = 0; i < 1000; i++) {
+      Page *page = new Page(lenv);
+      m_dev->alloc_page(page);
+      REQUIRE((page->get_flags() & Page::kNpersMalloc) == 0);
+      REQUIRE(true == m_dev->is_mapped(page->get_address(), ps));
+      memset(page->get_data(), i & 0xff, ps);
+      m_dev->write_page(page);
+      addresses.push_back(page->get_address());
+      delete page;
+    }
+
+    m_dev->get_metrics(&after);
+    REQUIRE(after.device_mapped_size >= addresses.back() + ps);
+    REQUIRE(after.device_mapped_reads == before.device_mapped_reads + 1000);
+    REQUIRE(after.device_unmapped_reads == before.device_unmapped_reads);
+
+    // the written data is read back from the mapping
+    std::vector<ham_u8_t> temp(ps);
+    for (int i = 0; i < 1000; i++) {
+      Page *page = new Page(lenv);
+      page->set_address(addresses[i]);
+      m_dev->read_page(page);
+      memset(&temp[0], i & 0xff, ps);
+      REQUIRE(0 == memcmp(page->get_data(), &temp[0], ps));
+      delete page;
+    }
+  }
+
   void readWriteTest() {
     int i;
     ham_u8_t *buffer[10] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
@@ -193,13 +236,13 @@ TEST_CASE("Device/newDelete", "")
 
 TEST_CASE("Device/createClose", "")
 {
-  DeviceFixture f(false);
+  DeviceFixture f(false, HAM_DISABLE_MMAP);
   f. createCloseTest();
 }
 
 TEST_CASE("Device/openClose", "")
 {
-  DeviceFixture f(false);
+  DeviceFixture f(false, HAM_DISABLE_MMAP);
   f. openCloseTest();
 }
 
@@ -227,6 +270,12 @@ TEST_CASE("Device/mmapUnmap", "")
   f. mmapUnmapTest();
 }
 
+TEST_CASE("Device/growMapping", "")
+{
+  DeviceFixture f(false);
+  f.growMappingTest();
+}
+
 TEST_CASE("Device/readWrite", "")
 {
   DeviceFixture f(false);
@@ -22,6 +22,9 @@
 #include "../src/db_local.h"
 #include "../src/env.h"
 #include "../src/env_header.h"
+#include "../src/env_local.h"
+#include "../src/device.h"
+#include "../src/device_async.h"
 
 using namespace hamsterdb;
 
@@ -1565,3 +1568,1126 @@ TEST_CASE("Env-inmem/createOpenEmptyTest", "")
   f.createOpenEmptyTest();
 }
 
+
+struct CompactFixture {
+  ham_env_t *m_env;
+  ham_db_t *m_db;
+  ham_u32_t m_env_flags;
+  ham_u32_t m_freelist_type;
+  ham_u32_t m_db_flags;
+  ham_u32_t m_key_size;
+  ham_u32_t m_record_size;
+  ham_u32_t m_duplicates;
+
+  CompactFixture(ham_u32_t env_flags = HAM_DISABLE_MMAP,
+                  ham_u32_t freelist_type = HAM_FREELIST_BITMAP,
+                  ham_u32_t db_flags = 0, ham_u32_t page_size = 1024)
+    : m_env(0), m_db(0), m_env_flags(env_flags),
+      m_freelist_type(freelist_type), m_db_flags(db_flags),
+      m_key_size(8), m_record_size(64), m_duplicates(1) {
+    os::unlink(Globals::opath(".test"));
+    ham_parameter_t params[] = {
+      { HAM_PARAM_PAGE_SIZE, page_size },
+      { HAM_PARAM_FREELIST_TYPE, freelist_type },
+      { 0, 0 }
+    };
+    REQUIRE(0 == ham_env_create(&m_env, Globals::opath(".test"),
+                m_env_flags, 0664, &params[0]));
+    REQUIRE(0 == ham_env_create_db(m_env, &m_db, 1, m_db_flags, 0));
+  }
+
+  ~CompactFixture() {
+    if (m_env)
+      (void)ham_env_close(m_env, HAM_AUTO_CLEANUP);
+  }
+
+  ham_u64_t get_filesize() {
+    return (((LocalEnvironment *)m_env)->get_device()->get_filesize());
+  }
+
+  void make_key(ham_u32_t i, ham_key_t *key, std::vector<char> &buffer) {
+    buffer.resize(m_key_size);
+    memset(&buffer[0], 'k', m_key_size);
+    char tmp[16];
+    sprintf(tmp, "%08u", i);
+    memcpy(&buffer[0], tmp, 8);
+    key->data = &buffer[0];
+    key->size = m_key_size;
+  }
+
+  void make_record(ham_u32_t i, ham_u32_t dup, ham_record_t *record,
+                  std::vector<char> &buffer) {
+    buffer.resize(m_record_size);
+    memset(&buffer[0], 'a' + (i % 26), m_record_size);
+    memcpy(&buffer[0], &i, sizeof(i));
+    memcpy(&buffer[sizeof(i)], &dup, sizeof(dup));
+    record->data = &buffer[0];
+    record->size = m_record_size;
+  }
+
+  void insert(ham_u32_t start, ham_u32_t end) {
+    std::vector<char> kbuf, rbuf;
+    for (ham_u32_t i = start; i < end; i++) {
+      for (ham_u32_t d = 0; d < m_duplicates; d++) {
+        ham_key_t key = {0};
+        ham_record_t rec = {0};
+        make_key(i, &key, kbuf);
+        make_record(i, d, &rec, rbuf);
+        REQUIRE(0 == ham_db_insert(m_db, 0, &key, &rec,
+                    m_duplicates > 1 ? HAM_DUPLICATE : 0));
+      }
+    }
+  }
+
+  void erase(ham_u32_t start, ham_u32_t end) {
+    std::vector<char> kbuf;
+    for (ham_u32_t i = start; i < end; i++) {
+      ham_key_t key = {0};
+      make_key(i, &key, kbuf);
+      REQUIRE(0 == ham_db_erase(m_db, 0, &key, 0));
+    }
+  }
+
+  void verify(ham_u32_t start, ham_u32_t end) {
+    std::vector<char> kbuf, rbuf;
+    ham_cursor_t *cursor;
+    REQUIRE(0 == ham_cursor_create(&cursor, m_db, 0, 0));
+    for (ham_u32_t i = start; i < end; i++) {
+      ham_key_t key = {0};
+      ham_record_t rec = {0};
+      ham_record_t expected = {0};
+      make_key(i, &key, kbuf);
+      REQUIRE(0 == ham_cursor_find(cursor, &key, &rec, 0));
+      for (ham_u32_t d = 0; d < m_duplicates; d++) {
+        if (d > 0)
+          REQUIRE(0 == ham_cursor_move(cursor, 0, &rec,
+                      HAM_CURSOR_NEXT | HAM_ONLY_DUPLICATES));
+        make_record(i, d, &expected, rbuf);
+        REQUIRE(rec.size == expected.size);
+        REQUIRE(0 == memcmp(rec.data, expected.data, rec.size));
+      }
+    }
+    ham_u64_t count;
+    REQUIRE(0 == ham_db_get_key_count(m_db, 0, 0, &count));
+    REQUIRE((ham_u64_t)((end - start) * m_duplicates) == count);
+    REQUIRE(0 == ham_cursor_close(cursor));
+    REQUIRE(0 == ham_db_check_integrity(m_db, 0));
+  }
+
+  ham_u64_t compact(ham_u32_t max_pages, ham_u32_t flags = 0) {
+    ham_u64_t total = 0;
+    ham_u64_t reclaimed;
+    do {
+      REQUIRE(0 == ham_env_compact(m_env, max_pages, &reclaimed, flags));
+      total += reclaimed;
+    } while (reclaimed > 0);
+    return (total);
+  }
+
+  void reopen() {
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+    REQUIRE(0 == ham_env_open(&m_env, Globals::opath(".test"),
+                HAM_DISABLE_MMAP
+                    | (m_env_flags & HAM_ENABLE_RECOVERY
+                        ? HAM_AUTO_RECOVERY
+                        : 0), 0));
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+  }
+
+  // the pages of the bitmap freelist are not moved; if one of them is
+  // stored at the end of the file then the file can only shrink till
+  // this page
+  void check_filesize(ham_u64_t before) {
+    if (m_freelist_type == HAM_FREELIST_EXTENT)
+      REQUIRE(get_filesize() < before / 2);
+    else
+      REQUIRE(get_filesize() < before);
+  }
+
+  // inserts keys, deletes most of them from the beginning of the file
+  // and compacts the file; the remaining keys must still be intact
+  void compactTest(ham_u32_t flags = 0) {
+    insert(0, 2000);
+    erase(0, 1800);
+    REQUIRE(0 == ham_env_flush(m_env, 0));
+
+    ham_u64_t before = get_filesize();
+    ham_u64_t reclaimed = compact(16, flags);
+    REQUIRE(reclaimed > 0);
+    REQUIRE(get_filesize() == before - reclaimed);
+    check_filesize(before);
+    verify(1800, 2000);
+
+    // the database remains fully functional
+    insert(3000, 3100);
+    erase(3000, 3100);
+    verify(1800, 2000);
+
+    reopen();
+    verify(1800, 2000);
+  }
+
+  void parameterTest() {
+    ham_u64_t reclaimed;
+    REQUIRE(HAM_INV_PARAMETER == ham_env_compact(0, 16, &reclaimed, 0));
+    REQUIRE(HAM_INV_PARAMETER == ham_env_compact(m_env, 16, 0, 0));
+    REQUIRE(HAM_INV_PARAMETER == ham_env_compact(m_env, 0, &reclaimed, 0));
+    REQUIRE(HAM_INV_PARAMETER == ham_env_compact(m_env, 16, &reclaimed,
+                0x1000));
+
+    // nothing to compact
+    REQUIRE(0 == ham_env_compact(m_env, 16, &reclaimed, 0));
+    REQUIRE(0ull == reclaimed);
+
+    // read-only environments can not be compacted
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+    REQUIRE(0 == ham_env_open(&m_env, Globals::opath(".test"),
+                HAM_READ_ONLY, 0));
+    REQUIRE(HAM_WRITE_PROTECTED == ham_env_compact(m_env, 16,
+                &reclaimed, 0));
+  }
+
+  void inMemoryTest() {
+    ham_env_t *env;
+    ham_u64_t reclaimed = 1;
+    REQUIRE(0 == ham_env_create(&env, 0, HAM_IN_MEMORY, 0, 0));
+    REQUIRE(0 == ham_env_compact(env, 16, &reclaimed, 0));
+    REQUIRE(0ull == reclaimed);
+    REQUIRE(0 == ham_env_close(env, 0));
+  }
+
+  // the database is not open while the environment is compacted
+  void closedDatabaseTest() {
+    insert(0, 2000);
+    erase(0, 1800);
+    REQUIRE(0 == ham_db_close(m_db, 0));
+
+    ham_u64_t before = get_filesize();
+    REQUIRE(compact(16) > 0);
+    check_filesize(before);
+
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+    verify(1800, 2000);
+  }
+
+  // a cursor which is coupled to a moved page remains valid
+  void cursorTest() {
+    insert(0, 2000);
+    erase(0, 1800);
+
+    std::vector<char> kbuf;
+    ham_key_t key = {0};
+    make_key(1900, &key, kbuf);
+    ham_cursor_t *cursor;
+    REQUIRE(0 == ham_cursor_create(&cursor, m_db, 0, 0));
+    REQUIRE(0 == ham_cursor_find(cursor, &key, 0, 0));
+
+    REQUIRE(compact(16) > 0);
+
+    for (ham_u32_t i = 1901; i < 2000; i++) {
+      ham_key_t k = {0};
+      REQUIRE(0 == ham_cursor_move(cursor, &k, 0, HAM_CURSOR_NEXT));
+      make_key(i, &key, kbuf);
+      REQUIRE(k.size == key.size);
+      REQUIRE(0 == memcmp(k.data, key.data, k.size));
+    }
+    REQUIRE(HAM_KEY_NOT_FOUND == ham_cursor_move(cursor, 0, 0,
+                HAM_CURSOR_NEXT));
+    REQUIRE(0 == ham_cursor_close(cursor));
+  }
+};
+
+TEST_CASE("Env-compact/parameterTest", "")
+{
+  CompactFixture f;
+  f.parameterTest();
+}
+
+TEST_CASE("Env-compact/inMemoryTest", "")
+{
+  CompactFixture f;
+  f.inMemoryTest();
+}
+
+TEST_CASE("Env-compact/compactTest", "")
+{
+  CompactFixture f;
+  f.compactTest();
+}
+
+TEST_CASE("Env-compact/compactExtentFreelistTest", "")
+{
+  CompactFixture f(HAM_DISABLE_MMAP, HAM_FREELIST_EXTENT);
+  f.compactTest();
+}
+
+TEST_CASE("Env-compact/compactRecoveryTest", "")
+{
+  CompactFixture f(HAM_DISABLE_MMAP | HAM_ENABLE_RECOVERY);
+  f.compactTest();
+}
+
+TEST_CASE("Env-compact/compactPunchHolesTest", "")
+{
+  CompactFixture f;
+  f.compactTest(HAM_COMPACT_PUNCH_HOLES);
+}
+
+TEST_CASE("Env-compact/compactExtendedKeysTest", "")
+{
+  CompactFixture f;
+  f.m_key_size = 300;
+  f.compactTest();
+}
+
+TEST_CASE("Env-compact/compactLargeRecordsTest", "")
+{
+  CompactFixture f(HAM_DISABLE_MMAP, HAM_FREELIST_EXTENT);
+  f.m_record_size = 3000;
+  f.compactTest();
+}
+
+TEST_CASE("Env-compact/compactDuplicatesTest", "")
+{
+  CompactFixture f(HAM_DISABLE_MMAP, HAM_FREELIST_EXTENT,
+                  HAM_ENABLE_DUPLICATE_KEYS);
+  f.m_duplicates = 3;
+  f.compactTest();
+}
+
+TEST_CASE("Env-compact/compactDuplicateTablesTest", "")
+{
+  CompactFixture f(HAM_DISABLE_MMAP, HAM_FREELIST_EXTENT,
+                  HAM_ENABLE_DUPLICATE_KEYS, 4096);
+  f.m_duplicates = 70;
+  f.compactTest();
+}
+
+TEST_CASE("Env-compact/closedDatabaseTest", "")
+{
+  CompactFixture f;
+  f.closedDatabaseTest();
+}
+
+TEST_CASE("Env-compact/cursorTest", "")
+{
+  CompactFixture f;
+  f.cursorTest();
+}
+
+struct FileGrowthFixture {
+  ham_env_t *m_env;
+  ham_db_t *m_db;
+
+  FileGrowthFixture()
+    : m_env(0), m_db(0) {
+    os::unlink(Globals::opath(".test"));
+  }
+
+  ~FileGrowthFixture() {
+    if (m_env)
+      (void)ham_env_close(m_env, HAM_AUTO_CLEANUP);
+  }
+
+  ham_u64_t get_physical_filesize() {
+    return (os::file_size(Globals::opath(".test")));
+  }
+
+  void insert(int start, int end) {
+    char buffer[200] = {0};
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    rec.data = buffer;
+    rec.size = sizeof(buffer);
+
+    for (int i = start; i < end; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ham_db_insert(m_db, 0, &key, &rec, 0));
+    }
+  }
+
+  void verify(int count) {
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+
+    for (int i = 0; i < count; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ham_db_find(m_db, 0, &key, &rec, 0));
+      REQUIRE(200u == rec.size);
+    }
+  }
+
+  void invalidParameterTest() {
+    ham_parameter_t params[] = {
+        { HAM_PARAM_FILE_GROWTH_SIZE, 1024 * 1024 },
+        { 0, 0 }
+    };
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_create(&m_env, 0, HAM_IN_MEMORY, 0, &params[0]));
+  }
+
+  void getParameterTest() {
+    ham_parameter_t params[] = {
+        { HAM_PARAM_FILE_GROWTH_SIZE, 1024 * 1024 },
+        { 0, 0 }
+    };
+    REQUIRE(0 ==
+        ham_env_create(&m_env, Globals::opath(".test"), 0, 0644, &params[0]));
+
+    params[0].value = 0;
+    REQUIRE(0 == ham_env_get_parameters(m_env, &params[0]));
+    REQUIRE((ham_u64_t)(1024 * 1024) == params[0].value);
+  }
+
+  void growTest(ham_u32_t flags) {
+    ham_u64_t growth = 1024 * 1024;
+    ham_parameter_t params[] = {
+        { HAM_PARAM_FILE_GROWTH_SIZE, growth },
+        { HAM_PARAM_PAGESIZE, 1024 },
+        { 0, 0 }
+    };
+    REQUIRE(0 ==
+        ham_env_create(&m_env, Globals::opath(".test"), flags, 0644,
+            &params[0]));
+    REQUIRE(0 == ham_env_create_db(m_env, &m_db, 1, 0, 0));
+    insert(0, 1000);
+
+    // the file grows in steps of |growth| bytes, but the Environment
+    // only sees the pages that are actually in use
+    Device *device = ((LocalEnvironment *)m_env)->get_device();
+    ham_u64_t logical = device->get_filesize();
+    ham_u64_t physical = get_physical_filesize();
+    REQUIRE(logical > 0);
+    REQUIRE(logical < growth);
+    REQUIRE(physical >= growth);
+
+    // the unused tail is trimmed when the file is closed
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+    m_env = 0;
+    REQUIRE(get_physical_filesize() < growth);
+
+    // the file grows again after reopening
+    params[1].name = 0;
+    REQUIRE(0 ==
+        ham_env_open(&m_env, Globals::opath(".test"), flags, &params[0]));
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+    verify(1000);
+    insert(1000, 2000);
+    verify(2000);
+    REQUIRE(get_physical_filesize() >= growth);
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+    m_env = 0;
+
+    REQUIRE(0 == ham_env_open(&m_env, Globals::opath(".test"), 0, 0));
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+    verify(2000);
+  }
+};
+
+TEST_CASE("Env-growth/invalidParameterTest", "")
+{
+  FileGrowthFixture f;
+  f.invalidParameterTest();
+}
+
+TEST_CASE("Env-growth/getParameterTest", "")
+{
+  FileGrowthFixture f;
+  f.getParameterTest();
+}
+
+TEST_CASE("Env-growth/growTest", "")
+{
+  FileGrowthFixture f;
+  f.growTest(0);
+}
+
+TEST_CASE("Env-growth/growNoMmapTest", "")
+{
+  FileGrowthFixture f;
+  f.growTest(HAM_DISABLE_MMAP);
+}
+
+TEST_CASE("Env-growth/growRecoveryTest", "")
+{
+  FileGrowthFixture f;
+  f.growTest(HAM_ENABLE_RECOVERY);
+}
+
+struct AsyncIoFixture {
+  ham_env_t *m_env;
+  ham_db_t *m_db;
+
+  AsyncIoFixture()
+    : m_env(0), m_db(0) {
+    os::unlink(Globals::opath(".test"));
+  }
+
+  ~AsyncIoFixture() {
+    if (m_env)
+      (void)ham_env_close(m_env, HAM_AUTO_CLEANUP);
+  }
+
+  void insert(int count) {
+    char buffer[200] = {0};
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    rec.data = buffer;
+    rec.size = sizeof(buffer);
+
+    for (int i = 0; i < count; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ham_db_insert(m_db, 0, &key, &rec, 0));
+    }
+  }
+
+  void create_db() {
+    ham_parameter_t params[] = {
+        { HAM_PARAM_KEY_TYPE, HAM_TYPE_UINT32 },
+        { 0, 0 }
+    };
+    REQUIRE(0 == ham_env_create_db(m_env, &m_db, 1, 0, &params[0]));
+  }
+
+  void reopen(ham_u32_t backend, ham_u32_t flags) {
+    ham_parameter_t params[] = {
+        { HAM_PARAM_IO_BACKEND, backend },
+        { 0, 0 }
+    };
+    if (m_env)
+      REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+    REQUIRE(0 ==
+        ham_env_open(&m_env, Globals::opath(".test"), flags, &params[0]));
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+  }
+
+  void scan(int count, bool forward) {
+    ham_cursor_t *cursor;
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    REQUIRE(0 == ham_cursor_create(&cursor, m_db, 0, 0));
+
+    int i = forward ? 0 : count - 1;
+    while (0 == ham_cursor_move(cursor, &key, &rec,
+                forward ? HAM_CURSOR_NEXT : HAM_CURSOR_PREVIOUS)) {
+      REQUIRE(i == *(int *)key.data);
+      REQUIRE(200u == rec.size);
+      i += forward ? 1 : -1;
+    }
+    REQUIRE(i == (forward ? count : -1));
+    REQUIRE(0 == ham_cursor_close(cursor));
+  }
+
+  void invalidParameterTest() {
+    ham_parameter_t params[] = {
+        { HAM_PARAM_IO_BACKEND, HAM_IO_BACKEND_ASYNC },
+        { 0, 0 }
+    };
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_create(&m_env, 0, HAM_IN_MEMORY, 0, &params[0]));
+    params[0].value = 99;
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_create(&m_env, Globals::opath(".test"), 0, 0644,
+            &params[0]));
+  }
+
+  void getParameterTest() {
+    ham_parameter_t params[] = {
+        { HAM_PARAM_IO_BACKEND, HAM_IO_BACKEND_THREADS },
+        { 0, 0 }
+    };
+    REQUIRE(0 ==
+        ham_env_create(&m_env, Globals::opath(".test"), 0, 0644, &params[0]));
+
+    params[0].value = 0;
+    REQUIRE(0 == ham_env_get_parameters(m_env, &params[0]));
+    REQUIRE((ham_u64_t)HAM_IO_BACKEND_THREADS == params[0].value);
+
+    AsyncDiskDevice *device = dynamic_cast<AsyncDiskDevice *>(
+                    ((LocalEnvironment *)m_env)->get_device());
+    REQUIRE(device != 0);
+    REQUIRE(0 == strcmp("threads", device->test_get_backend_name()));
+  }
+
+  void scanTest(ham_u32_t backend) {
+    ham_parameter_t params[] = {
+        { HAM_PARAM_PAGESIZE, 1024 },
+        { 0, 0 }
+    };
+    REQUIRE(0 ==
+        ham_env_create(&m_env, Globals::opath(".test"), 0, 0644, &params[0]));
+    create_db();
+    insert(5000);
+
+    // mapped pages are not prefetched
+    reopen(backend, HAM_DISABLE_MMAP);
+    scan(5000, true);
+
+    ham_env_metrics_t metrics = {0};
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.device_prefetch_hits > 0u);
+
+    reopen(backend, HAM_DISABLE_MMAP);
+    scan(5000, false);
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.device_prefetch_hits > 0u);
+
+    reopen(HAM_IO_BACKEND_SYNC, 0);
+    scan(5000, true);
+  }
+
+  void recoveryTest(ham_u32_t backend) {
+    ham_parameter_t params[] = {
+        { HAM_PARAM_PAGESIZE, 1024 },
+        { HAM_PARAM_IO_BACKEND, backend },
+        { 0, 0 }
+    };
+    // the changesets are flushed with batched writes
+    REQUIRE(0 ==
+        ham_env_create(&m_env, Globals::opath(".test"), HAM_ENABLE_RECOVERY,
+            0644, &params[0]));
+    create_db();
+    insert(5000);
+    scan(5000, true);
+
+    reopen(HAM_IO_BACKEND_SYNC, 0);
+    scan(5000, true);
+  }
+};
+
+TEST_CASE("Env-asyncio/invalidParameterTest", "")
+{
+  AsyncIoFixture f;
+  f.invalidParameterTest();
+}
+
+TEST_CASE("Env-asyncio/getParameterTest", "")
+{
+  AsyncIoFixture f;
+  f.getParameterTest();
+}
+
+TEST_CASE("Env-asyncio/scanAsyncTest", "")
+{
+  AsyncIoFixture f;
+  f.scanTest(HAM_IO_BACKEND_ASYNC);
+}
+
+TEST_CASE("Env-asyncio/scanThreadsTest", "")
+{
+  AsyncIoFixture f;
+  f.scanTest(HAM_IO_BACKEND_THREADS);
+}
+
+TEST_CASE("Env-asyncio/recoveryAsyncTest", "")
+{
+  AsyncIoFixture f;
+  f.recoveryTest(HAM_IO_BACKEND_ASYNC);
+}
+
+TEST_CASE("Env-asyncio/recoveryThreadsTest", "")
+{
+  AsyncIoFixture f;
+  f.recoveryTest(HAM_IO_BACKEND_THREADS);
+}
+
+struct DirectIoFixture {
+  ham_env_t *m_env;
+  ham_db_t *m_db;
+
+  DirectIoFixture()
+    : m_env(0), m_db(0) {
+    os::unlink(Globals::opath(".test"));
+  }
+
+  ~DirectIoFixture() {
+    if (m_env)
+      (void)ham_env_close(m_env, HAM_AUTO_CLEANUP);
+  }
+
+  // the records have an odd size; they're stored as blobs which are
+  // not aligned
+  void insert(int start, int end) {
+    char buffer[333];
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    rec.data = buffer;
+    rec.size = sizeof(buffer);
+
+    for (int i = start; i < end; i++) {
+      memset(buffer, (char)i, sizeof(buffer));
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ham_db_insert(m_db, 0, &key, &rec, 0));
+    }
+  }
+
+  void verify(int count) {
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+
+    for (int i = 0; i < count; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ham_db_find(m_db, 0, &key, &rec, 0));
+      REQUIRE(333u == rec.size);
+      REQUIRE((char)i == ((char *)rec.data)[0]);
+      REQUIRE((char)i == ((char *)rec.data)[332]);
+    }
+  }
+
+  void reopen(ham_u32_t flags) {
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+    REQUIRE(0 == ham_env_open(&m_env, Globals::opath(".test"), flags, 0));
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+  }
+
+  void invalidParameterTest() {
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_create(&m_env, 0, HAM_IN_MEMORY | HAM_DIRECT_IO, 0, 0));
+  }
+
+  void disableMmapTest() {
+    ham_parameter_t params[] = {
+        { HAM_PARAM_FLAGS, 0 },
+        { 0, 0 }
+    };
+    REQUIRE(0 ==
+        ham_env_create(&m_env, Globals::opath(".test"), HAM_DIRECT_IO,
+            0644, 0));
+    REQUIRE(0 == ham_env_get_parameters(m_env, &params[0]));
+    REQUIRE((params[0].value & HAM_DIRECT_IO) != 0);
+    REQUIRE((params[0].value & HAM_DISABLE_MMAP) != 0);
+  }
+
+  void insertTest(ham_u32_t page_size, ham_u32_t flags) {
+    ham_parameter_t params[] = {
+        { HAM_PARAM_PAGESIZE, page_size },
+        { HAM_PARAM_CACHESIZE, 64 * 1024 },
+        { 0, 0 }
+    };
+    REQUIRE(0 ==
+        ham_env_create(&m_env, Globals::opath(".test"),
+            HAM_DIRECT_IO | flags, 0644, &params[0]));
+    REQUIRE(0 == ham_env_create_db(m_env, &m_db, 1, 0, 0));
+    insert(0, 2000);
+    verify(2000);
+
+    reopen(HAM_DIRECT_IO | flags);
+    verify(2000);
+    insert(2000, 3000);
+    verify(3000);
+
+    // the file is compatible with buffered I/O
+    reopen(0);
+    verify(3000);
+  }
+};
+
+TEST_CASE("Env-directio/invalidParameterTest", "")
+{
+  DirectIoFixture f;
+  f.invalidParameterTest();
+}
+
+TEST_CASE("Env-directio/disableMmapTest", "")
+{
+  DirectIoFixture f;
+  f.disableMmapTest();
+}
+
+TEST_CASE("Env-directio/insertTest", "")
+{
+  DirectIoFixture f;
+  f.insertTest(16 * 1024, 0);
+}
+
+TEST_CASE("Env-directio/insertSmallPagesTest", "")
+{
+  DirectIoFixture f;
+  f.insertTest(1024, 0);
+}
+
+TEST_CASE("Env-directio/insertRecoveryTest", "")
+{
+  DirectIoFixture f;
+  f.insertTest(16 * 1024, HAM_ENABLE_RECOVERY);
+}
+
+struct GroupCommitFixture {
+  ham_env_t *m_env;
+  ham_db_t *m_db;
+
+  GroupCommitFixture()
+    : m_env(0), m_db(0) {
+    os::unlink(Globals::opath(".test"));
+  }
+
+  ~GroupCommitFixture() {
+    if (m_env)
+      (void)ham_env_close(m_env, HAM_AUTO_CLEANUP);
+  }
+
+  void create(ham_u32_t delay, ham_u32_t size, ham_u32_t interval = 0) {
+    ham_parameter_t params[] = {
+        { HAM_PARAM_GROUP_COMMIT_DELAY, delay },
+        { HAM_PARAM_GROUP_COMMIT_SIZE, size },
+        { HAM_PARAM_JOURNAL_SYNC_INTERVAL, interval },
+        { 0, 0 }
+    };
+    ham_parameter_t dbparams[] = {
+        { HAM_PARAM_KEY_TYPE, HAM_TYPE_UINT32 },
+        { 0, 0 }
+    };
+    REQUIRE(0 == ham_env_create(&m_env, Globals::opath(".test"),
+                HAM_ENABLE_TRANSACTIONS | HAM_ENABLE_FSYNC, 0644,
+                &params[0]));
+    REQUIRE(0 == ham_env_create_db(m_env, &m_db, 1, 0, &dbparams[0]));
+  }
+
+  // inserts each key in a separate Transaction; runs in multiple threads,
+  // therefore the result is stored in |*st| (Catch is not thread-safe)
+  static void insert(ham_db_t *db, ham_u32_t start, ham_u32_t end,
+                  ham_status_t *st) {
+    ham_env_t *env = ham_db_get_env(db);
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+
+    for (ham_u32_t i = start; i < end && *st == 0; i++) {
+      ham_txn_t *txn;
+      key.data = &i;
+      key.size = sizeof(i);
+      *st = ham_txn_begin(&txn, env, 0, 0, 0);
+      if (*st == 0)
+        *st = ham_db_insert(db, txn, &key, &rec, 0);
+      if (*st == 0)
+        *st = ham_txn_commit(txn, 0);
+    }
+  }
+
+  void verify(ham_u32_t count) {
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+
+    for (ham_u32_t i = 0; i < count; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ham_db_find(m_db, 0, &key, &rec, 0));
+    }
+  }
+
+  ham_u64_t get_latency_count(ham_env_metrics_t *metrics) {
+    ham_u64_t count = 0;
+    for (int i = 0; i < HAM_COMMIT_LATENCY_BUCKETS; i++)
+      count += metrics->txn_commit_latency[i];
+    return (count);
+  }
+
+  void getParameterTest() {
+    ham_parameter_t params[] = {
+        { HAM_PARAM_GROUP_COMMIT_DELAY, 0 },
+        { HAM_PARAM_GROUP_COMMIT_SIZE, 0 },
+        { HAM_PARAM_JOURNAL_SYNC_INTERVAL, 0 },
+        { 0, 0 }
+    };
+    create(500, 8, 100);
+    REQUIRE(0 == ham_env_get_parameters(m_env, &params[0]));
+    REQUIRE(500ull == params[0].value);
+    REQUIRE(8ull == params[1].value);
+    REQUIRE(100ull == params[2].value);
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+
+    // the settings are not persistent
+    REQUIRE(0 == ham_env_open(&m_env, Globals::opath(".test"),
+                HAM_ENABLE_TRANSACTIONS, 0));
+    REQUIRE(0 == ham_env_get_parameters(m_env, &params[0]));
+    REQUIRE(0ull == params[0].value);
+    REQUIRE(0ull == params[1].value);
+    REQUIRE(0ull == params[2].value);
+  }
+
+  void syncInvalidParameterTest() {
+    create(0, 0);
+    REQUIRE(HAM_INV_PARAMETER == ham_env_sync(0, 0));
+    REQUIRE(HAM_INV_PARAMETER == ham_env_sync(m_env, 1));
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+
+    // without journal, the file is flushed
+    REQUIRE(0 == ham_env_create(&m_env, Globals::opath(".test"), 0,
+                0644, 0));
+    REQUIRE(0 == ham_env_sync(m_env, 0));
+    REQUIRE(0 == ham_env_close(m_env, 0));
+
+    REQUIRE(0 == ham_env_create(&m_env, 0, HAM_IN_MEMORY, 0644, 0));
+    REQUIRE(0 == ham_env_sync(m_env, 0));
+  }
+
+  void syncIntervalTest() {
+    ham_status_t st = 0;
+    ham_env_metrics_t metrics;
+    create(0, 0, 50);
+    insert(m_db, 0, 100, &st);
+    REQUIRE(0 == st);
+
+    // the commits did not wait for the journal
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    REQUIRE(100ull == get_latency_count(&metrics));
+    REQUIRE(metrics.journal_commit_syncs < 100ull);
+
+    // ham_env_sync is a barrier
+    REQUIRE(0 == ham_env_sync(m_env, 0));
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    REQUIRE(100ull == metrics.journal_synced_commits);
+
+    // the background thread flushes the next commit
+    insert(m_db, 100, 101, &st);
+    REQUIRE(0 == st);
+    for (int i = 0; i < 100; i++) {
+      REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+      if (metrics.journal_synced_commits == 101)
+        break;
+      boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    }
+    REQUIRE(101ull == metrics.journal_synced_commits);
+
+    // the journal is recovered after a crash
+    REQUIRE(0 == ham_env_close(m_env,
+                HAM_AUTO_CLEANUP | HAM_DONT_CLEAR_LOG));
+    REQUIRE(0 == ham_env_open(&m_env, Globals::opath(".test"),
+                HAM_ENABLE_TRANSACTIONS | HAM_AUTO_RECOVERY, 0));
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+    verify(101);
+  }
+
+  void singleThreadTest() {
+    ham_env_metrics_t metrics;
+    ham_status_t st = 0;
+    create(0, 0);
+    insert(m_db, 0, 100, &st);
+    REQUIRE(0 == st);
+
+    // without concurrent commits, every commit has its own flush
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    REQUIRE(100ull == metrics.journal_commit_syncs);
+    REQUIRE(100ull == metrics.journal_synced_commits);
+    REQUIRE(100ull == get_latency_count(&metrics));
+  }
+
+  void multiThreadTest(ham_u32_t delay, ham_u32_t size,
+                  ham_u32_t interval = 0) {
+    const int kThreads = 4;
+    const ham_u32_t kCommits = 100;
+    ham_env_metrics_t metrics;
+    create(delay, size, interval);
+
+    Thread *threads[kThreads];
+    ham_status_t st[kThreads] = {0};
+    for (int i = 0; i < kThreads; i++)
+      threads[i] = new Thread(insert, m_db, i * kCommits,
+                  (i + 1) * kCommits, &st[i]);
+    for (int i = 0; i < kThreads; i++) {
+      threads[i]->join();
+      delete threads[i];
+      REQUIRE(0 == st[i]);
+    }
+
+    REQUIRE(0 == ham_env_sync(m_env, 0));
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    REQUIRE((ham_u64_t)(kThreads * kCommits)
+                == metrics.journal_synced_commits);
+    REQUIRE((ham_u64_t)(kThreads * kCommits) == get_latency_count(&metrics));
+    REQUIRE(metrics.journal_commit_syncs > 0);
+    REQUIRE(metrics.journal_commit_syncs <= metrics.journal_synced_commits);
+
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+    REQUIRE(0 == ham_env_open(&m_env, Globals::opath(".test"),
+                HAM_ENABLE_TRANSACTIONS, 0));
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+    verify(kThreads * kCommits);
+  }
+};
+
+TEST_CASE("Env-groupcommit/getParameterTest", "")
+{
+  GroupCommitFixture f;
+  f.getParameterTest();
+}
+
+TEST_CASE("Env-groupcommit/singleThreadTest", "")
+{
+  GroupCommitFixture f;
+  f.singleThreadTest();
+}
+
+TEST_CASE("Env-groupcommit/multiThreadTest", "")
+{
+  GroupCommitFixture f;
+  f.multiThreadTest(0, 0);
+}
+
+TEST_CASE("Env-groupcommit/multiThreadDelayTest", "")
+{
+  GroupCommitFixture f;
+  f.multiThreadTest(1000, 4);
+}
+
+TEST_CASE("Env-groupcommit/multiThreadIntervalTest", "")
+{
+  GroupCommitFixture f;
+  f.multiThreadTest(0, 0, 20);
+}
+
+TEST_CASE("Env-groupcommit/syncInvalidParameterTest", "")
+{
+  GroupCommitFixture f;
+  f.syncInvalidParameterTest();
+}
+
+TEST_CASE("Env-groupcommit/syncIntervalTest", "")
+{
+  GroupCommitFixture f;
+  f.syncIntervalTest();
+}
+
+struct TxnFlusherFixture {
+  ham_env_t *m_env;
+  ham_db_t *m_db;
+
+  TxnFlusherFixture()
+    : m_env(0), m_db(0) {
+    os::unlink(Globals::opath(".test"));
+  }
+
+  ~TxnFlusherFixture() {
+    if (m_env)
+      (void)ham_env_close(m_env, HAM_AUTO_CLEANUP);
+  }
+
+  void create(ham_u64_t limit) {
+    ham_parameter_t params[] = {
+        { HAM_PARAM_TXN_FLUSH_LIMIT, limit },
+        { 0, 0 }
+    };
+    ham_parameter_t dbparams[] = {
+        { HAM_PARAM_KEY_TYPE, HAM_TYPE_UINT32 },
+        { 0, 0 }
+    };
+    REQUIRE(0 == ham_env_create(&m_env, Globals::opath(".test"),
+                HAM_ENABLE_TRANSACTIONS, 0644, &params[0]));
+    REQUIRE(0 == ham_env_create_db(m_env, &m_db, 1, 0, &dbparams[0]));
+  }
+
+  // returns true if all committed Transactions were flushed
+  bool is_flushed() {
+    Environment *env = (Environment *)m_env;
+    ScopedLock lock(env->get_mutex());
+    return (env->get_oldest_txn() == 0);
+  }
+
+  void getParameterTest() {
+    ham_parameter_t params[] = {
+        { HAM_PARAM_TXN_FLUSH_LIMIT, 0 },
+        { 0, 0 }
+    };
+    create(1024 * 1024);
+    REQUIRE(0 == ham_env_get_parameters(m_env, &params[0]));
+    REQUIRE((ham_u64_t)(1024 * 1024) == params[0].value);
+  }
+
+  void backgroundFlushTest() {
+    ham_status_t st = 0;
+    create(1024 * 1024);
+    GroupCommitFixture::insert(m_db, 0, 100, &st);
+    REQUIRE(0 == st);
+
+    // the committed keys are visible, even if they were not yet flushed
+    verify(100);
+
+    // the background thread flushes all of them
+    for (int i = 0; i < 100 && !is_flushed(); i++)
+      boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    REQUIRE(true == is_flushed());
+
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+    REQUIRE(0 == ham_env_open(&m_env, Globals::opath(".test"),
+                HAM_ENABLE_TRANSACTIONS, 0));
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+    verify(100);
+  }
+
+  void backPressureTest() {
+    ham_status_t st = 0;
+    create(1);
+
+    // every commit exceeds the limit and is flushed immediately
+    for (ham_u32_t i = 0; i < 10; i++) {
+      GroupCommitFixture::insert(m_db, i, i + 1, &st);
+      REQUIRE(0 == st);
+      REQUIRE(true == is_flushed());
+    }
+    verify(10);
+  }
+
+  void multiThreadTest() {
+    const int kThreads = 4;
+    const ham_u32_t kCommits = 100;
+    create(64 * 1024);
+
+    Thread *threads[kThreads];
+    ham_status_t st[kThreads] = {0};
+    for (int i = 0; i < kThreads; i++)
+      threads[i] = new Thread(GroupCommitFixture::insert, m_db,
+                  i * kCommits, (i + 1) * kCommits, &st[i]);
+    for (int i = 0; i < kThreads; i++) {
+      threads[i]->join();
+      delete threads[i];
+      REQUIRE(0 == st[i]);
+    }
+    verify(kThreads * kCommits);
+
+    // closing the Environment flushes the remaining Transactions
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+    REQUIRE(0 == ham_env_open(&m_env, Globals::opath(".test"),
+                HAM_ENABLE_TRANSACTIONS, 0));
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+    verify(kThreads * kCommits);
+  }
+
+  void verify(ham_u32_t count) {
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+
+    for (ham_u32_t i = 0; i < count; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ham_db_find(m_db, 0, &key, &rec, 0));
+    }
+  }
+};
+
+TEST_CASE("Env-txnflusher/getParameterTest", "")
+{
+  TxnFlusherFixture f;
+  f.getParameterTest();
+}
+
+TEST_CASE("Env-txnflusher/backgroundFlushTest", "")
+{
+  TxnFlusherFixture f;
+  f.backgroundFlushTest();
+}
+
+TEST_CASE("Env-txnflusher/backPressureTest", "")
+{
+  TxnFlusherFixture f;
+  f.backPressureTest();
+}
+
+TEST_CASE("Env-txnflusher/multiThreadTest", "")
+{
+  TxnFlusherFixture f;
+  f.multiThreadTest();
+}
@@ -17,7 +17,8 @@
 
 #include "../src/db.h"
 #include "../src/page.h"
-#include "../src/freelist.h"
+#include "../src/freelist_bitmap.h"
+#include "../src/freelist_extent.h"
 #include "../src/env.h"
 #include "../src/page_manager.h"
 #include "../src/blob_manager_disk.h"
@@ -614,4 +615,292 @@ TEST_CASE("Freelist/truncateTest", "")
   f.truncateTest();
 }
 
+struct ExtentFreelistFixture {
+  ham_env_t *m_env;
+  ham_db_t *m_db;
+  ExtentFreelist *m_freelist;
+  LocalEnvironment *m_lenv;
+
+  ExtentFreelistFixture()
+    : m_env(0), m_db(0), m_freelist(0) {
+    setup();
+  }
+
+  ~ExtentFreelistFixture() {
+    teardown();
+  }
+
+  ham_status_t open(ham_u32_t flags = 0) {
+    ham_status_t st;
+    st = ham_env_close(m_env, HAM_AUTO_CLEANUP);
+    if (st)
+      return (st);
+    st = ham_env_open(&m_env, Globals::opath(".test"), flags, 0);
+    if (st)
+      return (st);
+    st = ham_env_open_db(m_env, &m_db, 1, 0, 0);
+    if (st)
+      return (st);
+    m_lenv = (LocalEnvironment *)m_env;
+    m_freelist = (ExtentFreelist *)
+            m_lenv->get_page_manager()->test_get_freelist();
+    return (0);
+  }
+
+  void setup() {
+    ham_parameter_t p[] = {
+      { HAM_PARAM_PAGESIZE, 4096 },
+      { HAM_PARAM_FREELIST_TYPE, HAM_FREELIST_EXTENT },
+      { 0, 0 }
+    };
+
+    REQUIRE(0 ==
+        ham_env_create(&m_env, Globals::opath(".test"),
+                HAM_DISABLE_MMAP, 0644, &p[0]));
+    REQUIRE(0 ==
+        ham_env_create_db(m_env, &m_db, 1, 0, 0));
+
+    m_lenv = (LocalEnvironment *)m_env;
+    m_freelist = (ExtentFreelist *)
+            m_lenv->get_page_manager()->test_get_freelist();
+  }
+
+  void teardown() {
+    if (m_env)
+      REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+  }
+
+  void parameterTest() {
+    ham_parameter_t p[] = {
+      { HAM_PARAM_FREELIST_TYPE, 0 },
+      { 0, 0 }
+    };
+    REQUIRE(0 == ham_env_get_parameters(m_env, &p[0]));
+    REQUIRE((ham_u64_t)HAM_FREELIST_EXTENT == p[0].value);
+
+    // the type is persistent
+    REQUIRE(0 == open());
+    p[0].value = 0;
+    REQUIRE(0 == ham_env_get_parameters(m_env, &p[0]));
+    REQUIRE((ham_u64_t)HAM_FREELIST_EXTENT == p[0].value);
+
+    // ... and cannot be specified when opening the file
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+    m_env = 0;
+    ham_env_t *env;
+    p[0].value = HAM_FREELIST_EXTENT;
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_open(&env, Globals::opath(".test"), 0, &p[0]));
+
+    // invalid values are rejected
+    p[0].value = 2;
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_create(&env, Globals::opath(".test"), 0, 0644, &p[0]));
+  }
+
+  void allocAreaTest() {
+    ham_u32_t ps = m_lenv->get_page_size();
+
+    for (int i = 0; i < 10; i++)
+      m_freelist->free_area(ps * 10 + i * CHUNKSIZE, CHUNKSIZE);
+    REQUIRE(1u == m_freelist->get_extent_count());
+    REQUIRE((ham_u64_t)(10 * CHUNKSIZE) == m_freelist->get_free_bytes());
+
+    for (int i = 0; i < 10; i++)
+      REQUIRE((ham_u64_t)(ps * 10 + i * CHUNKSIZE)
+                      == m_freelist->alloc_area(CHUNKSIZE));
+    REQUIRE(0ull == m_freelist->alloc_area(CHUNKSIZE));
+    REQUIRE(0u == m_freelist->get_extent_count());
+  }
+
+  void coalesceTest() {
+    ham_u32_t ps = m_lenv->get_page_size();
+
+    m_freelist->free_area(ps * 10 + 2 * CHUNKSIZE, CHUNKSIZE);
+    m_freelist->free_area(ps * 10, CHUNKSIZE);
+    REQUIRE(2u == m_freelist->get_extent_count());
+
+    // fills the gap; all three are merged
+    m_freelist->free_area(ps * 10 + CHUNKSIZE, CHUNKSIZE);
+    REQUIRE(1u == m_freelist->get_extent_count());
+
+    REQUIRE((ham_u64_t)(ps * 10) == m_freelist->alloc_area(3 * CHUNKSIZE));
+    REQUIRE(0u == m_freelist->get_extent_count());
+  }
+
+  void bestFitTest() {
+    ham_u32_t ps = m_lenv->get_page_size();
+
+    m_freelist->free_area(ps * 10, 8 * CHUNKSIZE);
+    m_freelist->free_area(ps * 20, 2 * CHUNKSIZE);
+    m_freelist->free_area(ps * 30, 4 * CHUNKSIZE);
+
+    // the smallest extent which is large enough is used
+    REQUIRE((ham_u64_t)(ps * 30) == m_freelist->alloc_area(3 * CHUNKSIZE));
+    REQUIRE((ham_u64_t)(ps * 30 + 3 * CHUNKSIZE)
+                    == m_freelist->alloc_area(CHUNKSIZE));
+    REQUIRE((ham_u64_t)(ps * 20) == m_freelist->alloc_area(2 * CHUNKSIZE));
+    REQUIRE((ham_u64_t)(ps * 10) == m_freelist->alloc_area(5 * CHUNKSIZE));
+    REQUIRE(0ull == m_freelist->alloc_area(4 * CHUNKSIZE));
+  }
+
+  void allocPageTest() {
+    ham_u32_t ps = m_lenv->get_page_size();
+
+    // not page-aligned
+    m_freelist->free_area(ps * 10 + CHUNKSIZE, ps);
+    REQUIRE(false == m_freelist->is_page_free(ps * 10));
+    REQUIRE(false == m_freelist->is_page_free(ps * 11));
+    REQUIRE(0ull == m_freelist->alloc_page());
+
+    // now it contains a page-aligned page
+    m_freelist->free_area(ps * 11 + CHUNKSIZE, ps);
+    REQUIRE(true == m_freelist->is_page_free(ps * 11));
+    REQUIRE((ham_u64_t)(ps * 11) == m_freelist->alloc_page());
+    REQUIRE(false == m_freelist->is_page_free(ps * 11));
+
+    // the remaining space is still available
+    REQUIRE(2u == m_freelist->get_extent_count());
+    REQUIRE((ham_u64_t)ps == m_freelist->get_free_bytes());
+  }
+
+  void reopenTest() {
+    ham_u32_t ps = m_lenv->get_page_size();
+    const int kCount = 1000;
+
+    // many small extents; they do not fit into the header page
+    for (int i = 0; i < kCount; i++)
+      m_freelist->free_area(ps * 100 + i * 2 * CHUNKSIZE, CHUNKSIZE);
+    REQUIRE((size_t)kCount == m_freelist->get_extent_count());
+
+    REQUIRE(0 == open());
+
+    // the overflow pages were moved to the freelist when the list was
+    // loaded
+    REQUIRE(m_freelist->get_extent_count() > (size_t)kCount);
+    PExtentFreelistPayload *fp =
+            (PExtentFreelistPayload *)m_lenv->get_freelist_payload();
+    REQUIRE(0u == fp->get_count());
+    REQUIRE(0ull == fp->get_overflow());
+
+    for (int i = 0; i < kCount; i++)
+      REQUIRE((ham_u64_t)(ps * 100 + i * 2 * CHUNKSIZE)
+                      == m_freelist->alloc_area(CHUNKSIZE));
+  }
+
+  void reclaimTest() {
+    PageManager *pm = m_lenv->get_page_manager();
+    ham_u32_t page_size = m_lenv->get_page_size();
+    Page *page[5] = {0};
+
+    for (int i = 0; i < 5; i++) {
+      REQUIRE((page[i] = pm->alloc_page(0, Page::kTypeFreelist,
+                  PageManager::kClearWithZero)));
+      REQUIRE(page[i]->get_address() == (2 + i) * page_size);
+    }
+
+    // free the first and the last 3 pages
+    pm->add_to_freelist(page[0]);
+    for (int i = 2; i < 5; i++)
+      pm->add_to_freelist(page[i]);
+    REQUIRE(2u == m_freelist->get_extent_count());
+
+    REQUIRE(0 == open());
+
+    // the file was truncated; the first page is still free
+    REQUIRE((ham_u64_t)(page_size * 4) == m_lenv->get_device()->get_filesize());
+    REQUIRE(true == m_freelist->is_page_free(page_size * 2));
+    REQUIRE(false == m_freelist->is_page_free(page_size * 3));
+    REQUIRE((ham_u64_t)(page_size * 2) == m_freelist->alloc_page());
+    REQUIRE(0ull == m_freelist->alloc_page());
+  }
+
+  void insertEraseTest() {
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    char buffer[1000] = {0};
+    const int kCount = 2000;
+
+    rec.data = buffer;
+    rec.size = sizeof(buffer);
+    key.size = sizeof(int);
+
+    for (int j = 0; j < 3; j++) {
+      for (int i = 0; i < kCount; i++) {
+        key.data = &i;
+        *(int *)buffer = i + j;
+        REQUIRE(0 == ham_db_insert(m_db, 0, &key, &rec, HAM_OVERWRITE));
+      }
+      for (int i = 0; i < kCount; i += 2) {
+        key.data = &i;
+        REQUIRE(0 == ham_db_erase(m_db, 0, &key, 0));
+      }
+
+      REQUIRE(0 == open());
+
+      for (int i = 0; i < kCount; i++) {
+        ham_record_t r = {0};
+        key.data = &i;
+        if (i % 2 == 0)
+          REQUIRE(HAM_KEY_NOT_FOUND == ham_db_find(m_db, 0, &key, &r, 0));
+        else {
+          REQUIRE(0 == ham_db_find(m_db, 0, &key, &r, 0));
+          REQUIRE(r.size == sizeof(buffer));
+          REQUIRE(*(int *)r.data == i + j);
+        }
+      }
+    }
+
+    REQUIRE(0 == ham_db_check_integrity(m_db, 0));
+  }
+};
+
+TEST_CASE("Freelist-extent/parameterTest", "")
+{
+  ExtentFreelistFixture f;
+  f.parameterTest();
+}
+
+TEST_CASE("Freelist-extent/allocAreaTest", "")
+{
+  ExtentFreelistFixture f;
+  f.allocAreaTest();
+}
+
+TEST_CASE("Freelist-extent/coalesceTest", "")
+{
+  ExtentFreelistFixture f;
+  f.coalesceTest();
+}
+
+TEST_CASE("Freelist-extent/bestFitTest", "")
+{
+  ExtentFreelistFixture f;
+  f.bestFitTest();
+}
+
+TEST_CASE("Freelist-extent/allocPageTest", "")
+{
+  ExtentFreelistFixture f;
+  f.allocPageTest();
+}
+
+TEST_CASE("Freelist-extent/reopenTest", "")
+{
+  ExtentFreelistFixture f;
+  f.reopenTest();
+}
+
+TEST_CASE("Freelist-extent/reclaimTest", "")
+{
+  ExtentFreelistFixture f;
+  f.reclaimTest();
+}
+
+TEST_CASE("Freelist-extent/insertEraseTest", "")
+{
+  ExtentFreelistFixture f;
+  f.insertEraseTest();
+}
+
 } // namespace hamsterdb
@@ -11,6 +11,9 @@
 
 #include "../src/config.h"
 
+#include <string>
+#include <vector>
+
 #include "3rdparty/catch/catch.hpp"
 
 #include "globals.h"
@@ -38,6 +41,29 @@ my_compare_func(ham_db_t *db,
   return (0);
 }
 
+struct ScanContext {
+  enum { kMaxPartitions = 8 };
+
+  ScanContext(bool stop = false)
+    : stop_early(stop) {
+  }
+
+  std::vector<std::string> keys[kMaxPartitions];
+  std::vector<ham_u32_t> record_counts[kMaxPartitions];
+  bool stop_early;
+};
+
+static ham_bool_t HAM_CALLCONV
+scan_visitor(void *context, ham_u32_t partition, const ham_key_t *key,
+      ham_u32_t record_count)
+{
+  ScanContext *c = (ScanContext *)context;
+  c->keys[partition].push_back(std::string((const char *)key->data,
+                          key->size));
+  c->record_counts[partition].push_back(record_count);
+  return (c->stop_early ? 0 : 1);
+}
+
 struct HamsterdbFixture {
   ham_db_t *m_db;
   ham_env_t *m_env;
@@ -1586,6 +1612,107 @@ struct HamsterdbFixture {
     REQUIRE((unsigned)(4000 + 10) == count);
   }
 
+  void scanTest() {
+    const int MAX = 3000;
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    ham_parameter_t ps[] = { { HAM_PARAM_PAGESIZE, 1024 }, { 0, 0 } };
+    char buf[300];
+    std::vector<std::string> expected;
+
+    teardown();
+    REQUIRE(0 ==
+            ham_env_create(&m_env, Globals::opath(".test"), 0, 0664, ps));
+    REQUIRE(0 ==
+            ham_env_create_db(m_env, &m_db, 1, HAM_ENABLE_DUPLICATE_KEYS, 0));
+
+    /* every 100th key is an extended key */
+    for (int i = 0; i < MAX; i++) {
+      ::memset(buf, 'x', sizeof(buf));
+      ::sprintf(buf, "%07d", i);
+      key.data = buf;
+      key.size = (i % 100) == 0 ? sizeof(buf) : 8;
+      rec.data = &i;
+      rec.size = sizeof(i);
+      REQUIRE(0 == ham_db_insert(m_db, 0, &key, &rec, 0));
+      expected.push_back(std::string(buf, key.size));
+    }
+
+    /* and one key has duplicates */
+    ::sprintf(buf, "%07d", 5);
+    key.size = 8;
+    for (int i = 0; i < 3; i++)
+      REQUIRE(0 == ham_db_insert(m_db, 0, &key, &rec, HAM_DUPLICATE));
+
+    REQUIRE(HAM_INV_PARAMETER ==
+            ham_db_scan(0, 4, scan_visitor, 0, 0));
+    REQUIRE(HAM_INV_PARAMETER ==
+            ham_db_scan(m_db, 0, scan_visitor, 0, 0));
+    REQUIRE(HAM_INV_PARAMETER ==
+            ham_db_scan(m_db, 4, 0, 0, 0));
+
+    for (ham_u32_t partitions = 1; partitions <= 4; partitions++) {
+      ScanContext context;
+      REQUIRE(0 == ham_db_scan(m_db, partitions, scan_visitor, &context, 0));
+
+      /* each partition is sorted, and the partitions are disjoint and
+       * in ascending order */
+      std::vector<std::string> keys;
+      for (ham_u32_t p = 0; p < partitions; p++) {
+        REQUIRE(context.keys[p].size() > 0u);
+        for (size_t i = 0; i < context.keys[p].size(); i++) {
+          keys.push_back(context.keys[p][i]);
+          REQUIRE((context.keys[p][i] == std::string("0000005", 8)
+                      ? 4u : 1u) == context.record_counts[p][i]);
+        }
+      }
+      REQUIRE(keys == expected);
+    }
+
+    /* stop each partition after the first key */
+    ScanContext context(true);
+    REQUIRE(0 == ham_db_scan(m_db, 4, scan_visitor, &context, 0));
+    REQUIRE(context.keys[0][0] == expected[0]);
+    for (ham_u32_t p = 0; p < 4; p++)
+      REQUIRE(1u == context.keys[p].size());
+  }
+
+  void scanTxnTest() {
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    ham_txn_t *txn;
+
+    teardown();
+    REQUIRE(0 ==
+            ham_env_create(&m_env, Globals::opath(".test"),
+                HAM_ENABLE_TRANSACTIONS, 0664, 0));
+    REQUIRE(0 == ham_env_create_db(m_env, &m_db, 1, 0, 0));
+
+    for (int i = 0; i < 10; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ham_db_insert(m_db, 0, &key, &rec, 0));
+    }
+
+    /* committed transactions are flushed before the scan */
+    ScanContext context;
+    REQUIRE(0 == ham_db_scan(m_db, 2, scan_visitor, &context, 0));
+    REQUIRE(10u == context.keys[0].size() + context.keys[1].size());
+
+    /* pending operations are not allowed */
+    int i = 10;
+    key.data = &i;
+    REQUIRE(0 == ham_txn_begin(&txn, m_env, 0, 0, 0));
+    REQUIRE(0 == ham_db_insert(m_db, txn, &key, &rec, 0));
+    REQUIRE(HAM_TXN_STILL_OPEN ==
+            ham_db_scan(m_db, 2, scan_visitor, &context, 0));
+    REQUIRE(0 == ham_txn_commit(txn, 0));
+
+    ScanContext context2;
+    REQUIRE(0 == ham_db_scan(m_db, 2, scan_visitor, &context2, 0));
+    REQUIRE(11u == context2.keys[0].size() + context2.keys[1].size());
+  }
+
   void createDbOpenEnvTest() {
     REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
     REQUIRE(0 ==
@@ -2251,6 +2378,18 @@ TEST_CASE("Hamsterdb/recordCountTest", "")
   f.recordCountTest();
 }
 
+TEST_CASE("Hamsterdb/scanTest", "")
+{
+  HamsterdbFixture f;
+  f.scanTest();
+}
+
+TEST_CASE("Hamsterdb/scanTxnTest", "")
+{
+  HamsterdbFixture f;
+  f.scanTxnTest();
+}
+
 TEST_CASE("Hamsterdb/createDbOpenEnvTest", "")
 {
   HamsterdbFixture f;
@@ -11,6 +11,8 @@
 
 #include "../src/config.h"
 
+#include <vector>
+
 #include "3rdparty/catch/catch.hpp"
 
 #include "globals.h"
@@ -694,8 +696,11 @@ struct JournalFixture {
             Journal::ENTRY_TYPE_INSERT, 1);
     }
 
-    /* backup the journal files; then re-create the Environment from the
+    /* write the buffered journal entries of the active transactions,
+     * backup the journal files; then re-create the Environment from the
      * journal */
+    m_lenv->get_journal()->flush_buffer(0);
+    m_lenv->get_journal()->flush_buffer(1);
     REQUIRE(true == os::copy(Globals::opath(".test.jrn0"),
           Globals::opath(".test.bak0")));
     REQUIRE(true == os::copy(Globals::opath(".test.jrn1"),
@@ -890,6 +895,65 @@ struct JournalFixture {
     }
   }
 
+  void bufferedWritesTest() {
+    ham_txn_t *txn;
+    ham_key_t key = {};
+    ham_record_t rec = {};
+    Journal *j = m_lenv->get_journal();
+
+    REQUIRE(0 == ham_txn_begin(&txn, m_env, 0, 0, 0));
+    ham_u64_t writes = j->m_write_count;
+
+    /* the inserts are buffered */
+    for (int i = 0; i < 50; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ham_db_insert(m_db, txn, &key, &rec, 0));
+    }
+    REQUIRE(writes == j->m_write_count);
+    REQUIRE(false == j->is_empty());
+
+    /* ... and written with a single request when the txn is committed */
+    REQUIRE(0 == ham_txn_commit(txn, 0));
+    REQUIRE((ham_u64_t)(writes + 1) == j->m_write_count);
+    REQUIRE((ham_u32_t)0 == j->m_buffer_size[0]);
+
+    ham_env_metrics_t metrics = {0};
+    ham_env_get_metrics(m_env, &metrics);
+    REQUIRE(j->m_write_count == metrics.journal_writes);
+    REQUIRE(metrics.journal_bytes_written > 0);
+
+    /* entries which exceed the buffer are written directly */
+    std::vector<ham_u8_t> buffer(Journal::kBufferSize * 2);
+    rec.data = &buffer[0];
+    rec.size = (ham_u32_t)buffer.size();
+    REQUIRE(0 == ham_txn_begin(&txn, m_env, 0, 0, 0));
+    writes = j->m_write_count;
+    REQUIRE(0 == ham_db_insert(m_db, txn, &key, &rec, HAM_OVERWRITE));
+    /* the buffered txn-begin entry, then the insert */
+    REQUIRE((ham_u64_t)(writes + 2) == j->m_write_count);
+    REQUIRE(0 == ham_txn_abort(txn, 0));
+
+    /* aborts are not written till the journal is closed */
+    REQUIRE((ham_u64_t)(writes + 2) == j->m_write_count);
+    REQUIRE(j->m_buffer_size[j->m_current_fd] > 0);
+
+    /* the journal is still consistent when it is re-opened */
+    REQUIRE(0 == ham_env_close(m_env,
+                HAM_AUTO_CLEANUP | HAM_DONT_CLEAR_LOG));
+    REQUIRE(0 ==
+        ham_env_open(&m_env, Globals::opath(".test"),
+            HAM_ENABLE_TRANSACTIONS | HAM_AUTO_RECOVERY, 0));
+    m_lenv = (LocalEnvironment *)m_env;
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+    for (int i = 0; i < 50; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ham_db_find(m_db, 0, &key, &rec, 0));
+      REQUIRE(0u == rec.size);
+    }
+  }
+
   void recoverEraseTest() {
     ham_txn_t *txn;
     LogEntry vec[200];
@@ -1088,5 +1152,10 @@ TEST_CASE("Journal/recoverEraseTest", "")
   f.recoverEraseTest();
 }
 
-} // namespace hamsterdb
+TEST_CASE("Journal/bufferedWritesTest", "")
+{
+  JournalFixture f;
+  f.bufferedWritesTest();
+}
 
+} // namespace hamsterdb
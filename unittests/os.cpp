@@ -276,6 +276,32 @@ TEST_CASE("OsTest/writevTest",
   REQUIRE(0 == strcmp("hello world!", buffer));
 }
 
+TEST_CASE("OsTest/pwritevTest",
+           "Tests the operating system functions in os*")
+{
+  ham_fd_t fd;
+  char buffers[100][10];
+  void *ptrs[100];
+  ham_u64_t sizes[100];
+  char buffer[1000];
+
+  for (int i = 0; i < 100; i++) {
+    memset(buffers[i], 'a' + i % 26, sizeof(buffers[i]));
+    ptrs[i] = buffers[i];
+    sizes[i] = sizeof(buffers[i]);
+  }
+
+  fd = os_create(Globals::opath(".test"), 0, 0664);
+  os_pwritev(fd, 10, &ptrs[0], &sizes[0], 100);
+  REQUIRE((ham_u64_t)1010 == os_get_filesize(fd));
+
+  os_pread(fd, 10, buffer, sizeof(buffer));
+  os_close(fd);
+
+  for (int i = 0; i < 1000; i++)
+    REQUIRE((char)('a' + (i / 10) % 26) == buffer[i]);
+}
+
 TEST_CASE("OsTest/seekTellTest",
            "Tests the operating system functions in os*")
 {
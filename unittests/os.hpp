@@ -117,6 +117,22 @@ public:
 #endif
     return (true);
   }
+
+  /*
+   * returns the size of a file, or 0 if it does not exist
+   */
+  static ham_u64_t file_size(const char *path) {
+#ifdef WIN32
+    struct _stat buf={0};
+    if (::_stat(path, &buf)<0)
+      return (0);
+#else
+    struct stat buf={0};
+    if (::stat(path, &buf)<0)
+      return (0);
+#endif
+    return ((ham_u64_t)buf.st_size);
+  }
 };
 
 #endif /* OS_HPP__ */
@@ -11,6 +11,9 @@
 
 #include "../src/config.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "3rdparty/catch/catch.hpp"
 
 #include "globals.h"
@@ -85,6 +88,44 @@ struct PageManagerFixture {
     PageManager *pm = ((LocalEnvironment *)m_env)->get_page_manager();
     REQUIRE_CATCH(pm->fetch_page(0, 1024 * 1024 * 200, false), HAM_IO_ERROR);
   }
+
+  // adjacent pages are sorted and written with a single request
+  void flushPagesTest() {
+    LocalEnvironment *lenv = (LocalEnvironment *)m_env;
+    PageManager *pm = lenv->get_page_manager();
+    ham_u32_t page_size = lenv->get_page_size();
+    ham_u32_t payload_size = page_size - Page::sizeof_persistent_header;
+    Page *pages[8];
+
+    for (int i = 0; i < 8; i++) {
+      REQUIRE((pages[i] = pm->alloc_page(0, Page::kTypeFreelist,
+                PageManager::kClearWithZero)));
+      memset(pages[i]->get_payload(), 'a' + i, payload_size);
+      pages[i]->set_dirty(true);
+    }
+    for (int i = 0; i < 4; i++)
+      std::swap(pages[i], pages[7 - i]);
+
+    ham_env_metrics_t before = {0};
+    ham_env_metrics_t after = {0};
+    REQUIRE(0 == ham_env_get_metrics(m_env, &before));
+    pm->flush_pages(&pages[0], 8);
+    REQUIRE(0 == ham_env_get_metrics(m_env, &after));
+
+    REQUIRE(after.device_writes == before.device_writes + 1);
+    REQUIRE(after.device_bytes_written
+                == before.device_bytes_written + 8 * page_size);
+    REQUIRE(after.device_avg_write_size > 0u);
+
+    std::vector<ham_u8_t> buffer(page_size);
+    for (int i = 0; i < 8; i++) {
+      REQUIRE(false == pages[i]->is_dirty());
+      lenv->get_device()->read(pages[i]->get_address(), &buffer[0],
+                page_size);
+      REQUIRE(0 == memcmp(&buffer[Page::sizeof_persistent_header],
+                pages[i]->get_payload(), payload_size));
+    }
+  }
 };
 
 TEST_CASE("PageManager/newDelete", "")
@@ -111,6 +152,12 @@ TEST_CASE("PageManager/fetchInvalidPage", "")
   f.fetchInvalidPageTest();
 }
 
+TEST_CASE("PageManager/flushPages", "")
+{
+  PageManagerFixture f;
+  f.flushPagesTest();
+}
+
 
 TEST_CASE("PageManager-inmem/newDelete", "")
 {